@@ -7,6 +7,7 @@
 
 class QTabWidget;
 class QTableWidget;
+class QTableView;
 class QPushButton;
 class QComboBox;
 class QLineEdit;
@@ -14,6 +15,8 @@ class QWidget;
 class WeekGridScheduleWidget;
 class PeriodSelectorWidget;
 class QCheckBox;
+class QTimer;
+class UsersTableModel;
 
 class AdminWindow : public QMainWindow {
     Q_OBJECT
@@ -33,7 +36,9 @@ private:
     // Users tab
     QLineEdit* userSearchEdit = nullptr;
     QComboBox* userRoleFilterCombo = nullptr;
-    QTableWidget* usersTable = nullptr;
+    QTableView* usersTable = nullptr;
+    UsersTableModel* usersModel = nullptr;
+    QTimer* userSearchTimer = nullptr;  // debounce ввода в userSearchEdit
     QPushButton* addUserButton = nullptr;
     QPushButton* editUserButton = nullptr;
     QPushButton* deleteUserButton = nullptr;
@@ -55,6 +60,7 @@ private:
     QComboBox* d1GroupCombo = nullptr;
     QComboBox* d1SemesterCombo = nullptr;
     QCheckBox* d1OverwriteCheck = nullptr;
+    QLineEdit* d1SeedEdit = nullptr;
     QPushButton* d1GenerateButton = nullptr;
     QTableWidget* d1StatsTable = nullptr;
     QLabel* d1TotalsLabel = nullptr;
@@ -66,6 +72,7 @@ private:
     QWidget* buildD1RandomizerTab();
 
     void reloadUsers();
+    int selectedUserRow() const;  // строка в usersModel или -1
     void reloadGroupsInto(QComboBox* combo, bool withAllOption, bool hideGroupIdZero);
     void reloadTeachersInto(QComboBox* combo, bool withAllOption);
     void reloadSchedule();
@@ -11,6 +11,7 @@
 #include <QGridLayout>
 #include <QHeaderView>
 #include <QLabel>
+#include <QLineEdit>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QTableWidget>
@@ -63,7 +64,7 @@ QWidget* AdminWindow::buildD1RandomizerTab()
     d1GroupCombo->setMinimumWidth(140);
     d1GroupCombo->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     controls->addWidget(d1GroupCombo, 0, 1);
-    reloadGroupsInto(d1GroupCombo, false, true);
+    reloadGroupsInto(d1GroupCombo, true, true);  // "Все" (0) — все группы выбранного семестра
 
     controls->addWidget(makeBadge(controlsCard, "Семестр", UiStyle::badgeNeutralStyle()), 0, 2);
     d1SemesterCombo = new QComboBox(controlsCard);
@@ -90,6 +91,13 @@ QWidget* AdminWindow::buildD1RandomizerTab()
 
     d1GenerateButton = new QPushButton("Сгенерировать оценки (D1)", controlsCard);
     controls->addWidget(d1GenerateButton, 1, 2, 1, 2);
+
+    // Пустое поле — seed из часов; число — воспроизводимый прогон (тот же seed → те же оценки)
+    controls->addWidget(makeBadge(controlsCard, "Seed", UiStyle::badgeNeutralStyle()), 2, 0);
+    d1SeedEdit = new QLineEdit(controlsCard);
+    d1SeedEdit->setPlaceholderText("случайный");
+    d1SeedEdit->setClearButtonEnabled(true);
+    controls->addWidget(d1SeedEdit, 2, 1);
     connect(d1GenerateButton, &QPushButton::clicked, this, &AdminWindow::onGenerateD1);
 
     mainCardLayout->addWidget(controlsCard);
@@ -125,7 +133,16 @@ void AdminWindow::onGenerateD1()
     if (!db || !d1GroupCombo || !d1SemesterCombo || !d1OverwriteCheck || !d1GenerateButton || !d1StatsTable || !d1TotalsLabel) return;
 
     const int groupId = d1GroupCombo->currentData().toInt();
-    if (groupId <= 0) {
+    std::vector<int> groupIds;
+    if (groupId == 0) {
+        for (int i = 0; i < d1GroupCombo->count(); ++i) {
+            const int id = d1GroupCombo->itemData(i).toInt();
+            if (id > 0) groupIds.push_back(id);
+        }
+    } else if (groupId > 0) {
+        groupIds.push_back(groupId);
+    }
+    if (groupIds.empty()) {
         QMessageBox::warning(this, "D1 Randomizer", "Выберите группу.");
         return;
     }
@@ -138,6 +155,18 @@ void AdminWindow::onGenerateD1()
 
     const bool overwrite = d1OverwriteCheck->isChecked();
 
+    std::optional<std::uint64_t> seed;
+    const QString seedText = d1SeedEdit ? d1SeedEdit->text().trimmed() : QString();
+    if (!seedText.isEmpty()) {
+        bool ok = false;
+        const qulonglong v = seedText.toULongLong(&ok);
+        if (!ok) {
+            QMessageBox::warning(this, "D1 Randomizer", "Seed должен быть неотрицательным целым числом.");
+            return;
+        }
+        seed = static_cast<std::uint64_t>(v);
+    }
+
     const QString prevText = d1GenerateButton->text();
     d1GenerateButton->setEnabled(false);
     d1GenerateButton->setText("Генерация...");
@@ -148,8 +177,10 @@ void AdminWindow::onGenerateD1()
         d1GenerateButton->setEnabled(true);
     };
 
-    D1Randomizer rnd(*db);
-    const auto res = rnd.generateForGroup(groupId, semesterId, overwrite);
+    D1Randomizer rnd = seed ? D1Randomizer(*db, *seed) : D1Randomizer(*db);
+    // Несколько групп ("Все") планируются параллельно; результат не зависит от числа потоков
+    const int threadCount = groupIds.size() > 1 ? 0 : 1;
+    const auto res = rnd.generateForGroups(groupIds, {semesterId}, overwrite, threadCount);
     if (!res.ok) {
         restoreButton();
         QMessageBox::critical(this, "D1 Randomizer", QString::fromStdString(res.error));
@@ -165,10 +196,15 @@ void AdminWindow::onGenerateD1()
         row++;
     }
 
-    d1TotalsLabel->setText(QString("Создано: %1 | Обновлено: %2 | Пропущено: %3")
+    d1TotalsLabel->setText(QString("Создано: %1 | Обновлено: %2 | Пропущено: %3 | Групп: %4 | Потоков: %5 | %6 мс | %7 строк/с | seed %8")
         .arg(res.value.createdTotal)
         .arg(res.value.updatedExistingTotal)
-        .arg(res.value.skippedExistingTotal));
+        .arg(res.value.skippedExistingTotal)
+        .arg(res.value.groupRuns)
+        .arg(res.value.threadsUsed)
+        .arg(res.value.timing.totalMs, 0, 'f', 1)
+        .arg(res.value.timing.rowsPerSec, 0, 'f', 0)
+        .arg(QString::number(static_cast<qulonglong>(res.value.seed))));
 
     restoreButton();
     AppEvents::instance().emitScheduleChanged();
@@ -1,6 +1,8 @@
 #include "adminwindow.h"
 
+#include "ui/models/UsersTableModel.h"
 #include "ui/util/UiStyle.h"
+#include "ui/widgets/RoleBadgeDelegate.h"
 
 #include <QAbstractItemView>
 #include <QComboBox>
@@ -15,7 +17,8 @@
 #include <QListWidget>
 #include <QMessageBox>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QTableView>
+#include <QTimer>
 #include <QVBoxLayout>
 
 #include <sqlite3.h>
@@ -30,24 +33,6 @@ static QString cardFrameStyle()
            "QLabel{color: palette(Text); background: transparent;}";
 }
 
-static QLabel* makeBadge(QWidget* parent, const QString& text, const QString& style)
-{
-    auto* b = new QLabel(text, parent);
-    b->setAlignment(Qt::AlignCenter);
-    b->setMinimumHeight(22);
-    b->setStyleSheet(style);
-    return b;
-}
-
-static QString roleBadgeStyle(const QString& role)
-{
-    const QString r = role.trimmed().toLower();
-    if (r == "admin") return UiStyle::badgeStyle("rgba(239,68,68,0.62)", "rgba(239,68,68,0.18)", 700);
-    if (r == "teacher") return UiStyle::badgeStyle("rgba(59,130,246,0.65)", "rgba(59,130,246,0.20)", 700);
-    if (r == "student") return UiStyle::badgeStyle("rgba(34,197,94,0.62)", "rgba(34,197,94,0.18)", 700);
-    return UiStyle::badgeNeutralStyle();
-}
-
 struct UserEditResult {
     bool accepted = false;
     int id = 0;
@@ -343,24 +328,31 @@ QWidget* AdminWindow::buildUsersTab()
     tableLayout->setContentsMargins(12, 10, 12, 12);
     tableLayout->setSpacing(10);
 
-    usersTable = new QTableWidget(tableCard);
+    usersModel = new UsersTableModel(this);
+
+    usersTable = new QTableView(tableCard);
     UiStyle::applyStandardTableStyle(usersTable);
-    usersTable->setColumnCount(6);
-    usersTable->setHorizontalHeaderLabels({"ID", "ФИО", "login", "role", "groupId", "subgroup"});
+    usersTable->setModel(usersModel);
+    usersTable->setItemDelegateForColumn(UsersTableModel::ColRole, new RoleBadgeDelegate(usersTable));
     usersTable->setWordWrap(false);
-    usersTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-    usersTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
-    usersTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-    usersTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Fixed);
-    usersTable->horizontalHeader()->setSectionResizeMode(4, QHeaderView::Fixed);
-    usersTable->horizontalHeader()->setSectionResizeMode(5, QHeaderView::Fixed);
-    usersTable->setColumnWidth(0, 64);
-    usersTable->setColumnWidth(3, 116);
-    usersTable->setColumnWidth(4, 76);
-    usersTable->setColumnWidth(5, 86);
+    // Фиксированная высота строк: view не измеряет каждую строку при прокрутке
+    usersTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    usersTable->verticalHeader()->setDefaultSectionSize(30);
+    usersTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    usersTable->horizontalHeader()->setSectionResizeMode(UsersTableModel::ColName, QHeaderView::Stretch);
+    usersTable->horizontalHeader()->setSectionResizeMode(UsersTableModel::ColRole, QHeaderView::Fixed);
+    usersTable->horizontalHeader()->setSectionResizeMode(UsersTableModel::ColGroup, QHeaderView::Fixed);
+    usersTable->horizontalHeader()->setSectionResizeMode(UsersTableModel::ColSubgroup, QHeaderView::Fixed);
+    usersTable->setColumnWidth(UsersTableModel::ColId, 64);
+    usersTable->setColumnWidth(UsersTableModel::ColLogin, 160);
+    usersTable->setColumnWidth(UsersTableModel::ColRole, 116);
+    usersTable->setColumnWidth(UsersTableModel::ColGroup, 76);
+    usersTable->setColumnWidth(UsersTableModel::ColSubgroup, 86);
     usersTable->horizontalHeader()->setStretchLastSection(true);
     usersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     usersTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    usersTable->setSortingEnabled(true);
+    usersTable->sortByColumn(UsersTableModel::ColId, Qt::AscendingOrder);
     tableLayout->addWidget(usersTable, 1);
 
     mainCardLayout->addWidget(tableCard, 1);
@@ -370,20 +362,28 @@ QWidget* AdminWindow::buildUsersTab()
     connect(editUserButton, &QPushButton::clicked, this, &AdminWindow::onEditUser);
     connect(deleteUserButton, &QPushButton::clicked, this, &AdminWindow::onDeleteUser);
 
+    // Поиск идёт в БД постранично; ввод копим 200 мс, чтобы не искать на каждую букву
+    userSearchTimer = new QTimer(this);
+    userSearchTimer->setSingleShot(true);
+    userSearchTimer->setInterval(200);
+    connect(userSearchTimer, &QTimer::timeout, this, &AdminWindow::reloadUsers);
+
     if (userSearchEdit) {
-        connect(userSearchEdit, &QLineEdit::textChanged, this, &AdminWindow::reloadUsers);
+        connect(userSearchEdit, &QLineEdit::textChanged, userSearchTimer, qOverload<>(&QTimer::start));
     }
     if (userRoleFilterCombo) {
         connect(userRoleFilterCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &AdminWindow::reloadUsers);
     }
 
-    connect(usersTable, &QTableWidget::itemSelectionChanged, this, [this]() {
-        const bool hasSel = usersTable && usersTable->selectionModel() && !usersTable->selectionModel()->selectedRows().isEmpty();
+    auto updateButtons = [this]() {
+        const bool hasSel = selectedUserRow() >= 0;
         if (editUserButton) editUserButton->setEnabled(hasSel);
         if (deleteUserButton) deleteUserButton->setEnabled(hasSel);
-    });
+    };
+    connect(usersTable->selectionModel(), &QItemSelectionModel::selectionChanged, this, updateButtons);
+    connect(usersModel, &QAbstractItemModel::modelReset, this, updateButtons);
 
-    connect(usersTable, &QTableWidget::cellDoubleClicked, this, [this](int, int) {
+    connect(usersTable, &QTableView::doubleClicked, this, [this](const QModelIndex&) {
         onEditUser();
     });
 
@@ -393,46 +393,37 @@ QWidget* AdminWindow::buildUsersTab()
 
 void AdminWindow::reloadUsers()
 {
-    if (!db || !usersTable) return;
-    usersTable->setRowCount(0);
-
-    const QString q = userSearchEdit ? userSearchEdit->text().trimmed() : QString();
-    const QString roleFilter = userRoleFilterCombo ? userRoleFilterCombo->currentData().toString().trimmed().toLower() : QString();
-
-    std::vector<std::tuple<int, std::string, std::string, std::string, int, int>> users;
-    if (!db->getAllUsers(users)) return;
-
-    for (const auto& u : users) {
-        const int id = std::get<0>(u);
-        const QString username = QString::fromStdString(std::get<1>(u));
-        const QString name = QString::fromStdString(std::get<2>(u));
-        const QString role = QString::fromStdString(std::get<3>(u));
-        const int groupId = std::get<4>(u);
-        const int subgroup = std::get<5>(u);
-
-        if (!roleFilter.isEmpty() && role.trimmed().toLower() != roleFilter) {
-            continue;
-        }
-        if (!q.isEmpty()) {
-            const QString hay = (name + " " + username).toLower();
-            if (!hay.contains(q.toLower())) {
-                continue;
-            }
+    if (!db || !usersModel) return;
+    if (userSearchTimer) userSearchTimer->stop();
+
+    // Запрос фиксируется на момент reload: fetchMore() при прокрутке дочитывает тот же поиск
+    const std::string query = userSearchEdit ? userSearchEdit->text().trimmed().toStdString() : std::string();
+    const std::string role = userRoleFilterCombo ? userRoleFilterCombo->currentData().toString().trimmed().toStdString() : std::string();
+
+    Database* database = db;
+    usersModel->setPageLoader([database, query, role](int offset, int limit, int sortColumn, Qt::SortOrder order,
+                                                      UsersTableModel::Rows& outRows, int& outTotal) {
+        Database::UserSortKey key = Database::UserSortKey::Id;
+        switch (sortColumn) {
+        case UsersTableModel::ColName: key = Database::UserSortKey::Name; break;
+        case UsersTableModel::ColLogin: key = Database::UserSortKey::Username; break;
+        case UsersTableModel::ColRole: key = Database::UserSortKey::Role; break;
+        case UsersTableModel::ColGroup: key = Database::UserSortKey::GroupId; break;
+        case UsersTableModel::ColSubgroup: key = Database::UserSortKey::Subgroup; break;
+        default: break;
         }
+        return database->searchUsers(query, role, offset, limit, outRows, outTotal, key, order == Qt::AscendingOrder);
+    });
 
-        const int row = usersTable->rowCount();
-        usersTable->insertRow(row);
-        usersTable->setItem(row, 0, new QTableWidgetItem(QString::number(id)));
-        usersTable->setItem(row, 1, new QTableWidgetItem(name));
-        usersTable->setItem(row, 2, new QTableWidgetItem(username));
-        auto* roleItem = new QTableWidgetItem();
-        roleItem->setData(Qt::UserRole, role);
-        roleItem->setText("");
-        usersTable->setItem(row, 3, roleItem);
-        usersTable->setCellWidget(row, 3, makeBadge(usersTable, role, roleBadgeStyle(role)));
-        usersTable->setItem(row, 4, new QTableWidgetItem(QString::number(groupId)));
-        usersTable->setItem(row, 5, new QTableWidgetItem(QString::number(subgroup)));
-    }
+    usersModel->reload();
+}
+
+int AdminWindow::selectedUserRow() const
+{
+    if (!usersTable || !usersTable->selectionModel()) return -1;
+    const auto sel = usersTable->selectionModel()->selectedRows();
+    if (sel.isEmpty()) return -1;
+    return sel.front().row();
 }
 
 void AdminWindow::onAddUser()
@@ -525,20 +516,20 @@ void AdminWindow::onAddUser()
 
 void AdminWindow::onEditUser()
 {
-    if (!db || !usersTable || !usersTable->selectionModel()) return;
-    const auto sel = usersTable->selectionModel()->selectedRows();
-    if (sel.isEmpty()) return;
-    const int row = sel.front().row();
-    const int id = usersTable->item(row, 0) ? usersTable->item(row, 0)->text().toInt() : 0;
+    if (!db || !usersModel) return;
+    const int row = selectedUserRow();
+    if (row < 0) return;
+    const auto user = usersModel->userAt(row);
+    const int id = user.id;
     if (id <= 0) return;
 
     UserEditResult init;
     init.id = id;
-    init.name = usersTable->item(row, 1) ? usersTable->item(row, 1)->text() : QString();
-    init.username = usersTable->item(row, 2) ? usersTable->item(row, 2)->text() : QString();
-    init.role = usersTable->item(row, 3) ? usersTable->item(row, 3)->data(Qt::UserRole).toString() : QString();
-    init.groupId = usersTable->item(row, 4) ? usersTable->item(row, 4)->text().toInt() : 0;
-    init.subgroup = usersTable->item(row, 5) ? usersTable->item(row, 5)->text().toInt() : 0;
+    init.name = user.name;
+    init.username = user.username;
+    init.role = user.role;
+    init.groupId = user.groupId;
+    init.subgroup = user.subgroup;
 
     UserEditResult res = runUserEditDialog(this, db, "Редактировать пользователя", false, init);
     if (!res.accepted) return;
@@ -597,14 +588,14 @@ void AdminWindow::onEditUser()
 
 void AdminWindow::onDeleteUser()
 {
-    if (!db || !usersTable || !usersTable->selectionModel()) return;
-    const auto sel = usersTable->selectionModel()->selectedRows();
-    if (sel.isEmpty()) return;
-    const int row = sel.front().row();
-    const int id = usersTable->item(row, 0)->text().toInt();
+    if (!db || !usersModel) return;
+    const int row = selectedUserRow();
+    if (row < 0) return;
+    const auto user = usersModel->userAt(row);
+    const int id = user.id;
     if (id <= 0) return;
 
-    const QString role = usersTable->item(row, 3) ? usersTable->item(row, 3)->data(Qt::UserRole).toString().trimmed().toLower() : QString();
+    const QString role = user.role.trimmed().toLower();
 
     if (role == "teacher") {
         int cnt = 0;
@@ -0,0 +1,455 @@
+// Микробенчмарки методов Database/Statistics/D1Randomizer на синтетической БД.
+//
+// База строится через Database::initialize() и обычные insert-методы
+// (insertUser, addScheduleEntry, addGrade, addAbsence) в одной транзакции;
+// масштаб задаётся аргументами. Каждый метод вызывается --iterations раз
+// на случайных ключах (seed фиксирован), время каждого вызова — отдельный замер.
+//
+// Результат — JSON в stdout (или в файл --json), ход работы и таблица — в stderr,
+// чтобы вывод можно было сохранять и сравнивать между коммитами. Database пишет
+// свой лог в std::cout, поэтому на время работы std::cout перенаправлен в stderr,
+// а JSON пишется в сохранённый stdout.
+//
+// Запуск: db_bench [--groups N] [--students N] [--weeks N] [--grades N]
+//                  [--iterations N] [--db file] [--json file]
+
+#include "database.h"
+#include "statistics.h"
+#include "services/d1_randomizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSemesterId = 1;
+constexpr CivilDate kSemesterStart = CivilDate::fromYmd(2025, 9, 1);  // понедельник
+
+struct Scale {
+    int groups = 8;
+    int studentsPerGroup = 25;
+    int weeks = 17;            // недель в cycleweeks (и длина семестра)
+    int gradesPerStudent = 60;
+    int iterations = 200;
+};
+
+// Предметы и типы занятий — как в правилах D1Randomizer, чтобы генерация находила даты
+struct LessonKind {
+    const char* subject;
+    const char* lessonType;
+};
+
+const char* const kSubjects[] = {
+    "АПЭЦ", "ТВиМС", "ТГ", "ВМиКА", "БЖЧ", "ООП", "ОИнфБ", "БД", "МСиСвИТ", "ФизК",
+};
+constexpr int kSubjectCount = static_cast<int>(sizeof(kSubjects) / sizeof(kSubjects[0]));
+
+const LessonKind kPractice[] = {
+    {"АПЭЦ", "ЛР"}, {"ТВиМС", "ПЗ"}, {"ТГ", "ПЗ"}, {"ВМиКА", "ЛР"}, {"БЖЧ", "ПЗ"},
+    {"БЖЧ", "ЛР"}, {"ООП", "ЛР"}, {"ОИнфБ", "ПЗ"}, {"БД", "ЛР"}, {"БД", "ПЗ"}, {"МСиСвИТ", "ПЗ"},
+};
+constexpr int kPracticeCount = static_cast<int>(sizeof(kPractice) / sizeof(kPractice[0]));
+
+struct Dataset {
+    std::vector<int> groupIds;
+    std::vector<int> studentIds;
+    std::vector<int> subjectIds;  // индекс как в kSubjects
+    int scheduleRows = 0;
+    int gradeRows = 0;
+    int absenceRows = 0;
+    double generateMs = 0.0;
+};
+
+struct BenchResult {
+    std::string name;
+    int iterations = 0;
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p95Us = 0.0;
+    double minUs = 0.0;
+    double maxUs = 0.0;
+};
+
+double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+int lastId(Database& db)
+{
+    return static_cast<int>(sqlite3_last_insert_rowid(db.rawHandle()));
+}
+
+bool generate(Database& db, const Scale& scale, Dataset& out)
+{
+    const auto t0 = Clock::now();
+    if (!db.execute("BEGIN TRANSACTION;")) return false;
+
+    auto fail = [&](const char* what) {
+        std::cerr << "[bench] generate: " << what << " failed\n";
+        db.execute("ROLLBACK;");
+        return false;
+    };
+
+    // Недели цикла 1..4 подряд, начиная с kSemesterStart
+    std::string sql = "INSERT INTO cycleweeks (weekofcycle, startdate, enddate) VALUES ";
+    for (int w = 0; w < scale.weeks; ++w) {
+        const CivilDate from = kSemesterStart.addDays(w * 7);
+        if (w > 0) sql += ",";
+        sql += "(" + std::to_string(w % 4 + 1) + ", '" + from.toISO() + "', '" + from.addDays(6).toISO() + "')";
+    }
+    sql += ";";
+    if (!db.execute(sql)) return fail("cycleweeks");
+
+    const CivilDate semesterEnd = kSemesterStart.addDays(scale.weeks * 7 - 1);
+    if (!db.execute("INSERT INTO semesters (id, name, startdate, enddate) VALUES (1, 'bench', '"
+                    + kSemesterStart.toISO() + "', '" + semesterEnd.toISO() + "');")) {
+        return fail("semesters");
+    }
+
+    // Группа 0 — общие лекции (addScheduleEntry переносит туда все ЛК)
+    if (!db.execute("INSERT INTO groups (id, name) VALUES (0, 'Общая лекция');")) return fail("groups");
+    for (int g = 1; g <= scale.groups; ++g) {
+        if (!db.execute("INSERT INTO groups (id, name) VALUES (" + std::to_string(g) + ", 'bench" + std::to_string(g) + "');")) {
+            return fail("groups");
+        }
+        out.groupIds.push_back(g);
+    }
+
+    for (int s = 0; s < kSubjectCount; ++s) {
+        if (!db.execute(std::string("INSERT INTO subjects (name) VALUES ('") + kSubjects[s] + "');")) return fail("subjects");
+        out.subjectIds.push_back(lastId(db));
+    }
+    auto subjectId = [&](const char* name) {
+        for (int s = 0; s < kSubjectCount; ++s) {
+            if (std::strcmp(kSubjects[s], name) == 0) return out.subjectIds[s];
+        }
+        return 0;
+    };
+
+    // Преподаватель на предмет
+    std::vector<int> teacherIds;
+    for (int s = 0; s < kSubjectCount; ++s) {
+        const std::string login = "bench_t" + std::to_string(s + 1);
+        if (!db.insertUser(login, "123", "teacher", "Преподаватель " + std::to_string(s + 1), 0, 0)) return fail("teachers");
+        teacherIds.push_back(lastId(db));
+    }
+    auto teacherFor = [&](const char* subject) {
+        for (int s = 0; s < kSubjectCount; ++s) {
+            if (std::strcmp(kSubjects[s], subject) == 0) return teacherIds[s];
+        }
+        return teacherIds.front();
+    };
+
+    for (int g : out.groupIds) {
+        for (int i = 0; i < scale.studentsPerGroup; ++i) {
+            const std::string login = "bench_s" + std::to_string(g) + "_" + std::to_string(i + 1);
+            const int subgroup = (i < scale.studentsPerGroup / 2) ? 1 : 2;
+            if (!db.insertUser(login, "123", "student", "Студент " + std::to_string(g) + "-" + std::to_string(i + 1), g, subgroup)) {
+                return fail("students");
+            }
+            out.studentIds.push_back(lastId(db));
+        }
+    }
+
+    // Расписание: 1-я пара Пн..Пт — общая лекция (добавляется один раз),
+    // 2..4 пары — практика, ЛР по подгруппам. Сдвиг по группе разводит группы по предметам.
+    for (int week = 1; week <= 4; ++week) {
+        for (int day = 1; day <= 5; ++day) {
+            const char* lecture = kSubjects[(week * 5 + day) % kSubjectCount];
+            if (!db.addScheduleEntry(1, 0, day, 1, week, subjectId(lecture), teacherFor(lecture), "100-1", "ЛК")) {
+                return fail("schedule");
+            }
+            ++out.scheduleRows;
+
+            for (int g : out.groupIds) {
+                for (int lesson = 2; lesson <= 4; ++lesson) {
+                    const LessonKind& k = kPractice[(g + week * 15 + day * 3 + lesson) % kPracticeCount];
+                    const std::string room = std::to_string(100 + g) + "-" + std::to_string(lesson);
+                    const bool bySubgroup = std::strcmp(k.lessonType, "ЛР") == 0;
+                    for (int sg = bySubgroup ? 1 : 0; sg <= (bySubgroup ? 2 : 0); ++sg) {
+                        if (!db.addScheduleEntry(g, sg, day, lesson, week, subjectId(k.subject),
+                                                 teacherFor(k.subject), room, k.lessonType)) {
+                            return fail("schedule");
+                        }
+                        ++out.scheduleRows;
+                    }
+                }
+            }
+        }
+    }
+
+    // Оценки: k-я оценка студента — предмет k % S, день k / S (ключ не повторяется)
+    const int semesterDays = scale.weeks * 7;
+    for (int studentId : out.studentIds) {
+        for (int k = 0; k < scale.gradesPerStudent; ++k) {
+            const int day = (k / kSubjectCount) % semesterDays;
+            const std::string date = kSemesterStart.addDays(day).toISO();
+            if (!db.addGrade(studentId, out.subjectIds[k % kSubjectCount], kSemesterId,
+                             (studentId + k) % 11, date, "")) {
+                return fail("grades");
+            }
+            ++out.gradeRows;
+        }
+        // Несколько пропусков в дни без оценок
+        for (int a = 0; a < 3; ++a) {
+            const int day = (scale.gradesPerStudent / kSubjectCount + 1 + a * 7) % semesterDays;
+            const std::string date = kSemesterStart.addDays(day).toISO();
+            if (!db.addAbsence(studentId, out.subjectIds[a], kSemesterId, 2, date,
+                               (a % 2 == 0) ? "unexcused" : "excused")) {
+                return fail("absences");
+            }
+            ++out.absenceRows;
+        }
+    }
+
+    if (!db.execute("COMMIT;")) return fail("commit");
+    db.invalidateCalendar();
+    out.generateMs = msSince(t0);
+    return true;
+}
+
+BenchResult measure(const std::string& name, int iterations, const std::function<void(int)>& call)
+{
+    call(0);  // прогрев: кэш statement'ов и страниц
+
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(iterations));
+    for (int i = 0; i < iterations; ++i) {
+        const auto t0 = Clock::now();
+        call(i);
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    }
+
+    BenchResult r;
+    r.name = name;
+    r.iterations = iterations;
+    if (samples.empty()) return r;
+
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    std::sort(samples.begin(), samples.end());
+    r.meanUs = sum / static_cast<double>(samples.size());
+    r.p50Us = samples[samples.size() / 2];
+    r.p95Us = samples[std::min(samples.size() - 1, samples.size() * 95 / 100)];
+    r.minUs = samples.front();
+    r.maxUs = samples.back();
+    return r;
+}
+
+std::string toJson(const Scale& scale, const Dataset& data, const std::vector<BenchResult>& results)
+{
+    std::ostringstream os;
+    os.setf(std::ios::fixed);
+    os.precision(3);
+    os << "{\n"
+       << "  \"benchmark\": \"db_bench\",\n"
+       << "  \"scale\": {\"groups\": " << scale.groups
+       << ", \"studentsPerGroup\": " << scale.studentsPerGroup
+       << ", \"weeks\": " << scale.weeks
+       << ", \"gradesPerStudent\": " << scale.gradesPerStudent
+       << ", \"iterations\": " << scale.iterations << "},\n"
+       << "  \"rows\": {\"students\": " << data.studentIds.size()
+       << ", \"schedule\": " << data.scheduleRows
+       << ", \"grades\": " << data.gradeRows
+       << ", \"absences\": " << data.absenceRows << "},\n"
+       << "  \"generateMs\": " << data.generateMs << ",\n"
+       << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+           << ", \"meanUs\": " << r.meanUs << ", \"p50Us\": " << r.p50Us
+           << ", \"p95Us\": " << r.p95Us << ", \"minUs\": " << r.minUs
+           << ", \"maxUs\": " << r.maxUs << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+    return os.str();
+}
+
+// Перенаправляет std::cout в буфер std::cerr до конца области видимости
+struct CoutToStderr {
+    std::streambuf* saved = std::cout.rdbuf(std::cerr.rdbuf());
+    ~CoutToStderr() { std::cout.rdbuf(saved); }
+};
+
+bool parseArgs(int argc, char** argv, Scale& scale, std::string& dbFile, std::string& jsonFile)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "[bench] missing value for " << arg << "\n";
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--groups") scale.groups = std::max(1, std::atoi(value));
+        else if (arg == "--students") scale.studentsPerGroup = std::max(1, std::atoi(value));
+        else if (arg == "--weeks") scale.weeks = std::max(4, std::atoi(value));
+        else if (arg == "--grades") scale.gradesPerStudent = std::max(0, std::atoi(value));
+        else if (arg == "--iterations") scale.iterations = std::max(1, std::atoi(value));
+        else if (arg == "--db") dbFile = value;
+        else if (arg == "--json") jsonFile = value;
+        else {
+            std::cerr << "[bench] unknown argument " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void removeDbFiles(const std::string& file)
+{
+    std::remove(file.c_str());
+    std::remove((file + "-wal").c_str());
+    std::remove((file + "-shm").c_str());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Scale scale;
+    std::string dbFile = "db_bench.db";
+    std::string jsonFile;
+    if (!parseArgs(argc, argv, scale, dbFile, jsonFile)) {
+        std::cerr << "usage: db_bench [--groups N] [--students N] [--weeks N] [--grades N]"
+                     " [--iterations N] [--db file] [--json file]\n";
+        return 2;
+    }
+
+    // Всё, что Database печатает в std::cout, уходит в stderr; stdout — только для JSON
+    std::ostream stdoutStream(std::cout.rdbuf());
+    const CoutToStderr coutGuard;
+
+    removeDbFiles(dbFile);
+    Database db(dbFile);
+    if (!db.connect() || !db.initialize()) {
+        std::cerr << "[bench] cannot open/initialize " << dbFile << "\n";
+        return 1;
+    }
+
+    Dataset data;
+    if (!generate(db, scale, data)) return 1;
+    std::cerr << "[bench] generated " << data.studentIds.size() << " students, "
+              << data.scheduleRows << " schedule rows, " << data.gradeRows << " grades in "
+              << data.generateMs << " ms\n";
+
+    std::mt19937 rng(42);
+    auto pick = [&rng](const std::vector<int>& v) {
+        return v[std::uniform_int_distribution<size_t>(0, v.size() - 1)(rng)];
+    };
+    const int n = scale.iterations;
+    const int semesterDays = scale.weeks * 7;
+
+    // Ключи заранее, чтобы ГПСЧ не попадал в замер
+    std::vector<int> students(n), groups(n), subjects(n), days(n), weeks(n), weekdays(n);
+    for (int i = 0; i < n; ++i) {
+        students[i] = pick(data.studentIds);
+        groups[i] = pick(data.groupIds);
+        subjects[i] = pick(data.subjectIds);
+        days[i] = std::uniform_int_distribution<int>(0, semesterDays - 1)(rng);
+        weeks[i] = 1 + i % 4;
+        weekdays[i] = 1 + i % 5;
+    }
+    std::vector<std::string> dates(n);
+    for (int i = 0; i < n; ++i) dates[i] = kSemesterStart.addDays(days[i]).toISO();
+
+    std::vector<BenchResult> results;
+
+    std::vector<std::tuple<int, int, int, std::string, std::string, std::string, std::string>> sched;
+    results.push_back(measure("getScheduleForGroup", n, [&](int i) {
+        db.getScheduleForGroup(groups[i], weekdays[i], weeks[i], sched);
+    }));
+
+    std::vector<int> practiceSubjectIds(kPracticeCount);
+    for (int k = 0; k < kPracticeCount; ++k) db.getSubjectIdByName(kPractice[k].subject, practiceSubjectIds[k]);
+
+    std::vector<LessonOccurrence> occurrences;
+    results.push_back(measure("getLessonOccurrencesForStudent", n, [&](int i) {
+        const int k = i % kPracticeCount;
+        db.getLessonOccurrencesForStudent(students[i], practiceSubjectIds[k], kPractice[k].lessonType,
+                                          kSemesterId, occurrences);
+    }));
+
+    std::vector<std::tuple<std::string, int, std::string, std::string>> grades;
+    results.push_back(measure("getStudentGradesForSemester", n, [&](int i) {
+        db.getStudentGradesForSemester(students[i], kSemesterId, grades);
+    }));
+
+    std::vector<StudentLessonRecord> gradesWithLessons;
+    results.push_back(measure("getStudentGradesWithLessons", n, [&](int i) {
+        db.getStudentGradesWithLessons(students[i], kSemesterId, gradesWithLessons);
+    }));
+
+    results.push_back(measure("findGradeId", n, [&](int i) {
+        int id = 0;
+        db.findGradeId(students[i], subjects[i], kSemesterId, dates[i], id);
+    }));
+
+    // Запись внутри транзакции с откатом: данные не меняются между прогонами
+    db.execute("BEGIN TRANSACTION;");
+    results.push_back(measure("upsertGradeByKey", n, [&](int i) {
+        db.upsertGradeByKey(students[i], subjects[i], kSemesterId, 7, dates[i], "");
+    }));
+    db.execute("ROLLBACK;");
+
+    results.push_back(measure("Statistics::calculateStudentAverage", n, [&](int i) {
+        Statistics::calculateStudentAverage(db, students[i], kSemesterId);
+    }));
+    results.push_back(measure("Statistics::calculateStudentSubjectAverage", n, [&](int i) {
+        Statistics::calculateStudentSubjectAverage(db, students[i], subjects[i], kSemesterId);
+    }));
+    results.push_back(measure("Statistics::calculateGroupSubjectAverage", n, [&](int i) {
+        Statistics::calculateGroupSubjectAverage(db, groups[i], subjects[i], kSemesterId);
+    }));
+    results.push_back(measure("Statistics::computeGroupReport", n, [&](int i) {
+        Statistics::computeGroupReport(db, groups[i], kSemesterId);
+    }));
+
+    std::vector<StudentMonthStats> series;
+    results.push_back(measure("getStudentMonthSeries", n, [&](int i) {
+        db.getStudentMonthSeries(students[i], kSemesterId, series);
+    }));
+
+    // Генерация пишет и коммитит сама; overwrite=true держит объём данных постоянным
+    const int d1Iterations = std::max(1, std::min(n, 10));
+    D1Randomizer randomizer(db, 42);
+    results.push_back(measure("D1Randomizer::generateForGroup", d1Iterations, [&](int i) {
+        const auto r = randomizer.generateForGroup(groups[i], kSemesterId, true);
+        if (!r.ok) std::cerr << "[bench] D1: " << r.error << "\n";
+    }));
+
+    std::fprintf(stderr, "\n%-46s %8s %12s %12s %12s\n", "method", "calls", "mean us", "p50 us", "p95 us");
+    for (const auto& r : results) {
+        std::fprintf(stderr, "%-46s %8d %12.1f %12.1f %12.1f\n",
+                     r.name.c_str(), r.iterations, r.meanUs, r.p50Us, r.p95Us);
+    }
+
+    const std::string json = toJson(scale, data, results);
+    if (jsonFile.empty()) {
+        stdoutStream << json << std::flush;
+    } else {
+        std::ofstream f(jsonFile);
+        f << json;
+        if (!f) {
+            std::cerr << "[bench] cannot write " << jsonFile << "\n";
+            return 1;
+        }
+    }
+
+    db.disconnect();
+    removeDbFiles(dbFile);
+    return 0;
+}
@@ -0,0 +1,221 @@
+// Бенчмарк индексов grades (миграция схемы 1).
+//
+// Строит синтетическую таблицу grades (по умолчанию 1 000 000 строк),
+// затем замеряет findGradeId / getStudentSubjectGrades / upsertGradeByKey
+// сначала без индексов (как до миграции), потом после применения миграции.
+//
+// Запуск: grades_index_bench [rows] [lookups] [dbfile]
+
+#include "database.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSubjects = 12;
+constexpr int kSemesterId = 1;
+
+struct Key {
+    int studentId;
+    int subjectId;
+    std::string date;
+};
+
+std::string dateForDay(int day)
+{
+    // 120 учебных дней, начиная с 2025-09-01 (без перехода через год)
+    static const int monthDays[] = {30, 31, 30, 31};
+    int month = 9;
+    int d = day % 120;
+    for (int i = 0; i < 4 && d >= monthDays[i]; ++i) {
+        d -= monthDays[i];
+        ++month;
+    }
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "2025-%02d-%02d", month, d + 1);
+    return buf;
+}
+
+bool exec(Database& db, const char* sql)
+{
+    return db.execute(sql);
+}
+
+bool fillGrades(Database& db, int rows)
+{
+    sqlite3* h = db.rawHandle();
+    if (!exec(db, "BEGIN TRANSACTION;")) return false;
+
+    exec(db, "INSERT OR IGNORE INTO semesters (id, name, startdate, enddate) "
+             "VALUES (1, 'bench', '2025-09-01', '2025-12-31');");
+
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql =
+        "INSERT INTO grades (studentid, subjectid, semesterid, value, date, gradetype) "
+        "VALUES (?, ?, ?, ?, ?, '');";
+    if (sqlite3_prepare_v2(h, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        exec(db, "ROLLBACK;");
+        return false;
+    }
+
+    // Уникальный ключ: (student, subject, day) — ровно rows строк без дублей
+    const int perStudent = kSubjects * 120;
+    for (int i = 0; i < rows; ++i) {
+        const int studentId = 1 + i / perStudent;
+        const int subjectId = 1 + (i / 120) % kSubjects;
+        const std::string date = dateForDay(i % 120);
+        sqlite3_bind_int(stmt, 1, studentId);
+        sqlite3_bind_int(stmt, 2, subjectId);
+        sqlite3_bind_int(stmt, 3, kSemesterId);
+        sqlite3_bind_int(stmt, 4, i % 11);
+        sqlite3_bind_text(stmt, 5, date.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            sqlite3_finalize(stmt);
+            exec(db, "ROLLBACK;");
+            return false;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return exec(db, "COMMIT;");
+}
+
+std::vector<Key> makeKeys(int rows, int count)
+{
+    std::mt19937 rng(42);
+    const int students = std::max(1, rows / (kSubjects * 120));
+    std::uniform_int_distribution<int> st(1, students);
+    std::uniform_int_distribution<int> su(1, kSubjects);
+    std::uniform_int_distribution<int> dd(0, 119);
+
+    std::vector<Key> keys;
+    keys.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        keys.push_back({st(rng), su(rng), dateForDay(dd(rng))});
+    }
+    return keys;
+}
+
+struct Timings {
+    double findUs = 0;
+    double subjectGradesUs = 0;
+    double upsertUs = 0;
+};
+
+template <typename F>
+double perCallUs(int calls, F&& f)
+{
+    const auto t0 = Clock::now();
+    for (int i = 0; i < calls; ++i) f(i);
+    const auto t1 = Clock::now();
+    return std::chrono::duration<double, std::micro>(t1 - t0).count() / std::max(1, calls);
+}
+
+Timings measure(Database& db, const std::vector<Key>& keys)
+{
+    Timings t;
+    const int n = static_cast<int>(keys.size());
+
+    int found = 0;
+    t.findUs = perCallUs(n, [&](int i) {
+        int id = 0;
+        db.findGradeId(keys[i].studentId, keys[i].subjectId, kSemesterId, keys[i].date, id);
+        if (id > 0) ++found;
+    });
+
+    std::vector<std::tuple<int, std::string, std::string>> grades;
+    t.subjectGradesUs = perCallUs(n, [&](int i) {
+        db.getStudentSubjectGrades(keys[i].studentId, keys[i].subjectId, kSemesterId, grades);
+    });
+
+    exec(db, "BEGIN TRANSACTION;");
+    t.upsertUs = perCallUs(n, [&](int i) {
+        db.upsertGradeByKey(keys[i].studentId, keys[i].subjectId, kSemesterId, 7, keys[i].date, "");
+    });
+    exec(db, "ROLLBACK;");
+
+    if (found != n) {
+        std::cerr << "[bench] warning: found " << found << " of " << n << " keys\n";
+    }
+    return t;
+}
+
+void printRow(const char* label, const Timings& t)
+{
+    std::printf("%-16s findGradeId %10.2f us   getStudentSubjectGrades %10.2f us   upsertGradeByKey %10.2f us\n",
+                label, t.findUs, t.subjectGradesUs, t.upsertUs);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int rows = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const int lookups = argc > 2 ? std::atoi(argv[2]) : 200;
+    const std::string file = argc > 3 ? argv[3] : "grades_index_bench.db";
+
+    std::remove(file.c_str());
+    {
+        // "До": схема как до миграции 1 — таблицы без индексов grades
+        Database schema(file);
+        if (!schema.connect() || !schema.initialize()) {
+            std::cerr << "[bench] cannot open/initialize " << file << "\n";
+            return 1;
+        }
+        exec(schema, "DROP INDEX IF EXISTS idxgradeskey;"
+                     "DROP INDEX IF EXISTS idxgradessubjectsemester;"
+                     "PRAGMA user_version = 0;");
+    }
+
+    // Новое соединение без initialize(): Database не знает о миграциях,
+    // upsertGradeByKey идёт старым путём find + update/insert
+    Database db(file);
+    if (!db.connect()) {
+        std::cerr << "[bench] cannot open " << file << "\n";
+        return 1;
+    }
+    // Без FK: синтетические studentid/subjectid не существуют в users/subjects
+    exec(db, "PRAGMA foreign_keys = OFF;");
+    exec(db, "PRAGMA synchronous = OFF;");
+
+    std::cout << "[bench] filling grades: " << rows << " rows\n";
+    const auto f0 = Clock::now();
+    if (!fillGrades(db, rows)) {
+        std::cerr << "[bench] fill failed\n";
+        return 1;
+    }
+    const auto f1 = Clock::now();
+    std::cout << "[bench] fill: "
+              << std::chrono::duration<double, std::milli>(f1 - f0).count() << " ms\n";
+
+    const std::vector<Key> keys = makeKeys(rows, lookups);
+    const Timings before = measure(db, keys);
+
+    // "После": повторный initialize() применяет миграцию 1
+    const auto m0 = Clock::now();
+    if (!db.initialize()) {
+        std::cerr << "[bench] migration failed\n";
+        return 1;
+    }
+    const auto m1 = Clock::now();
+    std::cout << "[bench] migration: "
+              << std::chrono::duration<double, std::milli>(m1 - m0).count() << " ms"
+              << " (user_version=" << db.schemaVersion() << ")\n";
+
+    const Timings after = measure(db, keys);
+
+    printRow("before indexes", before);
+    printRow("after indexes", after);
+
+    db.disconnect();
+    std::remove(file.c_str());
+    return 0;
+}
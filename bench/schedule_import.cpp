@@ -0,0 +1,141 @@
+// Импорт расписания через ScheduleImporter и конвертер schedule_*.sql -> TSV.
+//
+// Импорт: сравнивает построчное выполнение скриптов (Database::loadScheduleFromFile)
+// с одним подготовленным INSERT в одной транзакции на копиях одной и той же БД.
+// Конвертер: разбирает скрипты и пишет все строки одним TSV-файлом.
+//
+// Запуск: schedule_import [--db school.db] [--threads N] file.sql|file.tsv ...
+//         schedule_import --to-tsv out.tsv file.sql ...
+
+#include "database.h"
+#include "services/schedule_importer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void removeDbFiles(const std::string& file)
+{
+    std::remove(file.c_str());
+    std::remove((file + "-wal").c_str());
+    std::remove((file + "-shm").c_str());
+}
+
+bool copyFile(const std::string& from, const std::string& to)
+{
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    if (!in || !out) return false;
+    out << in.rdbuf();
+    return static_cast<bool>(out);
+}
+
+// Копия БД с пустым расписанием
+bool openEmptyScheduleCopy(const std::string& source, const std::string& copy, Database& db)
+{
+    removeDbFiles(copy);
+    if (!copyFile(source, copy)) return false;
+    return db.connect() && db.initialize() && db.execute("DELETE FROM schedule;");
+}
+
+int convert(const std::string& outFile, const std::vector<std::string>& inputs)
+{
+    std::vector<ScheduleImportRow> rows;
+    for (const auto& path : inputs) {
+        auto parsed = ScheduleImporter::parseFile(path);
+        if (!parsed.ok) {
+            std::cerr << "[import] " << parsed.error << "\n";
+            return 1;
+        }
+        rows.insert(rows.end(), parsed.value.begin(), parsed.value.end());
+    }
+
+    std::ofstream out(outFile, std::ios::binary | std::ios::trunc);
+    out << ScheduleImporter::toTsv(rows);
+    if (!out) {
+        std::cerr << "[import] cannot write " << outFile << "\n";
+        return 1;
+    }
+    std::cout << outFile << ": " << rows.size() << " rows from " << inputs.size() << " file(s)\n";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string dbFile = "school.db";
+    std::string tsvOut;
+    int threads = 1;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "--db" || arg == "--to-tsv") && i + 1 < argc) {
+            (arg == "--db" ? dbFile : tsvOut) = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(0, std::atoi(argv[++i]));
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::cerr << "usage: schedule_import [--db school.db] [--threads N] file.sql|file.tsv ...\n"
+                     "       schedule_import --to-tsv out.tsv file.sql ...\n";
+        return 2;
+    }
+
+    if (!tsvOut.empty()) return convert(tsvOut, inputs);
+
+    // Построчное выполнение скриптов, как раньше при первом запуске
+    const std::string scriptCopy = dbFile + ".import_script.db";
+    double scriptMs = -1.0;
+    {
+        Database db(scriptCopy);
+        if (!openEmptyScheduleCopy(dbFile, scriptCopy, db)) {
+            std::cerr << "[import] cannot prepare copy of " << dbFile << "\n";
+            return 1;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        bool ok = true;
+        int scripts = 0;
+        for (const auto& path : inputs) {
+            if (path.size() > 4 && path.compare(path.size() - 4, 4, ".sql") == 0) {
+                ok = db.loadScheduleFromFile(path) && ok;
+                ++scripts;
+            }
+        }
+        if (ok && scripts > 0) scriptMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    removeDbFiles(scriptCopy);
+
+    const std::string importCopy = dbFile + ".import_bulk.db";
+    Result<ScheduleImportStats> result;
+    {
+        Database db(importCopy);
+        if (!openEmptyScheduleCopy(dbFile, importCopy, db)) {
+            std::cerr << "[import] cannot prepare copy of " << dbFile << "\n";
+            return 1;
+        }
+        ScheduleImporter importer(db);
+        result = importer.importFiles(inputs, threads);
+    }
+    removeDbFiles(importCopy);
+    if (!result.ok) {
+        std::cerr << "[import] " << result.error << "\n";
+        return 1;
+    }
+
+    const auto& s = result.value;
+    std::cout << "files=" << s.files << " rows=" << s.rows << " threads=" << s.threadsUsed << "\n"
+              << "parse=" << s.parseMs << "ms validate=" << s.validateMs << "ms insert=" << s.insertMs
+              << "ms total=" << s.totalMs << "ms rows/sec=" << s.rowsPerSec << "\n";
+    if (scriptMs >= 0.0) std::cout << "loadScheduleFromFile (.sql only): " << scriptMs << "ms\n";
+    return 0;
+}
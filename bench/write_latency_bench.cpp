@@ -0,0 +1,127 @@
+// Бенчмарк задержки записи по профилям соединения (ConnectionProfile).
+//
+// Имитирует сохранения из журнала преподавателя: каждая оценка — отдельная
+// autocommit-транзакция upsertGradeByKey (как в TeacherWindow::onSaveGrade).
+// Для каждого профиля создаётся новый файл БД.
+//
+// Запуск: write_latency_bench [writes] [dbfile]
+
+#include "database.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::string profile;
+    std::string journal;
+    double meanUs = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double maxUs = 0;
+};
+
+void removeDbFiles(const std::string& file)
+{
+    std::remove(file.c_str());
+    std::remove((file + "-wal").c_str());
+    std::remove((file + "-shm").c_str());
+    std::remove((file + "-journal").c_str());
+}
+
+std::string journalMode(Database& db)
+{
+    sqlite3_stmt* stmt = nullptr;
+    std::string mode = "?";
+    if (sqlite3_prepare_v2(db.rawHandle(), "PRAGMA journal_mode;", -1, &stmt, nullptr) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* t = sqlite3_column_text(stmt, 0);
+        mode = t ? reinterpret_cast<const char*>(t) : "?";
+    }
+    sqlite3_finalize(stmt);
+    return mode;
+}
+
+bool run(const ConnectionProfile& profile, int writes, const std::string& file, Result& out)
+{
+    removeDbFiles(file);
+
+    Database db(file);
+    db.setConnectionProfile(profile);
+    if (!db.connect() || !db.initialize()) return false;
+
+    // Минимальные справочники под FK
+    if (!db.execute(
+            "INSERT INTO semesters (id, name, startdate, enddate) VALUES (1, 'bench', '2025-09-01', '2025-12-31');"
+            "INSERT INTO subjects (id, name) VALUES (1, 'bench');"
+            "INSERT INTO groups (id, name) VALUES (1, 'bench');"
+            "INSERT INTO users (id, username, password, role, name, groupid, subgroup) "
+            "VALUES (1, 'bench', '1', 'student', 'bench', 1, 0);")) {
+        return false;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(writes);
+    char date[16];
+    for (int i = 0; i < writes; ++i) {
+        std::snprintf(date, sizeof(date), "2025-%02d-%02d", 9 + (i / 28) % 4, 1 + i % 28);
+        const auto t0 = Clock::now();
+        if (!db.upsertGradeByKey(1, 1, 1, i % 11, date, "")) return false;
+        const auto t1 = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+    }
+
+    out.profile = profile.name;
+    out.journal = journalMode(db);
+
+    double sum = 0;
+    for (double v : samples) sum += v;
+    std::sort(samples.begin(), samples.end());
+    out.meanUs = sum / samples.size();
+    out.p50Us = samples[samples.size() / 2];
+    out.p99Us = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    out.maxUs = samples.back();
+
+    db.disconnect();
+    removeDbFiles(file);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int writes = argc > 1 ? std::max(1, std::atoi(argv[1])) : 500;
+    const std::string file = argc > 2 ? argv[2] : "write_latency_bench.db";
+
+    const ConnectionProfile profiles[] = {
+        ConnectionProfile::safe(),
+        ConnectionProfile::balanced(),
+        ConnectionProfile::bulk(),
+    };
+
+    std::vector<Result> results;
+    for (const auto& p : profiles) {
+        Result r;
+        if (!run(p, writes, file, r)) {
+            std::cerr << "[bench] profile " << p.name << " failed\n";
+            return 1;
+        }
+        results.push_back(r);
+    }
+
+    std::printf("\n%-10s %-8s %12s %12s %12s %12s\n", "profile", "journal", "mean us", "p50 us", "p99 us", "max us");
+    for (const auto& r : results) {
+        std::printf("%-10s %-8s %12.1f %12.1f %12.1f %12.1f\n",
+                    r.profile.c_str(), r.journal.c_str(), r.meanUs, r.p50Us, r.p99Us, r.maxUs);
+    }
+    return 0;
+}
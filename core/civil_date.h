@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+// Календарная дата без времени и часового пояса: число дней с 1970-01-01 (int32).
+//
+// Заменяет строки "YYYY-MM-DD" + sscanf/stoi/mktime внутри backend'а:
+// сравнение и сдвиг на N дней — целочисленные, разбор/форматирование ISO
+// не аллоцируют (formatISO пишет в буфер char[11]). В SQLite даты по-прежнему
+// хранятся текстом, CivilDate — только представление в памяти.
+//
+// Значение по умолчанию — "нет даты" (isNull()), его же возвращает parseISO
+// при ошибке разбора.
+class CivilDate {
+public:
+    static constexpr std::size_t kISOLength = 10;  // "YYYY-MM-DD"
+
+    constexpr CivilDate() = default;
+
+    static constexpr CivilDate fromDays(std::int32_t days) { return CivilDate(days); }
+
+    // Без проверки: месяц/день вне диапазона дадут "нормализованную" дату
+    static constexpr CivilDate fromYmd(int y, int m, int d) { return CivilDate(daysFromCivil(y, m, d)); }
+
+    static constexpr bool isValidYmd(int y, int m, int d)
+    {
+        return y >= 0 && y <= 9999 && m >= 1 && m <= 12 && d >= 1 && d <= daysInMonth(y, m);
+    }
+
+    static constexpr bool isLeapYear(int y) { return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0; }
+
+    static constexpr int daysInMonth(int y, int m)
+    {
+        constexpr int kDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        return (m == 2 && isLeapYear(y)) ? 29 : kDays[m - 1];
+    }
+
+    // "YYYY-MM-DD"; символы после 10-го игнорируются (например, "2025-09-01 10:00").
+    // Несуществующая дата (2025-11-31) или мусор -> null.
+    static constexpr CivilDate parseISO(std::string_view s)
+    {
+        if (s.size() < kISOLength || s[4] != '-' || s[7] != '-') return CivilDate();
+
+        int v[3] = {0, 0, 0};
+        constexpr int kFrom[3] = {0, 5, 8};
+        constexpr int kLen[3] = {4, 2, 2};
+        for (int f = 0; f < 3; ++f) {
+            for (int i = kFrom[f]; i < kFrom[f] + kLen[f]; ++i) {
+                const char c = s[static_cast<std::size_t>(i)];
+                if (c < '0' || c > '9') return CivilDate();
+                v[f] = v[f] * 10 + (c - '0');
+            }
+        }
+
+        if (!isValidYmd(v[0], v[1], v[2])) return CivilDate();
+        return fromYmd(v[0], v[1], v[2]);
+    }
+
+    static constexpr CivilDate parseISO(const char* s)
+    {
+        return s ? parseISO(std::string_view(s)) : CivilDate();
+    }
+
+    constexpr bool isNull() const { return value == kNullDays; }
+    constexpr bool isValid() const { return value != kNullDays; }
+
+    constexpr std::int32_t days() const { return value; }
+
+    struct Ymd {
+        int year = 0;
+        int month = 0;
+        int day = 0;
+    };
+
+    constexpr Ymd ymd() const
+    {
+        // civil_from_days (H. Hinnant)
+        const std::int32_t z = value + 719468;
+        const std::int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const std::int32_t doe = z - era * 146097;
+        const std::int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const std::int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const std::int32_t mp = (5 * doy + 2) / 153;
+
+        Ymd r;
+        r.day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+        r.month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+        r.year = static_cast<int>(yoe + era * 400 + (r.month <= 2 ? 1 : 0));
+        return r;
+    }
+
+    constexpr int year() const { return ymd().year; }
+    constexpr int month() const { return ymd().month; }
+    constexpr int day() const { return ymd().day; }
+
+    // ISO-день недели: 1 = Пн .. 7 = Вс (1970-01-01 — четверг)
+    constexpr int isoWeekday() const
+    {
+        const std::int32_t w = (value % 7 + 7 + 3) % 7;  // 0 = Пн
+        return static_cast<int>(w) + 1;
+    }
+
+    // Ровно 10 символов + '\0'. Для null пишет пустую строку.
+    constexpr void formatISO(char (&out)[kISOLength + 1]) const
+    {
+        if (isNull()) {
+            out[0] = '\0';
+            return;
+        }
+        const Ymd d = ymd();
+        out[0] = static_cast<char>('0' + (d.year / 1000) % 10);
+        out[1] = static_cast<char>('0' + (d.year / 100) % 10);
+        out[2] = static_cast<char>('0' + (d.year / 10) % 10);
+        out[3] = static_cast<char>('0' + d.year % 10);
+        out[4] = '-';
+        out[5] = static_cast<char>('0' + d.month / 10);
+        out[6] = static_cast<char>('0' + d.month % 10);
+        out[7] = '-';
+        out[8] = static_cast<char>('0' + d.day / 10);
+        out[9] = static_cast<char>('0' + d.day % 10);
+        out[10] = '\0';
+    }
+
+    // Для границ API, которым нужна строка (SQL-параметры, UI)
+    std::string toISO() const
+    {
+        char buf[kISOLength + 1];
+        formatISO(buf);
+        return std::string(buf);
+    }
+
+    constexpr CivilDate addDays(int n) const { return isNull() ? *this : CivilDate(value + n); }
+
+    friend constexpr int operator-(CivilDate a, CivilDate b) { return a.value - b.value; }
+
+    friend constexpr bool operator==(CivilDate a, CivilDate b) { return a.value == b.value; }
+    friend constexpr bool operator!=(CivilDate a, CivilDate b) { return a.value != b.value; }
+    friend constexpr bool operator<(CivilDate a, CivilDate b) { return a.value < b.value; }
+    friend constexpr bool operator<=(CivilDate a, CivilDate b) { return a.value <= b.value; }
+    friend constexpr bool operator>(CivilDate a, CivilDate b) { return a.value > b.value; }
+    friend constexpr bool operator>=(CivilDate a, CivilDate b) { return a.value >= b.value; }
+
+private:
+    static constexpr std::int32_t kNullDays = std::numeric_limits<std::int32_t>::min();
+
+    constexpr explicit CivilDate(std::int32_t days) : value(days) {}
+
+    static constexpr std::int32_t daysFromCivil(int y, int m, int d)
+    {
+        // days_from_civil (H. Hinnant)
+        y -= (m <= 2) ? 1 : 0;
+        const std::int32_t era = (y >= 0 ? y : y - 399) / 400;
+        const std::int32_t yoe = y - era * 400;
+        const std::int32_t mp = (m + 9) % 12;
+        const std::int32_t doy = (153 * mp + 2) / 5 + d - 1;
+        const std::int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    std::int32_t value = kNullDays;
+};
+
+static_assert(CivilDate::fromYmd(1970, 1, 1).days() == 0, "CivilDate epoch");
+static_assert(CivilDate::parseISO("2025-09-01").isoWeekday() == 1, "2025-09-01 is a Monday");
+static_assert(CivilDate::parseISO("2025-09-29").addDays(5).month() == 10, "month rollover");
+static_assert(CivilDate::parseISO("2025-11-31").isNull(), "invalid day rejected");
@@ -0,0 +1,188 @@
+#include "core/connection_pool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+// ===== Lease =====
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool(std::exchange(other.pool, nullptr)),
+      conn(std::exchange(other.conn, nullptr)),
+      writer(other.writer)
+{
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        pool = std::exchange(other.pool, nullptr);
+        conn = std::exchange(other.conn, nullptr);
+        writer = other.writer;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease()
+{
+    release();
+}
+
+void ConnectionPool::Lease::release()
+{
+    if (pool && conn) pool->giveBack(conn, writer);
+    pool = nullptr;
+    conn = nullptr;
+}
+
+// ===== ConnectionPool =====
+
+int ConnectionPool::defaultReaderCount()
+{
+    const unsigned hw = std::thread::hardware_concurrency();
+    return static_cast<int>(std::clamp(hw, 2u, 8u));
+}
+
+ConnectionPool::ConnectionPool(std::string file, int readerCount, ConnectionProfile profile)
+    : file(std::move(file)), profile(std::move(profile)), wantedReaders(std::max(1, readerCount))
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    close();
+}
+
+bool ConnectionPool::open()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (opened) return true;
+
+    ConnectionProfile readerProfile = profile;
+    readerProfile.readOnly = true;
+    readerProfile.singleThread = true;
+
+    readers.clear();
+    freeReaders.clear();
+    readers.reserve(static_cast<size_t>(wantedReaders));
+    for (int i = 0; i < wantedReaders; ++i) {
+        Slot slot;
+        slot.db = std::make_unique<Database>(file);
+        slot.db->setConnectionProfile(readerProfile);
+        if (!slot.db->connect()) {
+            std::cerr << "[✗] ConnectionPool: cannot open reader #" << i << ": " << file << "\n";
+            readers.clear();
+            return false;
+        }
+        readers.push_back(std::move(slot));
+        freeReaders.push_back(readers.size() - 1);
+    }
+
+    writerBusy = false;
+    opened = true;
+    std::cout << "[✓] ConnectionPool: " << readers.size() << " readers (writer opens on first write())" << std::endl;
+    return true;
+}
+
+bool ConnectionPool::openWriter()
+{
+    // Вызывается под mutex
+    if (writer.db) return true;
+
+    ConnectionProfile writerProfile = profile;
+    writerProfile.readOnly = false;
+    writerProfile.singleThread = true;
+
+    writer.db = std::make_unique<Database>(file);
+    writer.db->setConnectionProfile(writerProfile);
+    if (!writer.db->connect()) {
+        std::cerr << "[✗] ConnectionPool: cannot open writer: " << file << "\n";
+        writer.db.reset();
+        return false;
+    }
+    writer.calendarEpoch = calendarEpoch.load();
+    return true;
+}
+
+void ConnectionPool::close()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!opened) return;
+
+    // Новые read()/write() получают пустой Lease; ждём возврата выданных
+    opened = false;
+    readerFree.notify_all();
+    writerFree.notify_all();
+    readerFree.wait(lock, [this] { return freeReaders.size() == readers.size(); });
+    writerFree.wait(lock, [this] { return !writerBusy; });
+
+    freeReaders.clear();
+    readers.clear();
+    writer.db.reset();
+}
+
+Database* ConnectionPool::checkout(Slot& slot)
+{
+    // Вызывается под mutex; сам сброс дешёвый (календарь перечитается лениво)
+    const unsigned long long epoch = calendarEpoch.load();
+    if (slot.calendarEpoch != epoch) {
+        slot.db->invalidateCalendar();
+        slot.calendarEpoch = epoch;
+    }
+    return slot.db.get();
+}
+
+ConnectionPool::Lease ConnectionPool::read()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (opened && freeReaders.empty()) {
+        ++readWaitCount;
+        readerFree.wait(lock, [this] { return !opened || !freeReaders.empty(); });
+    }
+    if (!opened) return {};
+
+    const size_t index = freeReaders.back();
+    freeReaders.pop_back();
+    return Lease(this, checkout(readers[index]), false);
+}
+
+ConnectionPool::Lease ConnectionPool::write()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (opened && writerBusy) {
+        ++writeWaitCount;
+        writerFree.wait(lock, [this] { return !opened || !writerBusy; });
+    }
+    if (!opened || !openWriter()) return {};
+
+    writerBusy = true;
+    return Lease(this, checkout(writer), true);
+}
+
+void ConnectionPool::giveBack(Database* conn, bool isWriter)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (isWriter) {
+            writerBusy = false;
+        } else {
+            for (size_t i = 0; i < readers.size(); ++i) {
+                if (readers[i].db.get() == conn) {
+                    freeReaders.push_back(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    // close() тоже ждёт на этих переменных, поэтому будим всех
+    if (isWriter) writerFree.notify_all();
+    else readerFree.notify_all();
+}
+
+void ConnectionPool::invalidateCalendars()
+{
+    ++calendarEpoch;
+}
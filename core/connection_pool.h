@@ -0,0 +1,113 @@
+#pragma once
+
+#include "database.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Пул соединений к одному файлу БД: N читающих (SQLITE_OPEN_READONLY) и одно пишущее.
+// Пишущее открывается при первом write(): в приложении пишет основной Database
+// (журнал, импорт, генераторы), а DbExecutor берёт из пула только читателей,
+// поэтому второго пишущего соединения к файлу без надобности нет.
+//
+// Каждое соединение — отдельный Database со своим кэшем подготовленных запросов
+// и календарём, поэтому потоки не делят ни sqlite3*, ни statement'ы.
+// В WAL читатели не блокируют друг друга и писателя.
+//
+// Соединение берётся через read()/write() и возвращается в пул деструктором Lease.
+// Пока Lease жив, соединением пользуется только его владелец (отсюда NOMUTEX).
+class ConnectionPool {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        Database* get() const { return conn; }
+        Database& operator*() const { return *conn; }
+        Database* operator->() const { return conn; }
+        explicit operator bool() const { return conn != nullptr; }
+
+        // Вернуть соединение раньше деструктора
+        void release();
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, Database* conn, bool writer)
+            : pool(pool), conn(conn), writer(writer) {}
+
+        ConnectionPool* pool = nullptr;
+        Database* conn = nullptr;
+        bool writer = false;
+    };
+
+    // По умолчанию — по числу ядер, но не больше 8
+    static int defaultReaderCount();
+
+    // profile применяется к писателю; читатели получают его же с readOnly = true
+    explicit ConnectionPool(std::string file,
+                            int readerCount = defaultReaderCount(),
+                            ConnectionProfile profile = ConnectionProfile::fromEnvironment());
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Открыть читателей. Схему и journal_mode не трогает: initialize() и переход в WAL
+    // делает основное соединение приложения (или писатель при первом write()).
+    bool open();
+    // Все Lease должны быть возвращены
+    void close();
+    bool isOpen() const { return opened; }
+
+    // Ждут свободного соединения; пустой Lease, если пул закрыт
+    // (или писателя не удалось открыть)
+    Lease read();
+    Lease write();
+
+    int readerCount() const { return static_cast<int>(readers.size()); }
+
+    // Сбросить кэш календаря (cycleweeks) во всех соединениях.
+    // Соединения, которые сейчас заняты, сбросят его при следующей выдаче.
+    void invalidateCalendars();
+
+    // Сколько раз read()/write() пришлось ждать свободного соединения
+    unsigned long long readWaits() const { return readWaitCount.load(); }
+    unsigned long long writeWaits() const { return writeWaitCount.load(); }
+
+private:
+    struct Slot {
+        std::unique_ptr<Database> db;
+        unsigned long long calendarEpoch = 0;
+    };
+
+    bool openWriter();
+    Database* checkout(Slot& slot);
+    void giveBack(Database* conn, bool writer);
+
+    std::string file;
+    ConnectionProfile profile;
+    int wantedReaders = 1;
+    bool opened = false;
+
+    std::mutex mutex;
+    std::condition_variable readerFree;
+    std::condition_variable writerFree;
+
+    std::vector<Slot> readers;
+    std::vector<size_t> freeReaders;  // индексы в readers
+    Slot writer;
+    bool writerBusy = false;
+
+    std::atomic<unsigned long long> calendarEpoch{0};
+    std::atomic<unsigned long long> readWaitCount{0};
+    std::atomic<unsigned long long> writeWaitCount{0};
+};
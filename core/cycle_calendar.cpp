@@ -0,0 +1,83 @@
+#include "core/cycle_calendar.h"
+
+#include <algorithm>
+
+void CycleCalendar::clear()
+{
+    byId.clear();
+    byStart.clear();
+    prefixMaxEnd.clear();
+    firstByCycle.clear();
+}
+
+void CycleCalendar::assign(std::vector<Week> weeks)
+{
+    clear();
+
+    weeks.erase(std::remove_if(weeks.begin(), weeks.end(), [](const Week& w) {
+                    return w.id <= 0 || w.start.isNull() || w.end.isNull();
+                }),
+                weeks.end());
+    std::sort(weeks.begin(), weeks.end(), [](const Week& a, const Week& b) { return a.id < b.id; });
+    byId = std::move(weeks);
+
+    const int n = static_cast<int>(byId.size());
+    if (n == 0) return;
+
+    for (int i = 0; i < n; ++i) {
+        if (byId[i].weekOfCycle > 0) firstByCycle.emplace_back(byId[i].weekOfCycle, i);
+    }
+    // stable: среди недель с одним номером первой остаётся наименьший id
+    std::stable_sort(firstByCycle.begin(), firstByCycle.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    firstByCycle.erase(std::unique(firstByCycle.begin(), firstByCycle.end(),
+                                   [](const auto& a, const auto& b) { return a.first == b.first; }),
+                       firstByCycle.end());
+
+    byStart.resize(n);
+    for (int i = 0; i < n; ++i) byStart[i] = i;
+    std::stable_sort(byStart.begin(), byStart.end(), [this](int a, int b) {
+        return byId[a].start < byId[b].start;
+    });
+
+    prefixMaxEnd.resize(n);
+    CivilDate maxEnd = byId[byStart[0]].end;
+    for (int i = 0; i < n; ++i) {
+        maxEnd = std::max(maxEnd, byId[byStart[i]].end);
+        prefixMaxEnd[i] = maxEnd;
+    }
+}
+
+const CycleCalendar::Week* CycleCalendar::findByDate(CivilDate date) const
+{
+    if (byStart.empty() || date.isNull()) return nullptr;
+
+    // Кандидаты: start <= date, т.е. byStart[0 .. hi)
+    const auto hiIt = std::upper_bound(byStart.begin(), byStart.end(), date,
+                                       [this](CivilDate d, int idx) { return d < byId[idx].start; });
+    const auto hi = static_cast<std::size_t>(hiIt - byStart.begin());
+
+    // Первая позиция, где max(end) >= date, — это и есть неделя с наименьшей start,
+    // покрывающая date (prefixMaxEnd неубывающий).
+    const auto loIt = std::lower_bound(prefixMaxEnd.begin(), prefixMaxEnd.end(), date);
+    const auto lo = static_cast<std::size_t>(loIt - prefixMaxEnd.begin());
+
+    if (lo >= hi) return nullptr;
+    return &byId[byStart[lo]];
+}
+
+const CycleCalendar::Week* CycleCalendar::findById(int weekId) const
+{
+    if (weekId <= 0) return nullptr;
+    const auto it = std::lower_bound(byId.begin(), byId.end(), weekId,
+                                     [](const Week& w, int id) { return w.id < id; });
+    return (it != byId.end() && it->id == weekId) ? &*it : nullptr;
+}
+
+const CycleCalendar::Week* CycleCalendar::firstOfCycleWeek(int weekOfCycle) const
+{
+    if (weekOfCycle < 1) return nullptr;
+    const auto it = std::lower_bound(firstByCycle.begin(), firstByCycle.end(), weekOfCycle,
+                                     [](const std::pair<int, int>& e, int c) { return e.first < c; });
+    return (it != firstByCycle.end() && it->first == weekOfCycle) ? &byId[it->second] : nullptr;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/civil_date.h"
+
+#include <utility>
+#include <vector>
+
+// Календарь недель цикла (таблица cycleweeks) в памяти.
+//
+// Даты хранятся как CivilDate, поэтому поиск недели по дате, номера недели цикла
+// по weekId и даты дня недели не требуют ни mktime/localtime, ни аллокаций.
+// Database загружает календарь один раз и перечитывает после изменений.
+class CycleCalendar {
+public:
+    struct Week {
+        int id = 0;
+        int weekOfCycle = 0;
+        CivilDate start;
+        CivilDate end;
+    };
+
+    void clear();
+
+    // Недели в любом порядке; записи с id <= 0 или без дат игнорируются
+    void assign(std::vector<Week> weeks);
+
+    bool empty() const { return byId.empty(); }
+
+    // Недели в порядке id (как ORDER BY id)
+    const std::vector<Week>& weeks() const { return byId; }
+
+    // O(log n): неделя, содержащая дату (при пересечении — с наименьшей start); nullptr если нет
+    const Week* findByDate(CivilDate date) const;
+
+    // O(log n): nullptr если нет
+    const Week* findById(int weekId) const;
+
+    // O(log n): первая (по id) неделя с данным номером недели цикла; nullptr если нет
+    const Week* firstOfCycleWeek(int weekOfCycle) const;
+
+private:
+    // Таблицы — по числу недель, а не по наибольшему id/weekOfCycle:
+    // значения берутся из файла БД и могут быть сколь угодно большими.
+    std::vector<Week> byId;             // отсортировано по id
+    std::vector<int> byStart;           // позиции в byId, отсортированные по start
+    std::vector<CivilDate> prefixMaxEnd; // max end по byStart[0..i]
+    std::vector<std::pair<int, int>> firstByCycle; // (weekOfCycle, позиция в byId), по weekOfCycle
+};
@@ -0,0 +1,89 @@
+#include "core/lesson_slot_index.h"
+
+#include "database.h"
+
+#include <algorithm>
+
+std::uint64_t LessonSlotIndex::key(int weekOfCycle, int weekday, int subjectId)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(subjectId)) << 16) |
+           (static_cast<std::uint64_t>(weekOfCycle & 0xFF) << 8) |
+           static_cast<std::uint64_t>(weekday & 0xFF);
+}
+
+void LessonSlotIndex::setWeeks(std::vector<CycleCalendar::Week> weeks)
+{
+    calendar.assign(std::move(weeks));
+}
+
+void LessonSlotIndex::addSlot(int weekOfCycle, int weekday, int subjectId, Slot slot)
+{
+    slots[key(weekOfCycle, weekday, subjectId)].push_back(std::move(slot));
+    ++count;
+}
+
+void LessonSlotIndex::finish()
+{
+    auto isLecture = [](const Slot& s) { return s.lessonType.find("ЛК") != std::string::npos; };
+    for (auto& it : slots) {
+        std::stable_sort(it.second.begin(), it.second.end(), [&](const Slot& a, const Slot& b) {
+            const bool la = isLecture(a);
+            const bool lb = isLecture(b);
+            if (la != lb) return !la;
+            return a.lessonNumber < b.lessonNumber;
+        });
+    }
+}
+
+const LessonSlotIndex::Slot* LessonSlotIndex::find(CivilDate date, int subjectId, int subgroup) const
+{
+    if (date.isNull()) return nullptr;
+    const int weekday = date.isoWeekday();
+    if (weekday < 1 || weekday > 6) return nullptr;
+
+    const CycleCalendar::Week* week = calendar.findByDate(date);
+    if (!week) return nullptr;
+
+    auto it = slots.find(key(week->weekOfCycle, weekday, subjectId));
+    if (it == slots.end()) return nullptr;
+
+    for (const Slot& s : it->second) {
+        if (s.subgroup == 0 || subgroup == 0 || s.subgroup == subgroup) return &s;
+    }
+    return nullptr;
+}
+
+LessonSlotIndexCache& LessonSlotIndexCache::instance()
+{
+    static LessonSlotIndexCache inst;
+    return inst;
+}
+
+std::shared_ptr<const LessonSlotIndex> LessonSlotIndexCache::get(Database& db, int groupId, int semesterId)
+{
+    auto cacheKey = std::make_tuple(db.filePath(), groupId, semesterId);
+    std::uint64_t startedAt = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = indexes.find(cacheKey);
+        if (it != indexes.end()) return it->second;
+        startedAt = generation;
+    }
+
+    // Строим без блокировки: соединения пула читают параллельно. Если две задачи
+    // построили один индекс одновременно, в кэше остаётся первый.
+    auto index = std::make_shared<LessonSlotIndex>(groupId, semesterId);
+    if (!db.buildLessonSlotIndex(groupId, semesterId, *index)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generation != startedAt) return index;  // расписание поменялось, пока строили
+    auto inserted = indexes.emplace(std::move(cacheKey), std::move(index));
+    return inserted.first->second;
+}
+
+void LessonSlotIndexCache::invalidate()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    indexes.clear();
+    ++generation;
+}
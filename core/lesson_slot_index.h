@@ -0,0 +1,78 @@
+#pragma once
+
+#include "core/civil_date.h"
+#include "core/cycle_calendar.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+class Database;
+
+// Занятия одной группы за семестр: (дата, предмет, подгруппа) -> пара, тип, аудитория.
+//
+// Строится один раз (Database::buildLessonSlotIndex: расписание группы вместе с общими
+// лекциями одним запросом + недели цикла, пересекающие семестр), дальше поиск идёт
+// в памяти. Так история оценок/пропусков не запрашивает расписание на каждую строку.
+class LessonSlotIndex {
+public:
+    struct Slot {
+        int lessonNumber = 0;
+        int subgroup = 0;  // 0 — вся группа
+        std::string lessonType;
+        std::string room;
+    };
+
+    LessonSlotIndex() = default;
+    LessonSlotIndex(int groupId, int semesterId) : group(groupId), semester(semesterId) {}
+
+    int groupId() const { return group; }
+    int semesterId() const { return semester; }
+
+    // Заполнение (Database::buildLessonSlotIndex); weekday 1..6, как в UI
+    void setWeeks(std::vector<CycleCalendar::Week> weeks);
+    void addSlot(int weekOfCycle, int weekday, int subjectId, Slot slot);
+    // Упорядочить занятия дня: практика/лабораторная раньше лекции, затем по номеру пары
+    void finish();
+
+    // Занятие предмета в этот день для подгруппы (0 — любая); nullptr, если его нет
+    const Slot* find(CivilDate date, int subjectId, int subgroup) const;
+
+    size_t slotCount() const { return count; }
+
+private:
+    static std::uint64_t key(int weekOfCycle, int weekday, int subjectId);
+
+    int group = 0;
+    int semester = 0;
+    size_t count = 0;
+    CycleCalendar calendar;
+    std::unordered_map<std::uint64_t, std::vector<Slot>> slots;
+};
+
+// Общий для всех соединений (и потоков DbExecutor) кэш индексов по (файл БД, группа, семестр).
+// Сбрасывается целиком при изменении расписания или недель цикла:
+// AppEvents::scheduleChanged, запись расписания через Database, ScheduleImporter, SchoolGenerator.
+// invalidateCalendar() его не трогает: она вызывается на каждый execute() и выдачу из пула.
+class LessonSlotIndexCache {
+public:
+    static LessonSlotIndexCache& instance();
+
+    // Готовый индекс или построенный через db; nullptr — ошибка чтения
+    std::shared_ptr<const LessonSlotIndex> get(Database& db, int groupId, int semesterId);
+
+    void invalidate();
+
+private:
+    LessonSlotIndexCache() = default;
+
+    std::mutex mutex;
+    std::map<std::tuple<std::string, int, int>, std::shared_ptr<const LessonSlotIndex>> indexes;
+    // Индекс, построенный до invalidate(), в кэш не кладётся
+    std::uint64_t generation = 0;
+};
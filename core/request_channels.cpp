@@ -0,0 +1,62 @@
+#include "core/request_channels.h"
+
+RequestChannels::Channel& RequestChannels::channelLocked(const std::string& channel)
+{
+    // Вызывается под mutex
+    Channel& entry = channels[channel];
+    if (!entry.generation) entry.generation = std::make_shared<std::atomic<std::uint64_t>>(0);
+    return entry;
+}
+
+RequestChannels::Ticket RequestChannels::issue(const std::string& channel)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Channel& entry = channelLocked(channel);
+
+    Ticket ticket;
+    ticket.generation = entry.generation;
+    ticket.value = entry.generation->fetch_add(1) + 1;
+    return ticket;
+}
+
+void RequestChannels::cancel(const std::string& channel)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = channels.find(channel);
+    if (it != channels.end()) it->second.generation->fetch_add(1);
+}
+
+void RequestChannels::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : channels) entry.second.generation->fetch_add(1);
+}
+
+bool RequestChannels::bind(const std::string& channel, const void* owner)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    channelLocked(channel).owner = owner;
+    return owner && owners.insert(owner).second;
+}
+
+void RequestChannels::release(const void* owner)
+{
+    if (!owner) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    owners.erase(owner);
+    for (auto it = channels.begin(); it != channels.end();) {
+        if (it->second.owner == owner) {
+            it->second.generation->fetch_add(1);
+            it = channels.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::size_t RequestChannels::channelCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return channels.size();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Поколения "каналов" фоновых запросов (DbExecutor): каждая задача получает билет,
+// новая задача в том же канале делает билеты предыдущих устаревшими.
+//
+// Канал можно привязать к владельцу (окну/странице); release(owner) при уничтожении
+// владельца удаляет его каналы, чтобы таблица не росла с каждым открытым окном.
+// Выданные билеты держат своё поколение сами и после удаления канала просто устаревают.
+class RequestChannels {
+public:
+    class Ticket {
+    public:
+        Ticket() = default;
+        bool isCurrent() const { return generation && generation->load() == value; }
+
+    private:
+        friend class RequestChannels;
+        std::shared_ptr<std::atomic<std::uint64_t>> generation;
+        std::uint64_t value = 0;
+    };
+
+    // Новый билет канала; все прежние билеты канала устаревают
+    Ticket issue(const std::string& channel);
+    // Сделать устаревшими все билеты канала / всех каналов
+    void cancel(const std::string& channel);
+    void cancelAll();
+
+    // Привязать канал к владельцу (создаёт канал, если его нет).
+    // true — владелец привязан впервые: вызывающий должен позже вызвать release(owner).
+    bool bind(const std::string& channel, const void* owner);
+    // Удалить каналы владельца; их билеты устаревают
+    void release(const void* owner);
+
+    std::size_t channelCount() const;
+
+private:
+    struct Channel {
+        std::shared_ptr<std::atomic<std::uint64_t>> generation;
+        const void* owner = nullptr;
+    };
+
+    Channel& channelLocked(const std::string& channel);
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Channel> channels;
+    std::unordered_set<const void*> owners;
+};
@@ -1,4 +1,5 @@
 #include "database.h"
+#include "core/lesson_slot_index.h"
 #include <sqlite3.h>
 #include <iostream>
 #include <vector>
@@ -8,9 +9,10 @@
 #include <iomanip>
 #include <algorithm>
 #include <unordered_map>
-#include <ctime>
+#include <unordered_set>
 #include <cstring>
 #include <cctype>
+#include <cstdlib>
 
 namespace {
 
@@ -41,20 +43,222 @@ int getGroupIdByName(sqlite3* db, const std::string& name) {
         name);
 }
 
-// Parse ISO date (YYYY-MM-DD) to std::tm
-bool parseDateISO(const std::string& s, std::tm& out) {
-    if (s.size() != 10) return false;
-    memset(&out, 0, sizeof(out));
-    out.tm_year = std::stoi(s.substr(0, 4)) - 1900;
-    out.tm_mon = std::stoi(s.substr(5, 2)) - 1;   // 0–11
-    out.tm_mday = std::stoi(s.substr(8, 2));      // 1–31
-    out.tm_hour = 0;
-    out.tm_min = 0;
-    out.tm_sec = 0;
-    std::mktime(&out);
-    return true;
+// Нижний регистр для ASCII и кириллицы (включая Ё) в UTF-8; остальное без изменений.
+// Тот же результат, что QString::toLower для ФИО/логинов, которые встречаются в users.
+std::string foldCaseUtf8(const unsigned char* s, size_t n)
+{
+    std::string out;
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const unsigned char c = s[i];
+        if (c < 0x80) {
+            out.push_back(static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c));
+            continue;
+        }
+        if ((c == 0xD0 || c == 0xD1) && i + 1 < n) {
+            const unsigned int cp = ((c & 0x1Fu) << 6) | (s[i + 1] & 0x3Fu);
+            unsigned int lower = cp;
+            if (cp >= 0x410 && cp <= 0x42F) lower = cp + 0x20;        // А..Я
+            else if (cp >= 0x400 && cp <= 0x40F) lower = cp + 0x50;   // Ѐ..Џ, Ё
+            out.push_back(static_cast<char>(0xC0 | (lower >> 6)));
+            out.push_back(static_cast<char>(0x80 | (lower & 0x3F)));
+            ++i;
+            continue;
+        }
+        out.push_back(static_cast<char>(c));
+    }
+    return out;
+}
+
+// SQL-функция foldcase(text) для поиска без FTS5 и для запросов короче триграммы
+void sqlFoldCase(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    const unsigned char* text = sqlite3_value_text(argv[0]);
+    if (!text) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    const std::string folded = foldCaseUtf8(text, static_cast<size_t>(sqlite3_value_bytes(argv[0])));
+    sqlite3_result_text(ctx, folded.c_str(), static_cast<int>(folded.size()), SQLITE_TRANSIENT);
+}
+
+// Месяц как полуоткрытый диапазон ['YYYY-MM', 'YYYY-MM' следующего месяца).
+// Строковое сравнение верно и для date ('YYYY-MM-DD'), и для studentstats.month,
+// а условие на сам столбец (без strftime) позволяет SQLite идти по индексу.
+// Вызывающие проверяют 1 <= year <= 9999; буферы вмещают любой int.
+std::pair<std::string, std::string> monthKeyRange(int year, int month)
+{
+    char from[32];
+    char to[32];
+    std::snprintf(from, sizeof(from), "%04d-%02d", year, month);
+    if (month == 12) std::snprintf(to, sizeof(to), "%04d-01", year + 1);
+    else std::snprintf(to, sizeof(to), "%04d-%02d", year, month + 1);
+    return {from, to};
+}
+
+// Число символов UTF-8 (байты продолжения 10xxxxxx не считаются)
+size_t utf8Length(const std::string& s)
+{
+    size_t n = 0;
+    for (unsigned char c : s) {
+        if ((c & 0xC0) != 0x80) ++n;
+    }
+    return n;
 }
 
+// Версионированные миграции схемы поверх CREATE TABLE IF NOT EXISTS.
+// Номер применённой миграции хранится в PRAGMA user_version. Файл на последней
+// версии initialize() не трогает, поэтому любое изменение схемы (в том числе новая
+// таблица) добавляется сюда новой миграцией, а не только в базовый DDL.
+struct SchemaMigration {
+    int version;
+    const char* name;
+    const char* sql;
+    // Необязательный запрос (описание, число строк), выполняется в той же транзакции
+    // до sql; ненулевые счётчики пишутся в лог — что миграция удалит или перенесёт
+    const char* reportSql = nullptr;
+};
+
+const SchemaMigration kSchemaMigrations[] = {
+    {1, "grades/absences index pack",
+        // Естественный ключ (студент, предмет, семестр, дата) должен быть уникальным,
+        // иначе уникальный индекс не создастся: оставляем первую запись, как её
+        // и находил findGradeId/findAbsenceId. История изменений удаляемых дублей
+        // переносится на оставшуюся оценку, иначе DELETE упрётся в FOREIGN KEY gradechanges.
+        "UPDATE gradechanges SET gradeid = ("
+        "  SELECT MIN(k.id) FROM grades d JOIN grades k"
+        "    ON k.studentid IS d.studentid AND k.subjectid IS d.subjectid"
+        "   AND k.semesterid IS d.semesterid AND k.date IS d.date"
+        "  WHERE d.id = gradechanges.gradeid) "
+        "WHERE gradeid IN (SELECT id FROM grades WHERE id NOT IN ("
+        "  SELECT MIN(id) FROM grades GROUP BY studentid, subjectid, semesterid, date));"
+        "DELETE FROM grades WHERE id NOT IN ("
+        "  SELECT MIN(id) FROM grades GROUP BY studentid, subjectid, semesterid, date);"
+        "DELETE FROM absences WHERE id NOT IN ("
+        "  SELECT MIN(id) FROM absences GROUP BY studentid, subjectid, semesterid, date);"
+
+        "CREATE UNIQUE INDEX IF NOT EXISTS idxgradeskey "
+        "ON grades(studentid, subjectid, semesterid, date);"
+        "CREATE UNIQUE INDEX IF NOT EXISTS idxabsenceskey "
+        "ON absences(studentid, subjectid, semesterid, date);"
+
+        // Сводки по группе/предмету (Statistics::calculateGroupSubjectAverage,
+        // getGroupSubjectAbsencesSummary)
+        "CREATE INDEX IF NOT EXISTS idxgradessubjectsemester "
+        "ON grades(subjectid, semesterid, studentid, value);"
+        "CREATE INDEX IF NOT EXISTS idxabsencessubjectsemester "
+        "ON absences(subjectid, semesterid, studentid, hours);",
+
+        "SELECT 'duplicate grades removed', COUNT(*) FROM grades WHERE id NOT IN ("
+        "  SELECT MIN(id) FROM grades GROUP BY studentid, subjectid, semesterid, date) "
+        "UNION ALL "
+        "SELECT 'grade history rows moved to kept grade', COUNT(*) FROM gradechanges WHERE gradeid IN ("
+        "  SELECT id FROM grades WHERE id NOT IN ("
+        "    SELECT MIN(id) FROM grades GROUP BY studentid, subjectid, semesterid, date)) "
+        "UNION ALL "
+        "SELECT 'duplicate absences removed', COUNT(*) FROM absences WHERE id NOT IN ("
+        "  SELECT MIN(id) FROM absences GROUP BY studentid, subjectid, semesterid, date);"},
+
+    {2, "studentstats summary table",
+        // Сводка (студент, предмет, семестр, месяц 'YYYY-MM') для средних и часов пропусков.
+        // Ведётся триггерами, поэтому верна при любом пути записи (журнал, пакет,
+        // D1-рандомайзер, удаление пользователя). Неуважительные — всё, что не 'excused',
+        // как и в интерфейсе.
+        "CREATE TABLE IF NOT EXISTS studentstats ("
+        "  studentid      INTEGER NOT NULL,"
+        "  subjectid      INTEGER NOT NULL,"
+        "  semesterid     INTEGER NOT NULL,"
+        "  month          TEXT    NOT NULL,"
+        "  gradesum       INTEGER NOT NULL DEFAULT 0,"
+        "  gradecount     INTEGER NOT NULL DEFAULT 0,"
+        "  absencehours   INTEGER NOT NULL DEFAULT 0,"
+        "  unexcusedhours INTEGER NOT NULL DEFAULT 0,"
+        "  PRIMARY KEY (studentid, subjectid, semesterid, month)"
+        ") WITHOUT ROWID;"
+        // Сводка по группе/предмету идёт от users.groupid к studentid, поэтому
+        // отдельный индекс (subjectid, semesterid) не нужен
+
+        "DELETE FROM studentstats;"
+        "INSERT INTO studentstats (studentid, subjectid, semesterid, month, gradesum, gradecount,"
+        "                          absencehours, unexcusedhours) "
+        "SELECT studentid, subjectid, semesterid, month,"
+        "       SUM(gs), SUM(gc), SUM(ah), SUM(uh) FROM ("
+        "  SELECT studentid, subjectid, semesterid, COALESCE(substr(date, 1, 7), '') AS month,"
+        "         value AS gs, 1 AS gc, 0 AS ah, 0 AS uh FROM grades"
+        "  UNION ALL"
+        "  SELECT studentid, subjectid, semesterid, COALESCE(substr(date, 1, 7), ''),"
+        "         0, 0, hours, CASE WHEN COALESCE(type, '') <> 'excused' THEN hours ELSE 0 END"
+        "  FROM absences"
+        ") GROUP BY studentid, subjectid, semesterid, month;"
+
+        "CREATE TRIGGER IF NOT EXISTS trgstatsgradeins AFTER INSERT ON grades BEGIN "
+        "  INSERT INTO studentstats (studentid, subjectid, semesterid, month, gradesum, gradecount) "
+        "  VALUES (NEW.studentid, NEW.subjectid, NEW.semesterid,"
+        "          COALESCE(substr(NEW.date, 1, 7), ''), NEW.value, 1) "
+        "  ON CONFLICT (studentid, subjectid, semesterid, month) DO UPDATE SET "
+        "    gradesum = gradesum + excluded.gradesum, gradecount = gradecount + 1;"
+        "END;"
+        "CREATE TRIGGER IF NOT EXISTS trgstatsgradedel AFTER DELETE ON grades BEGIN "
+        "  UPDATE studentstats SET gradesum = gradesum - OLD.value, gradecount = gradecount - 1 "
+        "  WHERE studentid = OLD.studentid AND subjectid = OLD.subjectid"
+        "    AND semesterid = OLD.semesterid AND month = COALESCE(substr(OLD.date, 1, 7), '');"
+        "END;"
+        "CREATE TRIGGER IF NOT EXISTS trgstatsgradeupd "
+        "AFTER UPDATE OF studentid, subjectid, semesterid, date, value ON grades BEGIN "
+        "  UPDATE studentstats SET gradesum = gradesum - OLD.value, gradecount = gradecount - 1 "
+        "  WHERE studentid = OLD.studentid AND subjectid = OLD.subjectid"
+        "    AND semesterid = OLD.semesterid AND month = COALESCE(substr(OLD.date, 1, 7), '');"
+        "  INSERT INTO studentstats (studentid, subjectid, semesterid, month, gradesum, gradecount) "
+        "  VALUES (NEW.studentid, NEW.subjectid, NEW.semesterid,"
+        "          COALESCE(substr(NEW.date, 1, 7), ''), NEW.value, 1) "
+        "  ON CONFLICT (studentid, subjectid, semesterid, month) DO UPDATE SET "
+        "    gradesum = gradesum + excluded.gradesum, gradecount = gradecount + 1;"
+        "END;"
+
+        "CREATE TRIGGER IF NOT EXISTS trgstatsabsenceins AFTER INSERT ON absences BEGIN "
+        "  INSERT INTO studentstats (studentid, subjectid, semesterid, month, absencehours, unexcusedhours) "
+        "  VALUES (NEW.studentid, NEW.subjectid, NEW.semesterid,"
+        "          COALESCE(substr(NEW.date, 1, 7), ''), NEW.hours,"
+        "          CASE WHEN COALESCE(NEW.type, '') <> 'excused' THEN NEW.hours ELSE 0 END) "
+        "  ON CONFLICT (studentid, subjectid, semesterid, month) DO UPDATE SET "
+        "    absencehours = absencehours + excluded.absencehours,"
+        "    unexcusedhours = unexcusedhours + excluded.unexcusedhours;"
+        "END;"
+        "CREATE TRIGGER IF NOT EXISTS trgstatsabsencedel AFTER DELETE ON absences BEGIN "
+        "  UPDATE studentstats SET absencehours = absencehours - OLD.hours,"
+        "    unexcusedhours = unexcusedhours"
+        "      - CASE WHEN COALESCE(OLD.type, '') <> 'excused' THEN OLD.hours ELSE 0 END "
+        "  WHERE studentid = OLD.studentid AND subjectid = OLD.subjectid"
+        "    AND semesterid = OLD.semesterid AND month = COALESCE(substr(OLD.date, 1, 7), '');"
+        "END;"
+        "CREATE TRIGGER IF NOT EXISTS trgstatsabsenceupd "
+        "AFTER UPDATE OF studentid, subjectid, semesterid, date, hours, type ON absences BEGIN "
+        "  UPDATE studentstats SET absencehours = absencehours - OLD.hours,"
+        "    unexcusedhours = unexcusedhours"
+        "      - CASE WHEN COALESCE(OLD.type, '') <> 'excused' THEN OLD.hours ELSE 0 END "
+        "  WHERE studentid = OLD.studentid AND subjectid = OLD.subjectid"
+        "    AND semesterid = OLD.semesterid AND month = COALESCE(substr(OLD.date, 1, 7), '');"
+        "  INSERT INTO studentstats (studentid, subjectid, semesterid, month, absencehours, unexcusedhours) "
+        "  VALUES (NEW.studentid, NEW.subjectid, NEW.semesterid,"
+        "          COALESCE(substr(NEW.date, 1, 7), ''), NEW.hours,"
+        "          CASE WHEN COALESCE(NEW.type, '') <> 'excused' THEN NEW.hours ELSE 0 END) "
+        "  ON CONFLICT (studentid, subjectid, semesterid, month) DO UPDATE SET "
+        "    absencehours = absencehours + excluded.absencehours,"
+        "    unexcusedhours = unexcusedhours + excluded.unexcusedhours;"
+        "END;"},
+
+    {3, "student/semester/date indexes",
+        // Оценки и пропуски студента за семестр и диапазоны дат внутри него
+        // (помесячные фильтры без strftime, getStudent*ForSemester, getStudentMonthSeries)
+        "CREATE INDEX IF NOT EXISTS idxgradesstudentdate "
+        "ON grades(studentid, semesterid, date);"
+        "CREATE INDEX IF NOT EXISTS idxabsencesstudentdate "
+        "ON absences(studentid, semesterid, date);"},
+};
+
+const int kLatestSchemaVersion =
+    kSchemaMigrations[sizeof(kSchemaMigrations) / sizeof(kSchemaMigrations[0]) - 1].version;
+
 } // namespace
 
 bool Database::resolveWeekdayZeroBased()
@@ -123,8 +327,8 @@ bool Database::getTeacherForScheduleId(int scheduleId, int& outTeacherId, std::s
         "LEFT JOIN users u ON u.id = s.teacherid "
         "WHERE s.id = ? LIMIT 1;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
     sqlite3_bind_int(stmt, 1, scheduleId);
@@ -135,7 +339,7 @@ bool Database::getTeacherForScheduleId(int scheduleId, int& outTeacherId, std::s
         const unsigned char* nameText = sqlite3_column_text(stmt, 1);
         outTeacherName = nameText ? reinterpret_cast<const char*>(nameText) : "";
     }
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return (rc == SQLITE_ROW || rc == SQLITE_DONE);
 }
 
@@ -429,10 +633,58 @@ bool Database::getGroupsFromScheduleForTeacher(int teacherId,
     return rc == SQLITE_DONE;
 }
 
+// ===== Connection Profile =====
+
+ConnectionProfile ConnectionProfile::balanced()
+{
+    return ConnectionProfile{};
+}
+
+ConnectionProfile ConnectionProfile::safe()
+{
+    ConnectionProfile p;
+    p.name = "safe";
+    p.journalMode = "DELETE";
+    p.synchronous = "FULL";
+    p.cacheSizeKiB = 2000;  // значение SQLite по умолчанию
+    p.mmapSizeBytes = 0;
+    p.tempStore = "DEFAULT";
+    return p;
+}
+
+ConnectionProfile ConnectionProfile::bulk()
+{
+    ConnectionProfile p;
+    p.name = "bulk";
+    p.synchronous = "OFF";
+    p.cacheSizeKiB = 64 * 1024;
+    p.mmapSizeBytes = 1024LL * 1024 * 1024;
+    return p;
+}
+
+bool ConnectionProfile::byName(const std::string& profileName, ConnectionProfile& out)
+{
+    if (profileName == "balanced") { out = balanced(); return true; }
+    if (profileName == "safe") { out = safe(); return true; }
+    if (profileName == "bulk") { out = bulk(); return true; }
+    return false;
+}
+
+ConnectionProfile ConnectionProfile::fromEnvironment()
+{
+    ConnectionProfile p = balanced();
+    const char* env = std::getenv("SCHOOLDB_PROFILE");
+    if (env && *env && !byName(env, p)) {
+        std::cerr << "[✗] SCHOOLDB_PROFILE: неизвестный профиль '" << env
+                  << "', используется " << p.name << "\n";
+    }
+    return p;
+}
+
 // ===== Constructor & Destructor =====
 
 Database::Database(const std::string& file)
-    : db(nullptr), fileName(file) {}
+    : db(nullptr), fileName(file), profile(ConnectionProfile::fromEnvironment()) {}
 
 Database::~Database() {
     disconnect();
@@ -445,17 +697,72 @@ bool Database::connect() {
         return true;  // Already connected
     }
 
-    int rc = sqlite3_open(fileName.c_str(), &db);
+    int flags = profile.readOnly ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    if (profile.singleThread) flags |= SQLITE_OPEN_NOMUTEX;
+
+    int rc = sqlite3_open_v2(fileName.c_str(), &db, flags, nullptr);
     if (rc != SQLITE_OK) {
         std::cerr << "[✗] Error opening SQLite DB: "
                   << (sqlite3_errmsg(db) ? sqlite3_errmsg(db) : "unknown")
                   << std::endl;
+        sqlite3_close(db);
         db = nullptr;
         return false;
     }
 
     sqlite3_exec(db, "PRAGMA foreign_keys = ON;", nullptr, nullptr, nullptr);
+    sqlite3_create_function_v2(db, "foldcase", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr,
+                               sqlFoldCase, nullptr, nullptr, nullptr);
     std::cout << "[✓] SQLite DB opened: " << fileName << std::endl;
+    applyConnectionProfile();
+    // Соединения без initialize() (читатели ConnectionPool) тоже должны знать,
+    // какие миграции уже есть в файле
+    appliedSchemaVersion = std::max(0, schemaVersion());
+    return true;
+}
+
+bool Database::applyConnectionProfile()
+{
+    if (!db) return false;
+
+    sqlite3_busy_timeout(db, profile.busyTimeoutMs);
+
+    // journal_mode возвращает фактический режим (для :memory: WAL недоступен).
+    // Читающее соединение режим не меняет: его задаёт пишущее.
+    std::string journal = "?";
+    {
+        const std::string sql = profile.readOnly ? std::string("PRAGMA journal_mode;")
+                                                 : "PRAGMA journal_mode = " + profile.journalMode + ";";
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK
+            && sqlite3_step(stmt) == SQLITE_ROW) {
+            const unsigned char* mode = sqlite3_column_text(stmt, 0);
+            journal = mode ? reinterpret_cast<const char*>(mode) : "?";
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    const std::string sql =
+        "PRAGMA synchronous = " + profile.synchronous + ";"
+        "PRAGMA cache_size = -" + std::to_string(profile.cacheSizeKiB) + ";"
+        "PRAGMA mmap_size = " + std::to_string(profile.mmapSizeBytes) + ";"
+        "PRAGMA temp_store = " + profile.tempStore + ";";
+
+    char* errMsg = nullptr;
+    const int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::cerr << "[✗] applyConnectionProfile: " << (errMsg ? errMsg : "unknown") << "\n";
+        if (errMsg) sqlite3_free(errMsg);
+        return false;
+    }
+
+    std::cout << "[✓] SQLite profile '" << profile.name << "'" << (profile.readOnly ? " (read-only)" : "") << ":"
+              << " journal_mode=" << journal
+              << " synchronous=" << profile.synchronous
+              << " cache=" << profile.cacheSizeKiB << "KiB"
+              << " mmap=" << (profile.mmapSizeBytes / (1024 * 1024)) << "MiB"
+              << " temp_store=" << profile.tempStore
+              << " busy_timeout=" << profile.busyTimeoutMs << "ms" << std::endl;
     return true;
 }
 
@@ -465,12 +772,56 @@ bool Database::isConnected() const {
 
 void Database::disconnect() {
     if (db != nullptr) {
+        clearStatementCache();
+        invalidateCalendar();
         sqlite3_close(db);
         db = nullptr;
         std::cout << "[✓] SQLite connection closed." << std::endl;
     }
 }
 
+// ===== Prepared Statement Cache =====
+
+sqlite3_stmt* Database::prepareCached(const char* sql)
+{
+    if (!db || !sql) return nullptr;
+
+    const std::string_view key(sql);
+    const auto it = stmtCache.find(key);
+    if (it != stmtCache.end()) {
+        ++stmtCacheHits;
+        // На случай, если вызывающий код вышел без releaseCached().
+        sqlite3_reset(it->second);
+        sqlite3_clear_bindings(it->second);
+        return it->second;
+    }
+
+    ++stmtCacheMisses;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "[✗] prepareCached: " << sqlite3_errmsg(db) << "\n";
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+    stmtCache.emplace(key, stmt);
+    return stmt;
+}
+
+void Database::releaseCached(sqlite3_stmt* stmt)
+{
+    if (!stmt) return;
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+void Database::clearStatementCache()
+{
+    for (auto& entry : stmtCache) {
+        sqlite3_finalize(entry.second);
+    }
+    stmtCache.clear();
+}
+
 // ===== Execute SQL =====
 
 bool Database::execute(const std::string& sql) {
@@ -489,6 +840,8 @@ bool Database::execute(const std::string& sql) {
         return false;
     }
 
+    // Произвольный SQL мог изменить cycleweeks
+    invalidateCalendar();
     return true;
 }
 
@@ -500,6 +853,14 @@ bool Database::initialize()
         return false;
     }
 
+    // Тёплый старт: файл уже на последней миграции, значит базовые таблицы
+    // (создаются до миграций) тоже есть — DDL не выполняем
+    if (appliedSchemaVersion >= kLatestSchemaVersion) {
+        if (!userSearchIndexReady()) ensureUserSearchIndex();
+        std::cout << "[✓] Схема БД актуальна (user_version=" << appliedSchemaVersion << ").\n";
+        return true;
+    }
+
     const char* sql =
         // groups
         "CREATE TABLE IF NOT EXISTS groups ("
@@ -632,10 +993,88 @@ bool Database::initialize()
         return false;
     }
 
+    if (!applyMigrations()) {
+        return false;
+    }
+
+    // Не в kSchemaMigrations: наличие FTS5 зависит от сборки SQLite, а не от версии схемы
+    ensureUserSearchIndex();
+
     std::cout << "[✓] Структура БД инициализирована.\n";
     return true;
 }
 
+int Database::schemaVersion()
+{
+    if (!db) return -1;
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, nullptr) != SQLITE_OK) {
+        return -1;
+    }
+    int version = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return version;
+}
+
+bool Database::applyMigrations()
+{
+    const int current = schemaVersion();
+    if (current < 0) {
+        std::cerr << "[✗] applyMigrations: не удалось прочитать user_version\n";
+        return false;
+    }
+
+    appliedSchemaVersion = current;
+    for (const auto& m : kSchemaMigrations) {
+        if (m.version <= current) continue;
+
+        auto fail = [&](const char* what) {
+            std::cerr << "[✗] Миграция схемы " << m.version << " (" << m.name << "): "
+                      << (what ? what : "unknown") << "\n";
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        };
+
+        if (sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            return fail(sqlite3_errmsg(db));
+        }
+
+        if (m.reportSql) {
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(db, m.reportSql, -1, &stmt, nullptr) != SQLITE_OK) {
+                return fail(sqlite3_errmsg(db));
+            }
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                const long long count = sqlite3_column_int64(stmt, 1);
+                const unsigned char* what = sqlite3_column_text(stmt, 0);
+                if (count > 0) {
+                    std::cout << "[i] Миграция схемы " << m.version << ": "
+                              << (what ? reinterpret_cast<const char*>(what) : "") << ": " << count << "\n";
+                }
+            }
+            sqlite3_finalize(stmt);
+        }
+
+        std::string sql = m.sql;
+        sql += "PRAGMA user_version = " + std::to_string(m.version) + ";";
+        sql += "COMMIT;";
+
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            const std::string err = errMsg ? errMsg : "unknown";
+            if (errMsg) sqlite3_free(errMsg);
+            return fail(err.c_str());
+        }
+        appliedSchemaVersion = m.version;
+        std::cout << "[✓] Миграция схемы " << m.version << ": " << m.name << "\n";
+    }
+    return true;
+}
+
 bool Database::initializeDemoData()
 {
     if (!isConnected()) {
@@ -897,6 +1336,8 @@ bool Database::initializeDemoData()
         " (1, '1 семестр 2025/2026', '2025-09-01', '2025-12-31');"
         ;
 
+    invalidateCalendar();  // cycleweeks пересоздаётся
+
     char* errMsg = nullptr;
     int rc = sqlite3_exec(db, sql, nullptr, nullptr, &errMsg);
     if (rc != SQLITE_OK) {
@@ -905,6 +1346,7 @@ bool Database::initializeDemoData()
         if (errMsg) sqlite3_free(errMsg);
         return false;
     }
+    LessonSlotIndexCache::instance().invalidate();
 
     // дальше — твоя логика teachergroups через prepared statements + verify + COMMIT
     // (она у тебя правильная, её надо вставить целиком без изменений, просто заменить db_ -> db)
@@ -1132,8 +1574,8 @@ bool Database::getSubjectIdByName(const std::string& subjectName, int& outSubjec
     if (subjectName.empty()) return true;
 
     const char* sql = "SELECT id FROM subjects WHERE name = ? LIMIT 1;";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
@@ -1142,7 +1584,7 @@ bool Database::getSubjectIdByName(const std::string& subjectName, int& outSubjec
     if (rc == SQLITE_ROW) {
         outSubjectId = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return (rc == SQLITE_ROW || rc == SQLITE_DONE);
 }
 
@@ -1153,48 +1595,58 @@ bool Database::getStudentAverageGradeForMonth(int studentId, int semesterId,
     outAvg = 0.0;
     outCount = 0;
     if (!db) return false;
-    if (studentId <= 0 || semesterId <= 0 || year <= 0 || month < 1 || month > 12) return false;
-
+    if (studentId <= 0 || semesterId <= 0 || year <= 0 || year > 9999 || month < 1 || month > 12) return false;
+
+    // Сводка studentstats: одна строка на предмет, без сканирования grades
+    const char* statsAll =
+        "SELECT COALESCE(CAST(SUM(gradesum) AS REAL) / SUM(gradecount), 0.0), "
+        "       COALESCE(SUM(gradecount), 0) "
+        "FROM studentstats "
+        "WHERE studentid = ? AND semesterid = ? AND month >= ? AND month < ?;";
+
+    const char* statsSubj =
+        "SELECT COALESCE(CAST(SUM(gradesum) AS REAL) / SUM(gradecount), 0.0), "
+        "       COALESCE(SUM(gradecount), 0) "
+        "FROM studentstats "
+        "WHERE studentid = ? AND subjectid = ? AND semesterid = ? AND month >= ? AND month < ?;";
+
+    // Без сводки: диапазон по date, индекс idxgradesstudentdate (миграция 3)
     const char* sqlAll =
         "SELECT COALESCE(AVG(g.value), 0.0), COALESCE(COUNT(*), 0) "
         "FROM grades g "
         "WHERE g.studentid = ? AND g.semesterid = ? "
-        "AND strftime('%Y', g.date) = ? "
-        "AND strftime('%m', g.date) = ?;";
+        "AND g.date >= ? AND g.date < ?;";
 
     const char* sqlSubj =
         "SELECT COALESCE(AVG(g.value), 0.0), COALESCE(COUNT(*), 0) "
         "FROM grades g "
-        "WHERE g.studentid = ? AND g.semesterid = ? AND g.subjectid = ? "
-        "AND strftime('%Y', g.date) = ? "
-        "AND strftime('%m', g.date) = ?;";
+        "WHERE g.studentid = ? AND g.subjectid = ? AND g.semesterid = ? "
+        "AND g.date >= ? AND g.date < ?;";
 
-    sqlite3_stmt* stmt = nullptr;
-    const char* sql = (subjectId > 0) ? sqlSubj : sqlAll;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    const char* sql = hasStudentStats() ? (subjectId > 0 ? statsSubj : statsAll)
+                                        : (subjectId > 0 ? sqlSubj : sqlAll);
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
+    const auto range = monthKeyRange(year, month);
+
     int idx = 1;
     sqlite3_bind_int(stmt, idx++, studentId);
-    sqlite3_bind_int(stmt, idx++, semesterId);
     if (subjectId > 0) {
         sqlite3_bind_int(stmt, idx++, subjectId);
     }
-
-    const std::string ys = std::to_string(year);
-    char msBuf[3];
-    std::snprintf(msBuf, sizeof(msBuf), "%02d", month);
-
-    sqlite3_bind_text(stmt, idx++, ys.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, idx++, msBuf, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, idx++, semesterId);
+    sqlite3_bind_text(stmt, idx++, range.first.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, idx++, range.second.c_str(), -1, SQLITE_TRANSIENT);
 
     const int rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
         outAvg = sqlite3_column_double(stmt, 0);
         outCount = sqlite3_column_int(stmt, 1);
     }
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return (rc == SQLITE_ROW || rc == SQLITE_DONE);
 }
 
@@ -1205,7 +1657,17 @@ bool Database::getStudentAbsenceHoursForMonth(int studentId, int semesterId,
     outTotalHours = 0;
     outUnexcusedHours = 0;
     if (!db) return false;
-    if (studentId <= 0 || semesterId <= 0 || year <= 0 || month < 1 || month > 12) return false;
+    if (studentId <= 0 || semesterId <= 0 || year <= 0 || year > 9999 || month < 1 || month > 12) return false;
+
+    const char* statsAll =
+        "SELECT COALESCE(SUM(absencehours), 0), COALESCE(SUM(unexcusedhours), 0) "
+        "FROM studentstats "
+        "WHERE studentid = ? AND semesterid = ? AND month >= ? AND month < ?;";
+
+    const char* statsSubj =
+        "SELECT COALESCE(SUM(absencehours), 0), COALESCE(SUM(unexcusedhours), 0) "
+        "FROM studentstats "
+        "WHERE studentid = ? AND subjectid = ? AND semesterid = ? AND month >= ? AND month < ?;";
 
     const char* sqlAll =
         "SELECT "
@@ -1213,44 +1675,274 @@ bool Database::getStudentAbsenceHoursForMonth(int studentId, int semesterId,
         "  COALESCE(SUM(CASE WHEN COALESCE(a.type,'') <> 'excused' THEN a.hours ELSE 0 END), 0) "
         "FROM absences a "
         "WHERE a.studentid = ? AND a.semesterid = ? "
-        "AND strftime('%Y', a.date) = ? "
-        "AND strftime('%m', a.date) = ?;";
+        "AND a.date >= ? AND a.date < ?;";
 
     const char* sqlSubj =
         "SELECT "
         "  COALESCE(SUM(a.hours), 0), "
         "  COALESCE(SUM(CASE WHEN COALESCE(a.type,'') <> 'excused' THEN a.hours ELSE 0 END), 0) "
         "FROM absences a "
-        "WHERE a.studentid = ? AND a.semesterid = ? AND a.subjectid = ? "
-        "AND strftime('%Y', a.date) = ? "
-        "AND strftime('%m', a.date) = ?;";
+        "WHERE a.studentid = ? AND a.subjectid = ? AND a.semesterid = ? "
+        "AND a.date >= ? AND a.date < ?;";
 
-    sqlite3_stmt* stmt = nullptr;
-    const char* sql = (subjectId > 0) ? sqlSubj : sqlAll;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    const char* sql = hasStudentStats() ? (subjectId > 0 ? statsSubj : statsAll)
+                                        : (subjectId > 0 ? sqlSubj : sqlAll);
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
+    const auto range = monthKeyRange(year, month);
+
     int idx = 1;
     sqlite3_bind_int(stmt, idx++, studentId);
-    sqlite3_bind_int(stmt, idx++, semesterId);
     if (subjectId > 0) sqlite3_bind_int(stmt, idx++, subjectId);
-
-    const std::string ys = std::to_string(year);
-    char msBuf[3];
-    std::snprintf(msBuf, sizeof(msBuf), "%02d", month);
-    sqlite3_bind_text(stmt, idx++, ys.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, idx++, msBuf, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, idx++, semesterId);
+    sqlite3_bind_text(stmt, idx++, range.first.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, idx++, range.second.c_str(), -1, SQLITE_TRANSIENT);
 
     const int rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
         outTotalHours = sqlite3_column_int(stmt, 0);
         outUnexcusedHours = sqlite3_column_int(stmt, 1);
     }
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return (rc == SQLITE_ROW || rc == SQLITE_DONE);
 }
 
+bool Database::getStudentMonthSeries(int studentId, int semesterId,
+                                     std::vector<StudentMonthStats>& outSeries)
+{
+    outSeries.clear();
+    if (!db) return false;
+    if (studentId <= 0 || semesterId <= 0) return false;
+
+    const char* statsSql =
+        "SELECT month, subjectid, gradesum, gradecount, absencehours, unexcusedhours "
+        "FROM studentstats "
+        "WHERE studentid = ? AND semesterid = ? "
+        "AND (gradecount > 0 OR absencehours > 0) "
+        "ORDER BY month, subjectid;";
+
+    // Без сводки: группировка по месяцу, выборка идёт по idxgradesstudentdate/idxabsencesstudentdate
+    const char* scanSql =
+        "SELECT substr(date, 1, 7) AS month, subjectid, SUM(gs), SUM(gc), SUM(ah), SUM(uh) FROM ("
+        "  SELECT date, subjectid, value AS gs, 1 AS gc, 0 AS ah, 0 AS uh "
+        "  FROM grades WHERE studentid = ?1 AND semesterid = ?2"
+        "  UNION ALL"
+        "  SELECT date, subjectid, 0, 0, hours,"
+        "         CASE WHEN COALESCE(type, '') <> 'excused' THEN hours ELSE 0 END "
+        "  FROM absences WHERE studentid = ?1 AND semesterid = ?2"
+        ") GROUP BY month, subjectid ORDER BY month, subjectid;";
+
+    sqlite3_stmt* stmt = prepareCached(hasStudentStats() ? statsSql : scanSql);
+    if (!stmt) {
+        std::cerr << "[✗] getStudentMonthSeries: prepare error: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, studentId);
+    sqlite3_bind_int(stmt, 2, semesterId);
+
+    int rc = SQLITE_OK;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const unsigned char* monthText = sqlite3_column_text(stmt, 0);
+        StudentMonthStats m;
+        // 'YYYY-MM'; записи без даты пропускаются
+        if (!monthText || std::sscanf(reinterpret_cast<const char*>(monthText), "%d-%d", &m.year, &m.month) != 2) {
+            continue;
+        }
+        m.subjectId = sqlite3_column_int(stmt, 1);
+        m.gradeSum = sqlite3_column_int(stmt, 2);
+        m.gradeCount = sqlite3_column_int(stmt, 3);
+        m.absenceHours = sqlite3_column_int(stmt, 4);
+        m.unexcusedHours = sqlite3_column_int(stmt, 5);
+        outSeries.push_back(m);
+    }
+
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[✗] getStudentMonthSeries step error: " << sqlite3_errmsg(db) << "\n";
+        releaseCached(stmt);
+        outSeries.clear();
+        return false;
+    }
+
+    releaseCached(stmt);
+    return true;
+}
+
+bool Database::loadStudentLessonRecords(const char* sql, const char* what, int studentId, int semesterId,
+                                        std::vector<StudentLessonRecord>& out)
+{
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
+        std::cerr << "[✗] " << what << ": prepare error: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, studentId);
+    sqlite3_bind_int(stmt, 2, semesterId);
+
+    int rc = SQLITE_OK;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        StudentLessonRecord r;
+        r.subjectId = sqlite3_column_int(stmt, 0);
+        const unsigned char* subjText = sqlite3_column_text(stmt, 1);
+        r.subject = subjText ? reinterpret_cast<const char*>(subjText) : "";
+        r.value = sqlite3_column_int(stmt, 2);
+        const unsigned char* dateText = sqlite3_column_text(stmt, 3);
+        r.date = dateText ? reinterpret_cast<const char*>(dateText) : "";
+        const unsigned char* typeText = sqlite3_column_text(stmt, 4);
+        r.type = typeText ? reinterpret_cast<const char*>(typeText) : "";
+        out.push_back(std::move(r));
+    }
+
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[✗] " << what << ": step error: " << sqlite3_errmsg(db) << "\n";
+        releaseCached(stmt);
+        out.clear();
+        return false;
+    }
+
+    releaseCached(stmt);
+    return true;
+}
+
+bool Database::buildLessonSlotIndex(int groupId, int semesterId, LessonSlotIndex& out)
+{
+    out = LessonSlotIndex(groupId, semesterId);
+    if (!db) {
+        std::cerr << "[✗] buildLessonSlotIndex: DB not connected\n";
+        return false;
+    }
+    if (!ensureCalendar()) return false;
+
+    // Недели цикла, пересекающие семестр (без дат семестра — все недели)
+    CivilDate semStart, semEnd;
+    {
+        const char* sql = "SELECT COALESCE(startdate, ''), COALESCE(enddate, '') FROM semesters WHERE id = ? LIMIT 1;";
+        sqlite3_stmt* stmt = prepareCached(sql);
+        if (!stmt) {
+            std::cerr << "[✗] buildLessonSlotIndex: prepare error: " << sqlite3_errmsg(db) << "\n";
+            return false;
+        }
+        sqlite3_bind_int(stmt, 1, semesterId);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            semStart = CivilDate::parseISO(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+            semEnd = CivilDate::parseISO(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+        }
+        releaseCached(stmt);
+    }
+
+    std::vector<CycleCalendar::Week> weeks;
+    weeks.reserve(calendar.weeks().size());
+    for (const auto& w : calendar.weeks()) {
+        if (!semStart.isNull() && w.end < semStart) continue;
+        if (!semEnd.isNull() && semEnd < w.start) continue;
+        weeks.push_back(w);
+    }
+    out.setWeeks(std::move(weeks));
+
+    const char* sql =
+        "SELECT weekofcycle, weekday, subjectid, subgroup, lessonnumber,"
+        "       TRIM(COALESCE(lessontype, '')), COALESCE(room, '') "
+        "FROM schedule "
+        "WHERE groupid = ? OR groupid = 0;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
+        std::cerr << "[✗] buildLessonSlotIndex: prepare error: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, groupId);
+
+    int rc = SQLITE_OK;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const unsigned char* typeText = sqlite3_column_text(stmt, 5);
+        const unsigned char* roomText = sqlite3_column_text(stmt, 6);
+
+        LessonSlotIndex::Slot s;
+        s.subgroup = sqlite3_column_int(stmt, 3);
+        s.lessonNumber = sqlite3_column_int(stmt, 4);
+        s.lessonType = typeText ? reinterpret_cast<const char*>(typeText) : "";
+        s.room = roomText ? reinterpret_cast<const char*>(roomText) : "";
+
+        out.addSlot(sqlite3_column_int(stmt, 0), normalizeWeekdayFromDb(sqlite3_column_int(stmt, 1)),
+                    sqlite3_column_int(stmt, 2), std::move(s));
+    }
+    releaseCached(stmt);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[✗] buildLessonSlotIndex: step error: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    out.finish();
+    return true;
+}
+
+bool Database::attachLessonSlots(int studentId, int semesterId, std::vector<StudentLessonRecord>& rows)
+{
+    if (rows.empty()) return true;
+
+    int groupId = 0;
+    int subgroup = 0;
+    if (!getStudentGroupAndSubgroup(studentId, groupId, subgroup)) return false;
+    if (groupId <= 0) return true;
+
+    const auto index = LessonSlotIndexCache::instance().get(*this, groupId, semesterId);
+    if (!index) return false;
+
+    for (auto& r : rows) {
+        const LessonSlotIndex::Slot* slot = index->find(CivilDate::parseISO(r.date), r.subjectId, subgroup);
+        if (!slot) continue;
+        r.lessonNumber = slot->lessonNumber;
+        r.lessonType = slot->lessonType;
+        r.room = slot->room;
+    }
+    return true;
+}
+
+bool Database::getStudentGradesWithLessons(int studentId, int semesterId,
+                                           std::vector<StudentLessonRecord>& outGrades)
+{
+    outGrades.clear();
+    if (!db) {
+        std::cerr << "[✗] getStudentGradesWithLessons: DB not connected\n";
+        return false;
+    }
+
+    const char* sql =
+        "SELECT g.subjectid, s.name, g.value, COALESCE(g.date, ''), COALESCE(g.gradetype, '') "
+        "FROM grades g "
+        "JOIN subjects s ON g.subjectid = s.id "
+        "WHERE g.studentid = ? AND g.semesterid = ? "
+        "ORDER BY g.date, s.name;";
+    if (!loadStudentLessonRecords(sql, "getStudentGradesWithLessons", studentId, semesterId, outGrades)) {
+        return false;
+    }
+    return attachLessonSlots(studentId, semesterId, outGrades);
+}
+
+bool Database::getStudentAbsencesWithLessons(int studentId, int semesterId,
+                                             std::vector<StudentLessonRecord>& outAbsences)
+{
+    outAbsences.clear();
+    if (!db) {
+        std::cerr << "[✗] getStudentAbsencesWithLessons: DB not connected\n";
+        return false;
+    }
+
+    const char* sql =
+        "SELECT a.subjectid, s.name, a.hours, COALESCE(a.date, ''), COALESCE(a.type, '') "
+        "FROM absences a "
+        "JOIN subjects s ON a.subjectid = s.id "
+        "WHERE a.studentid = ? AND a.semesterid = ? "
+        "ORDER BY a.date, s.name;";
+    if (!loadStudentLessonRecords(sql, "getStudentAbsencesWithLessons", studentId, semesterId, outAbsences)) {
+        return false;
+    }
+    return attachLessonSlots(studentId, semesterId, outAbsences);
+}
+
 bool Database::updateUser(int userId,
                           const std::string& username,
                           const std::string& name,
@@ -1362,8 +2054,8 @@ bool Database::getScheduleForTeacherWeekWithRoom(
         ORDER BY sch.weekday, sch.lessonnumber, sch.groupid, sch.subgroup
     )SQL";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) return false;
 
     sqlite3_bind_int(stmt, 1, teacherId);
     sqlite3_bind_int(stmt, 2, weekOfCycle);
@@ -1395,7 +2087,7 @@ bool Database::getScheduleForTeacherWeekWithRoom(
         );
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -1427,8 +2119,8 @@ bool Database::getScheduleForTeacherGroupWeekWithRoom(
         ORDER BY sch.weekday, sch.lessonnumber, sch.subgroup
     )SQL";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) return false;
 
     sqlite3_bind_int(stmt, 1, teacherId);
     sqlite3_bind_int(stmt, 2, groupId);
@@ -1458,7 +2150,7 @@ bool Database::getScheduleForTeacherGroupWeekWithRoom(
         );
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -1508,7 +2200,224 @@ bool Database::getAllUsers(
     return true;
 }
 
-bool Database::getAllGroups(std::vector<std::pair<int, std::string>>& outGroups) {
+bool Database::userSearchIndexReady()
+{
+    userSearchFts = false;
+    if (!db || !sqlite3_compileoption_used("ENABLE_FTS5")) return false;
+
+    // Триггеры снимает только сборка без FTS5; пока они на месте, индекс
+    // совпадает с users и пересчитывать его не нужно
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql =
+        "SELECT COUNT(*) FROM sqlite_master WHERE name IN "
+        "('userssearch', 'trguserssearchinsert', 'trguserssearchdelete', 'trguserssearchupdate');";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    const int found = (sqlite3_step(stmt) == SQLITE_ROW) ? sqlite3_column_int(stmt, 0) : 0;
+    sqlite3_finalize(stmt);
+
+    userSearchFts = (found == 4);
+    return userSearchFts;
+}
+
+bool Database::ensureUserSearchIndex()
+{
+    userSearchFts = false;
+    if (!db) return false;
+
+    if (!sqlite3_compileoption_used("ENABLE_FTS5")) {
+        // Триггеры от сборки с FTS5 сломали бы INSERT/UPDATE users ("no such module: fts5")
+        sqlite3_exec(db,
+                     "DROP TRIGGER IF EXISTS trguserssearchinsert;"
+                     "DROP TRIGGER IF EXISTS trguserssearchdelete;"
+                     "DROP TRIGGER IF EXISTS trguserssearchupdate;",
+                     nullptr, nullptr, nullptr);
+        std::cout << "[i] SQLite без FTS5: поиск пользователей без индекса\n";
+        return false;
+    }
+
+    const char* sql =
+        "CREATE VIRTUAL TABLE IF NOT EXISTS userssearch USING fts5(searchkey, tokenize = 'trigram');"
+        "CREATE TRIGGER IF NOT EXISTS trguserssearchinsert AFTER INSERT ON users BEGIN"
+        "  INSERT INTO userssearch(rowid, searchkey) VALUES (new.id, new.name || ' ' || new.username);"
+        "END;"
+        "CREATE TRIGGER IF NOT EXISTS trguserssearchdelete AFTER DELETE ON users BEGIN"
+        "  DELETE FROM userssearch WHERE rowid = old.id;"
+        "END;"
+        "CREATE TRIGGER IF NOT EXISTS trguserssearchupdate AFTER UPDATE OF id, name, username ON users BEGIN"
+        "  DELETE FROM userssearch WHERE rowid = old.id;"
+        "  INSERT INTO userssearch(rowid, searchkey) VALUES (new.id, new.name || ' ' || new.username);"
+        "END;";
+
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "[✗] ensureUserSearchIndex: " << (errMsg ? errMsg : "unknown") << "\n";
+        if (errMsg) sqlite3_free(errMsg);
+        return false;
+    }
+
+    // Индекс только что создан или users менялась без триггеров — перестраиваем целиком
+    int usersCount = -1;
+    int indexedCount = -1;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT (SELECT COUNT(*) FROM users), (SELECT COUNT(*) FROM userssearch);",
+                           -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            usersCount = sqlite3_column_int(stmt, 0);
+            indexedCount = sqlite3_column_int(stmt, 1);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (usersCount < 0) {
+        std::cerr << "[✗] ensureUserSearchIndex: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    if (usersCount != indexedCount) {
+        const char* rebuild =
+            "BEGIN TRANSACTION;"
+            "DELETE FROM userssearch;"
+            "INSERT INTO userssearch(rowid, searchkey) SELECT id, name || ' ' || username FROM users;"
+            "COMMIT;";
+        if (sqlite3_exec(db, rebuild, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            std::cerr << "[✗] ensureUserSearchIndex rebuild: " << (errMsg ? errMsg : "unknown") << "\n";
+            if (errMsg) sqlite3_free(errMsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+        std::cout << "[✓] Индекс поиска пользователей перестроен: " << usersCount << " строк\n";
+    }
+
+    userSearchFts = true;
+    return true;
+}
+
+bool Database::searchUsers(const std::string& query,
+                           const std::string& role,
+                           int offset,
+                           int limit,
+                           std::vector<std::tuple<int, std::string, std::string, std::string, int, int>>& outUsers,
+                           int& outTotal,
+                           UserSortKey sortKey,
+                           bool ascending)
+{
+    outUsers.clear();
+    outTotal = 0;
+    if (!db) {
+        std::cerr << "[✗] searchUsers: DB not connected\n";
+        return false;
+    }
+    if (offset < 0) offset = 0;
+
+    auto trimmed = [](const std::string& v) {
+        const size_t b = v.find_first_not_of(" \t\r\n");
+        if (b == std::string::npos) return std::string();
+        const size_t e = v.find_last_not_of(" \t\r\n");
+        return v.substr(b, e - b + 1);
+    };
+
+    const std::string trimmedQuery = trimmed(query);
+    const std::string needle = foldCaseUtf8(reinterpret_cast<const unsigned char*>(trimmedQuery.data()),
+                                            trimmedQuery.size());
+    const std::string trimmedRole = trimmed(role);
+    const std::string roleKey = foldCaseUtf8(reinterpret_cast<const unsigned char*>(trimmedRole.data()),
+                                             trimmedRole.size());
+
+    // Триграммный индекс находит подстроки от 3 символов; короткие запросы — сканом users
+    const bool useFts = userSearchFts && utf8Length(needle) >= 3;
+
+    std::string where = " WHERE (?1 = '' OR lower(trim(u.role)) = ?1)";
+    if (!needle.empty()) {
+        where += useFts
+            ? " AND u.id IN (SELECT rowid FROM userssearch WHERE userssearch MATCH ?2)"
+            : " AND instr(foldcase(u.name || ' ' || u.username), ?2) > 0";
+    }
+
+    std::string needleParam = needle;
+    if (useFts) {
+        // Одна фраза: кавычки внутри удваиваются, операторы FTS5 не интерпретируются
+        needleParam = "\"";
+        for (char c : needle) {
+            if (c == '"') needleParam += '"';
+            needleParam += c;
+        }
+        needleParam += "\"";
+    }
+
+    auto bindFilter = [&](sqlite3_stmt* stmt) {
+        sqlite3_bind_text(stmt, 1, roleKey.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, needleParam.c_str(), -1, SQLITE_TRANSIENT);
+    };
+
+    // Общее число совпадений
+    {
+        const std::string sql = "SELECT COUNT(*) FROM users u" + where + ";";
+        sqlite3_stmt* stmt = prepareCached(sql.c_str());
+        if (!stmt) return false;
+        bindFilter(stmt);
+        const int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_ROW) {
+            std::cerr << "[✗] searchUsers: count error: " << sqlite3_errmsg(db) << "\n";
+            releaseCached(stmt);
+            return false;
+        }
+        outTotal = sqlite3_column_int(stmt, 0);
+        releaseCached(stmt);
+    }
+
+    if (limit <= 0 || offset >= outTotal) return true;
+
+    const char* orderColumn = "u.id";
+    switch (sortKey) {
+    case UserSortKey::Id: orderColumn = "u.id"; break;
+    case UserSortKey::Username: orderColumn = "u.username"; break;
+    case UserSortKey::Name: orderColumn = "u.name"; break;
+    case UserSortKey::Role: orderColumn = "u.role"; break;
+    case UserSortKey::GroupId: orderColumn = "COALESCE(u.groupid, 0)"; break;
+    case UserSortKey::Subgroup: orderColumn = "COALESCE(u.subgroup, 0)"; break;
+    }
+    const char* dir = ascending ? " ASC" : " DESC";
+
+    std::string sql =
+        "SELECT u.id, u.username, u.name, u.role, COALESCE(u.groupid, 0), COALESCE(u.subgroup, 0) "
+        "FROM users u" + where + " ORDER BY " + orderColumn + dir;
+    if (sortKey != UserSortKey::Id) sql += std::string(", u.id") + dir;
+    sql += " LIMIT ?3 OFFSET ?4;";
+
+    sqlite3_stmt* stmt = prepareCached(sql.c_str());
+    if (!stmt) return false;
+    bindFilter(stmt);
+    sqlite3_bind_int(stmt, 3, limit);
+    sqlite3_bind_int(stmt, 4, offset);
+
+    outUsers.reserve(static_cast<size_t>(std::min(limit, outTotal - offset)));
+
+    int rc = SQLITE_OK;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const unsigned char* uText = sqlite3_column_text(stmt, 1);
+        const unsigned char* nText = sqlite3_column_text(stmt, 2);
+        const unsigned char* rText = sqlite3_column_text(stmt, 3);
+        outUsers.emplace_back(
+            sqlite3_column_int(stmt, 0),
+            uText ? reinterpret_cast<const char*>(uText) : "",
+            nText ? reinterpret_cast<const char*>(nText) : "",
+            rText ? reinterpret_cast<const char*>(rText) : "",
+            sqlite3_column_int(stmt, 4),
+            sqlite3_column_int(stmt, 5));
+    }
+
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[✗] searchUsers: step error: " << sqlite3_errmsg(db) << "\n";
+        releaseCached(stmt);
+        outUsers.clear();
+        return false;
+    }
+
+    releaseCached(stmt);
+    return true;
+}
+
+bool Database::getAllGroups(std::vector<std::pair<int, std::string>>& outGroups) {
     outGroups.clear();
     if (!db) {
         std::cerr << "[✗] getAllGroups: DB not connected\n";
@@ -1659,9 +2568,9 @@ bool Database::getStudentsOfGroup(int groupId,
         "FROM users "
         "WHERE role = 'student' AND groupid = ? "
         "ORDER BY name;";
-    sqlite3_stmt* stmt = nullptr;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    int rc = SQLITE_OK;
+    if (!stmt) {
         std::cerr << "[✗] getStudentsOfGroup: prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -1677,11 +2586,11 @@ bool Database::getStudentsOfGroup(int groupId,
 
     if (rc != SQLITE_DONE) {
         std::cerr << "[✗] getStudentsOfGroup: step error: " << sqlite3_errmsg(db) << "\n";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -1700,9 +2609,9 @@ bool Database::getStudentGroupAndSubgroup(int studentId,
         "FROM users "
         "WHERE id = ? AND role = 'student' "
         "LIMIT 1;";
-    sqlite3_stmt* stmt = nullptr;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    int rc = SQLITE_OK;
+    if (!stmt) {
         std::cerr << "[✗] getStudentGroupAndSubgroup: prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -1713,14 +2622,14 @@ bool Database::getStudentGroupAndSubgroup(int studentId,
     if (rc == SQLITE_ROW) {
         outGroupId = sqlite3_column_int(stmt, 0);
         outSubgroup = sqlite3_column_int(stmt, 1);
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return true;
     } else if (rc == SQLITE_DONE) {
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return false;
     } else {
         std::cerr << "[✗] getStudentGroupAndSubgroup: step error: " << sqlite3_errmsg(db) << "\n";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return false;
     }
 }
@@ -1742,9 +2651,9 @@ bool Database::getStudentGradesForSemester(int studentId,
         "JOIN subjects s ON g.subjectid = s.id "
         "WHERE g.studentid = ? AND g.semesterid = ? "
         "ORDER BY s.name, g.date";
-    sqlite3_stmt* stmt = nullptr;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    int rc = SQLITE_OK;
+    if (!stmt) {
         std::cerr << "[✗] getStudentGradesForSemester: prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -1765,11 +2674,11 @@ bool Database::getStudentGradesForSemester(int studentId,
 
     if (rc != SQLITE_DONE) {
         std::cerr << "[✗] getStudentGradesForSemester: step error: " << sqlite3_errmsg(db) << "\n";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -1788,9 +2697,9 @@ bool Database::getStudentSubjectGrades(int studentId,
         "FROM grades "
         "WHERE studentid = ? AND subjectid = ? AND semesterid = ? "
         "ORDER BY date";
-    sqlite3_stmt* stmt = nullptr;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    int rc = SQLITE_OK;
+    if (!stmt) {
         std::cerr << "[✗] getStudentSubjectGrades: prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -1810,11 +2719,11 @@ bool Database::getStudentSubjectGrades(int studentId,
 
     if (rc != SQLITE_DONE) {
         std::cerr << "[✗] getStudentSubjectGrades: step error: " << sqlite3_errmsg(db) << "\n";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -1828,9 +2737,9 @@ bool Database::addGrade(int studentId, int subjectId, int semesterId,
     const char* sql =
         "INSERT INTO grades (studentid, subjectid, semesterid, value, date, gradetype) "
         "VALUES (?, ?, ?, ?, ?, ?)";
-    sqlite3_stmt* stmt = nullptr;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    int rc = SQLITE_OK;
+    if (!stmt) {
         std::cerr << "[✗] addGrade prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -1843,7 +2752,7 @@ bool Database::addGrade(int studentId, int subjectId, int semesterId,
     sqlite3_bind_text(stmt, 6, gradeType.c_str(), -1, SQLITE_TRANSIENT);
 
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return rc == SQLITE_DONE;
 }
 
@@ -1856,8 +2765,8 @@ bool Database::findGradeId(int studentId, int subjectId, int semesterId,
     const char* sql =
         "SELECT id FROM grades WHERE studentid = ? AND subjectid = ? AND semesterid = ? AND date = ? LIMIT 1;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
@@ -1869,7 +2778,7 @@ bool Database::findGradeId(int studentId, int subjectId, int semesterId,
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         outGradeId = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -1878,6 +2787,27 @@ bool Database::upsertGradeByKey(int studentId, int subjectId, int semesterId,
 {
     if (!db) return false;
 
+    // Один statement по уникальному ключу idxgradeskey (миграция 1)
+    const char* sql =
+        "INSERT INTO grades (studentid, subjectid, semesterid, value, date, gradetype) "
+        "VALUES (?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(studentid, subjectid, semesterid, date) "
+        "DO UPDATE SET value = excluded.value, gradetype = excluded.gradetype;";
+
+    sqlite3_stmt* stmt = (appliedSchemaVersion >= 1) ? prepareCached(sql) : nullptr;
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, studentId);
+        sqlite3_bind_int(stmt, 2, subjectId);
+        sqlite3_bind_int(stmt, 3, semesterId);
+        sqlite3_bind_int(stmt, 4, value);
+        sqlite3_bind_text(stmt, 5, date.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 6, gradeType.c_str(), -1, SQLITE_TRANSIENT);
+        const int rc = sqlite3_step(stmt);
+        releaseCached(stmt);
+        return rc == SQLITE_DONE;
+    }
+
+    // Схема без уникального ключа: старый путь find + update/insert
     int gradeId = 0;
     if (!findGradeId(studentId, subjectId, semesterId, date, gradeId)) return false;
 
@@ -1897,8 +2827,8 @@ bool Database::getGradeById(int gradeId, int& outValue, std::string& outDate, st
     const char* sql =
         "SELECT value, COALESCE(date, ''), COALESCE(gradetype, '') FROM grades WHERE id = ? LIMIT 1;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
@@ -1911,11 +2841,11 @@ bool Database::getGradeById(int gradeId, int& outValue, std::string& outDate, st
         const unsigned char* typeText = sqlite3_column_text(stmt, 2);
         outDate = dateText ? reinterpret_cast<const char*>(dateText) : "";
         outGradeType = typeText ? reinterpret_cast<const char*>(typeText) : "";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return true;
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return (rc == SQLITE_DONE);
 }
 
@@ -1926,15 +2856,15 @@ bool Database::deleteGrade(int gradeId) {
     }
 
     const char* sql = "DELETE FROM grades WHERE id = ?";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         std::cerr << "[✗] deleteGrade prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
 
     sqlite3_bind_int(stmt, 1, gradeId);
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
 
     if (rc == SQLITE_DONE && sqlite3_changes(db) > 0) {
         return true;
@@ -1951,11 +2881,14 @@ bool Database::getStudentUnexcusedAbsences(int studentId,
     outUnexcusedHours = 0;
     if (!db) return false;
 
-    const char* sql =
-        "SELECT SUM(hours) FROM absences "
-        "WHERE studentid = ? AND semesterid = ? AND type = 'unexcused';";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    // Неуважительные — всё, что не 'excused' (как в месячной сводке и в интерфейсе)
+    const char* sql = hasStudentStats()
+        ? "SELECT COALESCE(SUM(unexcusedhours), 0) FROM studentstats "
+          "WHERE studentid = ? AND semesterid = ?;"
+        : "SELECT COALESCE(SUM(hours), 0) FROM absences "
+          "WHERE studentid = ? AND semesterid = ? AND COALESCE(type, '') <> 'excused';";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt)
         return false;
 
     sqlite3_bind_int(stmt, 1, studentId);
@@ -1965,7 +2898,7 @@ bool Database::getStudentUnexcusedAbsences(int studentId,
         outUnexcusedHours = sqlite3_column_int(stmt, 0);
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -2007,8 +2940,8 @@ bool Database::findAbsenceId(int studentId, int subjectId, int semesterId,
     const char* sql =
         "SELECT id FROM absences WHERE studentid = ? AND subjectid = ? AND semesterid = ? AND date = ? LIMIT 1;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
@@ -2020,7 +2953,7 @@ bool Database::findAbsenceId(int studentId, int subjectId, int semesterId,
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         outAbsenceId = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -2029,18 +2962,39 @@ bool Database::upsertAbsenceByKey(int studentId, int subjectId, int semesterId,
 {
     if (!db) return false;
 
+    // Один statement по уникальному ключу idxabsenceskey (миграция 1)
+    const char* upsertSql =
+        "INSERT INTO absences (studentid, subjectid, semesterid, hours, date, type) "
+        "VALUES (?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(studentid, subjectid, semesterid, date) "
+        "DO UPDATE SET hours = excluded.hours, type = excluded.type;";
+
+    sqlite3_stmt* stmt = (appliedSchemaVersion >= 1) ? prepareCached(upsertSql) : nullptr;
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, studentId);
+        sqlite3_bind_int(stmt, 2, subjectId);
+        sqlite3_bind_int(stmt, 3, semesterId);
+        sqlite3_bind_int(stmt, 4, hours);
+        sqlite3_bind_text(stmt, 5, date.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 6, type.c_str(), -1, SQLITE_TRANSIENT);
+        const int rc = sqlite3_step(stmt);
+        releaseCached(stmt);
+        return rc == SQLITE_DONE;
+    }
+
+    // Схема без уникального ключа: старый путь find + update/insert
     int absenceId = 0;
     if (!findAbsenceId(studentId, subjectId, semesterId, date, absenceId)) return false;
 
     if (absenceId > 0) {
         const char* sql = "UPDATE absences SET hours = ?, type = ? WHERE id = ?;";
-        sqlite3_stmt* stmt = nullptr;
-        if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
-        sqlite3_bind_int(stmt, 1, hours);
-        sqlite3_bind_text(stmt, 2, type.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(stmt, 3, absenceId);
-        const int rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
+        sqlite3_stmt* updateStmt = prepareCached(sql);
+        if (!updateStmt) return false;
+        sqlite3_bind_int(updateStmt, 1, hours);
+        sqlite3_bind_text(updateStmt, 2, type.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(updateStmt, 3, absenceId);
+        const int rc = sqlite3_step(updateStmt);
+        releaseCached(updateStmt);
         return (rc == SQLITE_DONE);
     }
 
@@ -2057,8 +3011,8 @@ bool Database::getAbsenceById(int absenceId, int& outHours, std::string& outDate
     const char* sql =
         "SELECT hours, COALESCE(date, ''), COALESCE(type, '') FROM absences WHERE id = ? LIMIT 1;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
@@ -2071,11 +3025,11 @@ bool Database::getAbsenceById(int absenceId, int& outHours, std::string& outDate
         const unsigned char* typeText = sqlite3_column_text(stmt, 2);
         outDate = dateText ? reinterpret_cast<const char*>(dateText) : "";
         outType = typeText ? reinterpret_cast<const char*>(typeText) : "";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return true;
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return (rc == SQLITE_DONE);
 }
 
@@ -2084,18 +3038,216 @@ bool Database::deleteAbsence(int absenceId)
     if (!db) return false;
 
     const char* sql = "DELETE FROM absences WHERE id = ?";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
     sqlite3_bind_int(stmt, 1, absenceId);
     const int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
 
     return (rc == SQLITE_DONE);
 }
 
+bool Database::getJournalEntries(int subjectId, int semesterId, const std::string& date,
+                                 std::vector<JournalEntry>& outEntries)
+{
+    outEntries.clear();
+    if (!db) return false;
+
+    // Ключ (subjectid, semesterid) покрыт idxgradessubjectsemester / idxabsencessubjectsemester
+    const char* gradesSql =
+        "SELECT studentid, id, value FROM grades "
+        "WHERE subjectid = ? AND semesterid = ? AND date = ? ORDER BY studentid, id;";
+    const char* absencesSql =
+        "SELECT studentid, id, hours, COALESCE(type, '') FROM absences "
+        "WHERE subjectid = ? AND semesterid = ? AND date = ? ORDER BY studentid, id;";
+
+    std::unordered_map<int, JournalEntry> byStudent;
+
+    sqlite3_stmt* stmt = prepareCached(gradesSql);
+    if (!stmt) return false;
+    sqlite3_bind_int(stmt, 1, subjectId);
+    sqlite3_bind_int(stmt, 2, semesterId);
+    sqlite3_bind_text(stmt, 3, date.c_str(), -1, SQLITE_TRANSIENT);
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        JournalEntry& e = byStudent[sqlite3_column_int(stmt, 0)];
+        if (e.gradeId > 0) continue;  // как findGradeId: первая запись по ключу
+        e.gradeId = sqlite3_column_int(stmt, 1);
+        e.gradeValue = sqlite3_column_int(stmt, 2);
+    }
+    releaseCached(stmt);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[✗] getJournalEntries (grades): " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    stmt = prepareCached(absencesSql);
+    if (!stmt) return false;
+    sqlite3_bind_int(stmt, 1, subjectId);
+    sqlite3_bind_int(stmt, 2, semesterId);
+    sqlite3_bind_text(stmt, 3, date.c_str(), -1, SQLITE_TRANSIENT);
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        JournalEntry& e = byStudent[sqlite3_column_int(stmt, 0)];
+        if (e.absenceId > 0) continue;
+        e.absenceId = sqlite3_column_int(stmt, 1);
+        e.absenceHours = sqlite3_column_int(stmt, 2);
+        const unsigned char* type = sqlite3_column_text(stmt, 3);
+        e.absenceType = type ? reinterpret_cast<const char*>(type) : "";
+    }
+    releaseCached(stmt);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[✗] getJournalEntries (absences): " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    outEntries.reserve(byStudent.size());
+    for (auto& [studentId, e] : byStudent) {
+        e.studentId = studentId;
+        outEntries.push_back(std::move(e));
+    }
+    std::sort(outEntries.begin(), outEntries.end(),
+              [](const JournalEntry& a, const JournalEntry& b) { return a.studentId < b.studentId; });
+    return true;
+}
+
+bool Database::applyJournalBatch(int subjectId, int semesterId, const std::string& date,
+                                 const std::vector<JournalBatchRow>& rows,
+                                 std::vector<JournalBatchRowResult>& outResults)
+{
+    using Action = JournalBatchRow::Action;
+
+    outResults.assign(rows.size(), JournalBatchRowResult{});
+    for (size_t i = 0; i < rows.size(); ++i) outResults[i].studentId = rows[i].studentId;
+
+    auto failAll = [&](const std::string& message) {
+        for (auto& r : outResults) {
+            if (r.status == JournalBatchStatus::Applied || r.status == JournalBatchStatus::Failed) {
+                r.status = JournalBatchStatus::Failed;
+                r.message = message;
+            }
+        }
+        return false;
+    };
+
+    if (!db) return failAll("DB not connected");
+    if (subjectId <= 0 || semesterId <= 0 || date.empty()) return failAll("некорректное занятие");
+    if (rows.empty()) return true;
+
+    if (!sqlite3_get_autocommit(db)) {
+        std::cerr << "[✗] applyJournalBatch: already inside a transaction\n";
+        return failAll("уже открыта транзакция");
+    }
+
+    // IMMEDIATE: блокировка записи берётся до чтения, проверка конфликтов
+    // и запись видят одно и то же состояние
+    char* err = nullptr;
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", nullptr, nullptr, &err) != SQLITE_OK) {
+        const std::string message = err ? err : "BEGIN failed";
+        std::cerr << "[✗] applyJournalBatch BEGIN: " << message << "\n";
+        if (err) sqlite3_free(err);
+        return failAll(message);
+    }
+
+    std::vector<JournalEntry> existing;
+    if (!getJournalEntries(subjectId, semesterId, date, existing)) {
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return failAll("не удалось прочитать журнал");
+    }
+
+    std::unordered_map<int, const JournalEntry*> current;
+    current.reserve(existing.size());
+    for (const auto& e : existing) current.emplace(e.studentId, &e);
+
+    std::unordered_set<int> seen;
+    seen.reserve(rows.size());
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const JournalBatchRow& row = rows[i];
+        JournalBatchRowResult& result = outResults[i];
+
+        if (row.studentId <= 0 || !seen.insert(row.studentId).second) {
+            result.status = JournalBatchStatus::Invalid;
+            result.message = (row.studentId <= 0) ? "некорректный студент" : "студент повторяется в пакете";
+            continue;
+        }
+        if (row.grade == Action::Set && (row.gradeValue < 0 || row.gradeValue > 10)) {
+            result.status = JournalBatchStatus::Invalid;
+            result.message = "оценка вне диапазона 0..10";
+            continue;
+        }
+        if (row.absence == Action::Set
+            && (row.absenceHours < 1 || row.absenceHours > 8
+                || (row.absenceType != "excused" && row.absenceType != "unexcused"))) {
+            result.status = JournalBatchStatus::Invalid;
+            result.message = "пропуск: часы 1..8, тип excused/unexcused";
+            continue;
+        }
+
+        static const JournalEntry kEmpty;
+        const auto it = current.find(row.studentId);
+        const JournalEntry& cur = (it != current.end()) ? *it->second : kEmpty;
+
+        // Состояние после правки: одновременно оценка и пропуск недопустимы
+        const bool hasGrade = (row.grade == Action::Set) || (row.grade == Action::Keep && cur.gradeId > 0);
+        const bool hasAbsence = (row.absence == Action::Set) || (row.absence == Action::Keep && cur.absenceId > 0);
+        if (hasGrade && hasAbsence) {
+            result.status = JournalBatchStatus::Conflict;
+            result.message = (row.grade == Action::Set && row.absence != Action::Set)
+                ? "уже отмечен пропуск на эту дату/предмет"
+                : (row.absence == Action::Set && row.grade != Action::Set)
+                    ? "уже есть оценка на эту дату/предмет"
+                    : "нельзя одновременно оценку и пропуск";
+            continue;
+        }
+
+        bool changed = false;
+        bool ok = true;
+
+        // Сначала удаления: "снять пропуск + поставить оценку" в одной строке допустимо
+        if (row.grade == Action::Clear && cur.gradeId > 0) {
+            ok = ok && deleteGrade(cur.gradeId);
+            changed = true;
+        }
+        if (row.absence == Action::Clear && cur.absenceId > 0) {
+            ok = ok && deleteAbsence(cur.absenceId);
+            changed = true;
+        }
+        if (row.grade == Action::Set && !(cur.gradeId > 0 && cur.gradeValue == row.gradeValue)) {
+            ok = ok && upsertGradeByKey(row.studentId, subjectId, semesterId, row.gradeValue, date, "");
+            changed = true;
+        }
+        if (row.absence == Action::Set
+            && !(cur.absenceId > 0 && cur.absenceHours == row.absenceHours && cur.absenceType == row.absenceType)) {
+            ok = ok && upsertAbsenceByKey(row.studentId, subjectId, semesterId,
+                                          row.absenceHours, date, row.absenceType);
+            changed = true;
+        }
+
+        if (!ok) {
+            const std::string message = sqlite3_errmsg(db);
+            std::cerr << "[✗] applyJournalBatch: student " << row.studentId << ": " << message << "\n";
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            result.status = JournalBatchStatus::Failed;
+            return failAll(message);
+        }
+
+        result.status = changed ? JournalBatchStatus::Applied : JournalBatchStatus::Unchanged;
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &err) != SQLITE_OK) {
+        const std::string message = err ? err : "COMMIT failed";
+        std::cerr << "[✗] applyJournalBatch COMMIT: " << message << "\n";
+        if (err) sqlite3_free(err);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return failAll(message);
+    }
+
+    return true;
+}
+
 bool Database::getGroupSubjectAbsencesSummary(
     int groupId,
     int subjectId,
@@ -2187,6 +3339,7 @@ bool Database::addScheduleEntry(int groupId, int subgroup, int weekday,
 
     bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
     sqlite3_finalize(stmt);
+    if (ok) LessonSlotIndexCache::instance().invalidate();
     return ok;
 }
 
@@ -2212,6 +3365,7 @@ bool Database::deleteScheduleEntry(int scheduleId) {
     }
 
     sqlite3_finalize(stmt);
+    if (ok) LessonSlotIndexCache::instance().invalidate();
     return ok;
 }
 
@@ -2259,6 +3413,7 @@ bool Database::updateScheduleEntry(int scheduleId, int groupId, int subgroup, in
     sqlite3_finalize(stmt);
 
     if (rc == SQLITE_DONE && sqlite3_changes(db) > 0) {
+        LessonSlotIndexCache::instance().invalidate();
         return true;
     }
 
@@ -2296,9 +3451,8 @@ bool Database::getScheduleForGroup(
         ORDER BY sch.lessonnumber, sch.subgroup
     )SQL";
 
-    sqlite3_stmt* stmt = nullptr;
-    const int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         std::cerr << "[✗] getScheduleForGroup: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -2329,7 +3483,86 @@ bool Database::getScheduleForGroup(
         );
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
+    return stepRc == SQLITE_DONE;
+}
+
+bool Database::getScheduleForGroupWeek(int groupId,
+                                       int weekOfCycle,
+                                       int subgroup,
+                                       GroupWeekSchedule& out)
+{
+    out.rows.clear();
+    out.cellStart.fill(0);
+    if (!db) {
+        std::cerr << "[✗] getScheduleForGroupWeek: DB not connected\n";
+        return false;
+    }
+
+    const char* sql = R"SQL(
+        SELECT
+            sch.id,
+            sch.weekday,
+            sch.lessonnumber,
+            sch.subgroup,
+            subj.name,
+            COALESCE(sch.room, ''),
+            COALESCE(sch.lessontype, ''),
+            COALESCE(u.name, '') AS teachername
+        FROM schedule sch
+        JOIN subjects subj ON sch.subjectid = subj.id
+        LEFT JOIN users u ON sch.teacherid = u.id
+        WHERE (sch.groupid = ? OR sch.groupid = 0)
+          AND sch.weekofcycle = ?
+          AND (? = 0 OR sch.subgroup = 0 OR sch.subgroup = ?)
+        ORDER BY sch.weekday, sch.lessonnumber, sch.subgroup
+    )SQL";
+
+    // Конвенцию weekday определяем до выборки, чтобы не делать это внутри цикла
+    resolveWeekdayZeroBased();
+
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
+        std::cerr << "[✗] getScheduleForGroupWeek: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, groupId);
+    sqlite3_bind_int(stmt, 2, weekOfCycle);
+    sqlite3_bind_int(stmt, 3, subgroup);
+    sqlite3_bind_int(stmt, 4, subgroup);
+
+    // Строки приходят уже в порядке ячеек, поэтому достаточно посчитать размеры ячеек
+    std::array<int, GroupWeekSchedule::kCells> counts{};
+    int stepRc = 0;
+    while ((stepRc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const int weekday = normalizeWeekdayFromDb(sqlite3_column_int(stmt, 1));
+        const int lesson = sqlite3_column_int(stmt, 2);
+        if (weekday < 1 || weekday > GroupWeekSchedule::kDays) continue;
+        if (lesson < 1 || lesson > GroupWeekSchedule::kLessons) continue;
+
+        const char* subj = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+        const char* room = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
+        const char* ltype = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
+        const char* tname = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 7));
+
+        out.rows.emplace_back(
+            sqlite3_column_int(stmt, 0),
+            lesson,
+            sqlite3_column_int(stmt, 3),
+            subj ? subj : "",
+            room ? room : "",
+            ltype ? ltype : "",
+            tname ? tname : ""
+        );
+        ++counts[GroupWeekSchedule::cellIndex(weekday, lesson)];
+    }
+
+    releaseCached(stmt);
+
+    for (int i = 0; i < GroupWeekSchedule::kCells; ++i) {
+        out.cellStart[i + 1] = out.cellStart[i] + counts[i];
+    }
     return stepRc == SQLITE_DONE;
 }
 
@@ -2348,38 +3581,50 @@ bool Database::getLessonOccurrencesForStudent(
     int studentSubgroup = 0;
     {
         const char* sql = "SELECT COALESCE(groupid, 0), COALESCE(subgroup, 0) FROM users WHERE id = ? LIMIT 1;";
-        sqlite3_stmt* stmt = nullptr;
-        if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+        sqlite3_stmt* stmt = prepareCached(sql);
+        if (!stmt) return false;
         sqlite3_bind_int(stmt, 1, studentId);
         const int rc = sqlite3_step(stmt);
         if (rc == SQLITE_ROW) {
             groupId = sqlite3_column_int(stmt, 0);
             studentSubgroup = sqlite3_column_int(stmt, 1);
         }
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         if (rc != SQLITE_ROW) return false;
     }
-    if (groupId <= 0) return false;
 
-    std::string semStart;
-    std::string semEnd;
+    return getLessonOccurrencesForGroup(groupId, studentSubgroup, subjectId, lessonType, semesterId, out);
+}
+
+bool Database::getLessonOccurrencesForGroup(
+    int groupId,
+    int studentSubgroup,
+    int subjectId,
+    const std::string& lessonType,
+    int semesterId,
+    std::vector<LessonOccurrence>& out)
+{
+    out.clear();
+    if (!db) return false;
+    if (groupId <= 0 || subjectId <= 0 || semesterId <= 0) return false;
+
+    CivilDate semStart;
+    CivilDate semEnd;
     {
         const char* sql = "SELECT COALESCE(startdate, ''), COALESCE(enddate, '') FROM semesters WHERE id = ? LIMIT 1;";
-        sqlite3_stmt* stmt = nullptr;
-        if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+        sqlite3_stmt* stmt = prepareCached(sql);
+        if (!stmt) return false;
         sqlite3_bind_int(stmt, 1, semesterId);
         const int rc = sqlite3_step(stmt);
         if (rc == SQLITE_ROW) {
-            const unsigned char* s = sqlite3_column_text(stmt, 0);
-            const unsigned char* e = sqlite3_column_text(stmt, 1);
-            semStart = s ? reinterpret_cast<const char*>(s) : "";
-            semEnd = e ? reinterpret_cast<const char*>(e) : "";
+            semStart = CivilDate::parseISO(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+            semEnd = CivilDate::parseISO(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
         }
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         if (rc != SQLITE_ROW) return false;
     }
 
-    const bool filterBySemesterDates = (!semStart.empty() && !semEnd.empty());
+    const bool filterBySemesterDates = (semStart.isValid() && semEnd.isValid());
 
     auto trimCopyLocal = [](std::string s) {
         auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
@@ -2391,83 +3636,96 @@ bool Database::getLessonOccurrencesForStudent(
     const std::string normalizedLessonType = trimCopyLocal(lessonType);
     if (normalizedLessonType.empty()) return false;
 
-    std::vector<std::tuple<int, int, std::string, std::string>> weeks;
-    if (!getCycleWeeks(weeks)) return false;
+    // Все подходящие строки расписания группы — одним запросом; развёртка по
+    // календарным неделям идёт по CycleCalendar в памяти.
+    struct SlotRow {
+        int weekOfCycle = 0;
+        int dbWeekday = 0;
+        int scheduleId = 0;
+        int teacherId = 0;
+        int pairNumber = 0;
+    };
+    std::vector<SlotRow> slots;
+    {
+        const char* sql = R"SQL(
+            SELECT sch.weekofcycle, sch.weekday, sch.id, COALESCE(sch.teacherid, 0),
+                   sch.lessonnumber, COALESCE(sch.lessontype, '')
+            FROM schedule sch
+            JOIN subjects subj ON sch.subjectid = subj.id
+            WHERE (sch.groupid = ? OR sch.groupid = 0)
+              AND sch.subjectid = ?
+              AND (? = 0 OR sch.subgroup = 0 OR sch.subgroup = ?)
+        )SQL";
+        sqlite3_stmt* stmt = prepareCached(sql);
+        if (!stmt) return false;
+
+        sqlite3_bind_int(stmt, 1, groupId);
+        sqlite3_bind_int(stmt, 2, subjectId);
+        sqlite3_bind_int(stmt, 3, studentSubgroup);
+        sqlite3_bind_int(stmt, 4, studentSubgroup);
+
+        int rc = SQLITE_OK;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            const char* type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
+            if (trimCopyLocal(type ? type : "") != normalizedLessonType) continue;
+
+            SlotRow r;
+            r.weekOfCycle = sqlite3_column_int(stmt, 0);
+            r.dbWeekday = sqlite3_column_int(stmt, 1);
+            r.scheduleId = sqlite3_column_int(stmt, 2);
+            r.teacherId = sqlite3_column_int(stmt, 3);
+            r.pairNumber = sqlite3_column_int(stmt, 4);
+            slots.push_back(r);
+        }
+        releaseCached(stmt);
+        if (rc != SQLITE_DONE) return false;
+    }
 
-    std::vector<LessonOccurrence> occurrences;
-    std::unordered_map<int, std::pair<int, int>> scheduleMetaCache;
-    for (const auto& w : weeks) {
-        const int weekId = std::get<0>(w);
-        const int weekOfCycle = std::get<1>(w);
-        const std::string& weekStart = std::get<2>(w);
-        const std::string& weekEnd = std::get<3>(w);
+    if (!ensureCalendar()) return false;
+
+    // День недели в БД -> 1..6, тем же преобразованием, что и getScheduleForGroup
+    int dbWeekdayOf[7] = {0, 0, 0, 0, 0, 0, 0};
+    for (int weekday = 1; weekday <= 6; ++weekday) {
+        dbWeekdayOf[weekday] = normalizeWeekdayForDb(weekday);
+    }
 
+    std::vector<LessonOccurrence> occurrences;
+    for (const auto& w : calendar.weeks()) {
         if (filterBySemesterDates) {
-            if (!weekEnd.empty() && weekEnd < semStart) continue;
-            if (!weekStart.empty() && weekStart > semEnd) continue;
+            if (w.end < semStart) continue;
+            if (w.start > semEnd) continue;
         }
 
-        for (int weekday = 1; weekday <= 6; ++weekday) {
-            std::vector<std::tuple<int,int,int,std::string,std::string,std::string,std::string>> sched;
-            if (!getScheduleForGroup(groupId, weekday, weekOfCycle, sched)) return false;
-
-            for (const auto& row : sched) {
-                const int scheduleId = std::get<0>(row);
-                const int pairNumber = std::get<1>(row);
-                const int subgroup = std::get<2>(row);
-                const std::string type = trimCopyLocal(std::get<5>(row));
-
-                if (type != normalizedLessonType) continue;
-
-                int rowSubjectId = 0;
-                int teacherId = 0;
-                const auto it = scheduleMetaCache.find(scheduleId);
-                if (it != scheduleMetaCache.end()) {
-                    rowSubjectId = it->second.first;
-                    teacherId = it->second.second;
-                } else {
-                    const char* sql = "SELECT subjectid, teacherid FROM schedule WHERE id = ? LIMIT 1;";
-                    sqlite3_stmt* stmt = nullptr;
-                    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
-                    sqlite3_bind_int(stmt, 1, scheduleId);
-                    const int rc = sqlite3_step(stmt);
-                    if (rc == SQLITE_ROW) {
-                        rowSubjectId = sqlite3_column_int(stmt, 0);
-                        teacherId = sqlite3_column_int(stmt, 1);
-                    }
-                    sqlite3_finalize(stmt);
-                    scheduleMetaCache.emplace(scheduleId, std::make_pair(rowSubjectId, teacherId));
-                }
+        for (const auto& slot : slots) {
+            if (slot.weekOfCycle != w.weekOfCycle) continue;
 
-                if (rowSubjectId != subjectId) continue;
-                if (!((subgroup == 0) || (studentSubgroup == 0) || (subgroup == studentSubgroup))) continue;
+            for (int weekday = 1; weekday <= 6; ++weekday) {
+                if (dbWeekdayOf[weekday] != slot.dbWeekday) continue;
 
-                std::string dateISO;
-                if (!getDateForWeekdayByWeekId(weekId, weekday, dateISO)) return false;
-                if (dateISO.empty()) continue;
+                const CivilDate date = w.start.addDays(weekday - 1);
                 if (filterBySemesterDates) {
-                    if (dateISO < semStart || dateISO > semEnd) continue;
+                    if (date < semStart || date > semEnd) continue;
                 }
 
                 LessonOccurrence occ;
-                occ.lessonDateISO = std::move(dateISO);
-                occ.scheduleId = scheduleId;
-                occ.teacherId = teacherId;
-                occ.pairNumber = pairNumber;
-                occurrences.push_back(std::move(occ));
+                occ.lessonDate = date;
+                occ.scheduleId = slot.scheduleId;
+                occ.teacherId = slot.teacherId;
+                occ.pairNumber = slot.pairNumber;
+                occurrences.push_back(occ);
             }
         }
     }
 
     std::sort(occurrences.begin(), occurrences.end(), [](const LessonOccurrence& a, const LessonOccurrence& b) {
-        if (a.lessonDateISO != b.lessonDateISO) return a.lessonDateISO < b.lessonDateISO;
+        if (a.lessonDate != b.lessonDate) return a.lessonDate < b.lessonDate;
         if (a.pairNumber != b.pairNumber) return a.pairNumber < b.pairNumber;
         return a.scheduleId < b.scheduleId;
     });
 
     occurrences.erase(
         std::unique(occurrences.begin(), occurrences.end(), [](const LessonOccurrence& a, const LessonOccurrence& b) {
-            return a.lessonDateISO == b.lessonDateISO;
+            return a.lessonDate == b.lessonDate;
         }),
         occurrences.end());
 
@@ -2619,7 +3877,8 @@ bool Database::isScheduleEmpty(bool& outEmpty) {
         return false;
     }
 
-    const char* sql = "SELECT COUNT(*) FROM schedule;";
+    // EXISTS останавливается на первой строке, COUNT(*) прошёл бы всю таблицу
+    const char* sql = "SELECT EXISTS (SELECT 1 FROM schedule);";
     sqlite3_stmt* stmt = nullptr;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
     if (rc != SQLITE_OK) {
@@ -2630,8 +3889,7 @@ bool Database::isScheduleEmpty(bool& outEmpty) {
 
     rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
-        int cnt = sqlite3_column_int(stmt, 0);
-        outEmpty = (cnt == 0);
+        outEmpty = (sqlite3_column_int(stmt, 0) == 0);
         sqlite3_finalize(stmt);
         return true;
     } else {
@@ -2774,187 +4032,145 @@ bool Database::getLessonsForGroupAndDate(
 
 // ===== Cycle Weeks Utilities =====
 
-bool Database::getCycleWeeks(
-    std::vector<std::tuple<int, int, std::string, std::string>>& out) {
-    out.clear();
+void Database::invalidateCalendar()
+{
+    calendar.clear();
+    calendarLoaded = false;
+    // Расписание могло быть пересоздано целиком — соглашение о днях недели определяем заново
+    weekdayZeroBasedResolved = false;
+}
+
+bool Database::ensureCalendar()
+{
+    if (calendarLoaded) return true;
     if (!db) return false;
 
     const char* sql =
         "SELECT id, weekofcycle, startdate, enddate "
         "FROM cycleweeks ORDER BY id;";
-    sqlite3_stmt* stmt = nullptr;
-
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) return false;
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) return false;
 
+    std::vector<CycleCalendar::Week> weeks;
+    int rc = SQLITE_OK;
     while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        int id = sqlite3_column_int(stmt, 0);
-        int weekNumber = sqlite3_column_int(stmt, 1);
-        const unsigned char* s = sqlite3_column_text(stmt, 2);
-        const unsigned char* e = sqlite3_column_text(stmt, 3);
-        std::string start = s ? reinterpret_cast<const char*>(s) : "";
-        std::string end = e ? reinterpret_cast<const char*>(e) : "";
-        out.emplace_back(id, weekNumber, start, end);
+        CycleCalendar::Week w;
+        w.id = sqlite3_column_int(stmt, 0);
+        w.weekOfCycle = sqlite3_column_int(stmt, 1);
+        w.start = CivilDate::parseISO(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
+        w.end = CivilDate::parseISO(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
+        if (w.start.isNull() || w.end.isNull()) {
+            std::cerr << "[✗] cycleweeks: некорректные даты у недели id=" << w.id << "\n";
+            continue;
+        }
+        weeks.push_back(w);
     }
+    releaseCached(stmt);
 
-    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[✗] ensureCalendar: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    calendar.assign(std::move(weeks));
+    calendarLoaded = true;
+    return true;
+}
+
+bool Database::getCycleWeeks(
+    std::vector<std::tuple<int, int, std::string, std::string>>& out) {
+    out.clear();
+    if (!ensureCalendar()) return false;
+
+    out.reserve(calendar.weeks().size());
+    for (const auto& w : calendar.weeks()) {
+        out.emplace_back(w.id, w.weekOfCycle, w.start.toISO(), w.end.toISO());
+    }
     return true;
 }
 
 int Database::getWeekOfCycleForDate(const std::string& dateISO) {
-    std::tm tmStart{};
-    parseDateISO("2025-09-01", tmStart);
-    std::time_t tStart = std::mktime(&tmStart);
+    return getWeekOfCycleForDate(CivilDate::parseISO(dateISO));
+}
 
-    std::tm tmDate{};
-    if (!parseDateISO(dateISO, tmDate)) {
+int Database::getWeekOfCycleForDate(CivilDate date) {
+    if (date.isNull()) {
         return 1;  // Default if date parsing fails
     }
 
-    std::time_t tDate = std::mktime(&tmDate);
-
-    if (tDate < tStart) return 1;
+    // Сначала — реальная сетка из cycleweeks
+    if (ensureCalendar()) {
+        if (const auto* w = calendar.findByDate(date)) {
+            if (w->weekOfCycle > 0) return w->weekOfCycle;
+        }
+    }
 
-    long diffDays = static_cast<long>((tDate - tStart) / (60 * 60 * 24));
-    long weekIndex = diffDays / 7;
-    int weekOfCycle = static_cast<int>((weekIndex % 4) + 1);
+    // Вне сетки: 4-недельный цикл от 2025-09-01
+    constexpr CivilDate kCycleStart = CivilDate::fromYmd(2025, 9, 1);
+    if (date < kCycleStart) return 1;
 
-    return weekOfCycle;
+    const int weekIndex = (date - kCycleStart) / 7;
+    return (weekIndex % 4) + 1;
 }
 
 int Database::getWeekIdByDate(const std::string& dateISO) {
-    if (!db) return 0;
-
-    const char* sql = R"(
-        SELECT id
-        FROM cycleweeks
-        WHERE startdate <= ? AND enddate >= ?
-        ORDER BY startdate
-        LIMIT 1
-    )";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return 0;
+    return getWeekIdByDate(CivilDate::parseISO(dateISO));
+}
 
-    sqlite3_bind_text(stmt, 1, dateISO.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, dateISO.c_str(), -1, SQLITE_TRANSIENT);
+int Database::getWeekIdByDate(CivilDate date) {
+    if (date.isNull()) return 0;
+    if (!ensureCalendar()) return 0;
 
-    int id = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) id = sqlite3_column_int(stmt, 0);
-
-    sqlite3_finalize(stmt);
-    return id;
+    const auto* w = calendar.findByDate(date);
+    return w ? w->id : 0;
 }
 
 int Database::getWeekOfCycleByWeekId(int weekId) {
-    if (!db) return 0;
-
-    const char* sql =
-        "SELECT weekofcycle FROM cycleweeks WHERE id = ? LIMIT 1";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return 0;
+    if (!ensureCalendar()) return 0;
 
-    sqlite3_bind_int(stmt, 1, weekId);
-
-    int weekNumber = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        weekNumber = sqlite3_column_int(stmt, 0);
-    }
-
-    sqlite3_finalize(stmt);
-    return weekNumber > 0 ? weekNumber : 0;
+    const auto* w = calendar.findById(weekId);
+    return (w && w->weekOfCycle > 0) ? w->weekOfCycle : 0;
 }
 
 bool Database::getDateForWeekday(int weekOfCycle, int weekday, std::string& outDateISO) {
-    if (!db) return false;
-
-    const char* sql = R"(
-        SELECT startdate
-        FROM cycleweeks
-        WHERE weekofcycle = ?
-        ORDER BY id
-        LIMIT 1
-    )";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        return false;
-    }
-
-    sqlite3_bind_int(stmt, 1, weekOfCycle);
-
-    std::string start;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        const char* s = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        if (s) start = s;
-    }
-
-    sqlite3_finalize(stmt);
-    if (start.empty()) return false;
-
-    int y, m, d;
-    if (sscanf(start.c_str(), "%d-%d-%d", &y, &m, &d) != 3) return false;
+    CivilDate date;
+    if (!getDateForWeekday(weekOfCycle, weekday, date)) return false;
+    outDateISO = date.toISO();
+    return true;
+}
 
+bool Database::getDateForWeekday(int weekOfCycle, int weekday, CivilDate& outDate) {
     // DB weekday convention: 1..6 (Mon..Sat). startdate in cycleweeks is Monday.
-    // Offset in days: (weekday - 1)
     if (weekday < 1 || weekday > 6) return false;
-    d += (weekday - 1);
+    if (!ensureCalendar()) return false;
 
-    std::ostringstream oss;
-    oss << y << '-'
-        << std::setw(2) << std::setfill('0') << m << '-'
-        << std::setw(2) << std::setfill('0') << d;
+    const auto* w = calendar.firstOfCycleWeek(weekOfCycle);
+    if (!w) return false;
 
-    outDateISO = oss.str();
+    outDate = w->start.addDays(weekday - 1);
     return true;
 }
 
 bool Database::getDateForWeekdayByWeekId(int weekId, int weekday, std::string& outDateISO) {
     outDateISO.clear();
-    if (!db) return false;
-
-    // DB weekday convention: 1..6 (Mon..Sat). startdate in cycleweeks is Monday.
-    if (weekday < 1 || weekday > 6) return false;
-
-    const char* sql =
-        "SELECT startdate FROM cycleweeks WHERE id = ? LIMIT 1";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    sqlite3_bind_int(stmt, 1, weekId);
-
-    std::string start;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        const char* s = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        if (s) start = s;
-    }
-
-    sqlite3_finalize(stmt);
-    if (start.size() != 10) return false;  // YYYY-MM-DD
 
-    std::tm tmStart{};
-    tmStart.tm_year = std::stoi(start.substr(0, 4)) - 1900;
-    tmStart.tm_mon = std::stoi(start.substr(5, 2)) - 1;
-    tmStart.tm_mday = std::stoi(start.substr(8, 2));
-    tmStart.tm_hour = 0;
-    tmStart.tm_min = 0;
-    tmStart.tm_sec = 0;
-
-    std::time_t t = std::mktime(&tmStart);
-    if (t == (std::time_t)-1) return false;
+    CivilDate date;
+    if (!getDateForWeekdayByWeekId(weekId, weekday, date)) return false;
+    outDateISO = date.toISO();
+    return true;
+}
 
-    // Offset in days: (weekday - 1)
-    t += static_cast<long>(weekday - 1) * 24 * 60 * 60;
+bool Database::getDateForWeekdayByWeekId(int weekId, int weekday, CivilDate& outDate) {
+    outDate = CivilDate();
 
-    std::tm* tmRes = std::localtime(&t);
-    if (!tmRes) return false;
+    // DB weekday convention: 1..6 (Mon..Sat). startdate in cycleweeks is Monday.
+    if (weekday < 1 || weekday > 6) return false;
+    if (!ensureCalendar()) return false;
 
-    std::ostringstream oss;
-    oss << (tmRes->tm_year + 1900) << "-"
-        << std::setw(2) << std::setfill('0') << (tmRes->tm_mon + 1) << "-"
-        << std::setw(2) << std::setfill('0') << tmRes->tm_mday;
+    const auto* w = calendar.findById(weekId);
+    if (!w) return false;
 
-    outDateISO = oss.str();
+    outDate = w->start.addDays(weekday - 1);
     return true;
 }
 
@@ -2972,6 +4188,9 @@ bool Database::loadScheduleFromFile(const std::string& filePath) {
     std::string sql = buffer.str();
 
     if (execute(sql)) {
+        // Скрипт может менять и cycleweeks, и нумерацию дней недели
+        invalidateCalendar();
+        LessonSlotIndexCache::instance().invalidate();
         std::cout << "✓ Schedule loaded from file: " << filePath << std::endl;
         return true;
     }
@@ -3039,6 +4258,9 @@ void Database::dumpDbStats() {
         }
         sqlite3_finalize(stmt);
     }
+
+    std::cerr << "[DB] stmt cache: " << stmtCache.size() << " statements, "
+              << stmtCacheHits << " hits, " << stmtCacheMisses << " misses\n";
 }
 
 void Database::dumpSchemaAndCounts() {
@@ -3272,8 +4494,8 @@ bool Database::addAbsence(int studentId,
         "INSERT INTO absences (studentid, subjectid, semesterid, hours, date, type) "
         "VALUES (?, ?, ?, ?, ?, ?);";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         std::cerr << "[✗] addAbsence prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -3288,11 +4510,11 @@ bool Database::addAbsence(int studentId,
     const int rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         std::cerr << "[✗] addAbsence step error: " << sqlite3_errmsg(db) << "\n";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -3315,8 +4537,8 @@ bool Database::getStudentAbsencesForSemester(
         "WHERE a.studentid = ? AND a.semesterid = ? "
         "ORDER BY a.date;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         std::cerr << "[✗] getStudentAbsencesForSemester prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -3340,11 +4562,11 @@ bool Database::getStudentAbsencesForSemester(
 
     if (rc != SQLITE_DONE) {
         std::cerr << "[✗] getStudentAbsencesForSemester step error: " << sqlite3_errmsg(db) << "\n";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -3356,13 +4578,15 @@ bool Database::getStudentTotalAbsences(int studentId, int semesterId, int& outTo
         return false;
     }
 
-    const char* sql =
-        "SELECT COALESCE(SUM(hours), 0) "
-        "FROM absences "
-        "WHERE studentid = ? AND semesterid = ?;";
+    const char* sql = hasStudentStats()
+        ? "SELECT COALESCE(SUM(absencehours), 0) FROM studentstats "
+          "WHERE studentid = ? AND semesterid = ?;"
+        : "SELECT COALESCE(SUM(hours), 0) "
+          "FROM absences "
+          "WHERE studentid = ? AND semesterid = ?;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         return false;
     }
 
@@ -3373,7 +4597,7 @@ bool Database::getStudentTotalAbsences(int studentId, int semesterId, int& outTo
         outTotalHours = sqlite3_column_int(stmt, 0);
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
@@ -3392,8 +4616,8 @@ bool Database::updateGrade(int gradeId,
         "SET value = ?, date = ?, gradetype = ? "
         "WHERE id = ?;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         std::cerr << "[✗] updateGrade prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -3404,7 +4628,7 @@ bool Database::updateGrade(int gradeId,
     sqlite3_bind_int(stmt, 4, gradeId);
 
     const int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
 
     if (rc == SQLITE_DONE && sqlite3_changes(db) > 0) {
         return true;
@@ -3432,8 +4656,8 @@ bool Database::getGradesForStudentSubject(
         "WHERE studentid = ? AND subjectid = ? AND semesterid = ? "
         "ORDER BY date;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
         std::cerr << "[✗] getGradesForStudentSubject prepare error: " << sqlite3_errmsg(db) << "\n";
         return false;
     }
@@ -3457,11 +4681,11 @@ bool Database::getGradesForStudentSubject(
 
     if (rc != SQLITE_DONE) {
         std::cerr << "[✗] getGradesForStudentSubject step error: " << sqlite3_errmsg(db) << "\n";
-        sqlite3_finalize(stmt);
+        releaseCached(stmt);
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    releaseCached(stmt);
     return true;
 }
 
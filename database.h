@@ -1,20 +1,162 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <array>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <sqlite3.h>
 #include <vector>
 #include <utility>
 #include <tuple>
+#include <unordered_map>
+
+#include "core/civil_date.h"
+#include "core/cycle_calendar.h"
+
+class LessonSlotIndex;
 
 
 struct LessonOccurrence {
-    std::string lessonDateISO;
+    CivilDate lessonDate;
     int scheduleId = 0;
     int teacherId = 0;
     int pairNumber = 0;
 };
 
+// Итоги студента за месяц по одному предмету (Database::getStudentMonthSeries)
+struct StudentMonthStats {
+    int year = 0;
+    int month = 0;  // 1..12
+    int subjectId = 0;
+    int gradeSum = 0;
+    int gradeCount = 0;
+    int absenceHours = 0;
+    int unexcusedHours = 0;  // всё, что не 'excused'
+};
+
+// Оценка или пропуск студента вместе с занятием расписания, на которое пришлась дата
+// (Database::getStudentGradesWithLessons / getStudentAbsencesWithLessons)
+struct StudentLessonRecord {
+    int subjectId = 0;
+    std::string subject;
+    int value = 0;          // оценка или часы пропуска
+    std::string date;
+    std::string type;       // gradetype или тип пропуска
+    int lessonNumber = 0;   // 0 — занятия в расписании на эту дату нет
+    std::string lessonType;
+    std::string room;
+};
+
+// Оценка и пропуск студента за одно занятие (предмет, семестр, дата); id == 0 — записи нет
+struct JournalEntry {
+    int studentId = 0;
+    int gradeId = 0;
+    int gradeValue = 0;
+    int absenceId = 0;
+    int absenceHours = 0;
+    std::string absenceType;
+};
+
+// Строка пакета Database::applyJournalBatch: что сделать с оценкой и пропуском студента
+struct JournalBatchRow {
+    enum class Action { Keep, Set, Clear };
+
+    int studentId = 0;
+    Action grade = Action::Keep;
+    int gradeValue = 0;                     // 0..10 при Set
+    Action absence = Action::Keep;
+    int absenceHours = 0;                   // 1..8 при Set
+    std::string absenceType = "unexcused";  // excused / unexcused
+};
+
+enum class JournalBatchStatus {
+    Applied,    // изменения записаны
+    Unchanged,  // в БД уже то же самое
+    Conflict,   // после правки у студента были бы и оценка, и пропуск
+    Invalid,    // значения вне диапазона, повтор студента в пакете
+    Failed      // ошибка SQL, пакет откатен
+};
+
+struct JournalBatchRowResult {
+    int studentId = 0;
+    JournalBatchStatus status = JournalBatchStatus::Failed;
+    std::string message;
+};
+
+// Расписание группы на одну неделю цикла, разложенное по сетке 6×6 (день × пара).
+// rows отсортированы по (weekday, lessonnumber, subgroup), ячейка
+// (weekday 1..6, lessonNumber 1..6) — это rows[cellStart[i] .. cellStart[i + 1]).
+struct GroupWeekSchedule {
+    // (id, lessonnumber, subgroup, subject, room, lessontype, teachername) — как в getScheduleForGroup
+    using Row = std::tuple<int,int,int,std::string,std::string,std::string,std::string>;
+
+    static constexpr int kDays = 6;
+    static constexpr int kLessons = 6;
+    static constexpr int kCells = kDays * kLessons;
+
+    struct Range {
+        const Row* first = nullptr;
+        const Row* last = nullptr;
+        const Row* begin() const { return first; }
+        const Row* end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    std::vector<Row> rows;
+    std::array<int, kCells + 1> cellStart{};
+
+    static int cellIndex(int weekday, int lessonNumber) {
+        return (weekday - 1) * kLessons + (lessonNumber - 1);
+    }
+
+    Range cell(int weekday, int lessonNumber) const {
+        if (weekday < 1 || weekday > kDays || lessonNumber < 1 || lessonNumber > kLessons) return {};
+        const int i = cellIndex(weekday, lessonNumber);
+        return { rows.data() + cellStart[i], rows.data() + cellStart[i + 1] };
+    }
+
+    // Все пары дня подряд (ячейки одного дня лежат в rows непрерывно)
+    Range day(int weekday) const {
+        if (weekday < 1 || weekday > kDays) return {};
+        return { rows.data() + cellStart[cellIndex(weekday, 1)],
+                 rows.data() + cellStart[cellIndex(weekday, kLessons) + 1] };
+    }
+};
+
+
+// Профиль соединения SQLite: PRAGMA, которые Database::connect() применяет сразу после открытия.
+// Готовые профили:
+//   "balanced" (по умолчанию) — WAL + synchronous=NORMAL: читатели не ждут сохранений журнала;
+//   "safe"                    — прежнее поведение: rollback-журнал + synchronous=FULL;
+//   "bulk"                    — WAL + synchronous=OFF, большой кэш: массовая загрузка/генерация.
+// Профиль выбирается через setConnectionProfile() до connect() или переменной окружения
+// SCHOOLDB_PROFILE (имя профиля).
+struct ConnectionProfile {
+    std::string name = "balanced";
+    std::string journalMode = "WAL";     // WAL / DELETE / TRUNCATE / MEMORY
+    std::string synchronous = "NORMAL";  // OFF / NORMAL / FULL
+    int cacheSizeKiB = 16 * 1024;        // PRAGMA cache_size = -cacheSizeKiB
+    long long mmapSizeBytes = 256LL * 1024 * 1024;
+    std::string tempStore = "MEMORY";    // DEFAULT / FILE / MEMORY
+    int busyTimeoutMs = 5000;
+
+    // Флаги открытия. readOnly: SQLITE_OPEN_READONLY, journal_mode не меняется (читается как есть).
+    // singleThread: SQLITE_OPEN_NOMUTEX — соединением в каждый момент пользуется один поток
+    // (так выдаёт соединения ConnectionPool), мьютекс на каждый вызов sqlite3 не нужен.
+    bool readOnly = false;
+    bool singleThread = false;
+
+    static ConnectionProfile balanced();
+    static ConnectionProfile safe();
+    static ConnectionProfile bulk();
+
+    // false, если имя неизвестно (out не меняется)
+    static bool byName(const std::string& profileName, ConnectionProfile& out);
+    // SCHOOLDB_PROFILE или balanced()
+    static ConnectionProfile fromEnvironment();
+};
+
 
 // ============================================================
 // КЛАСС ДЛЯ РАБОТЫ С БАЗОЙ ДАННЫХ (SQLite)
@@ -32,10 +174,53 @@ class Database {
 private:
     sqlite3* db;
     std::string fileName;
+    ConnectionProfile profile;
+
+    bool applyConnectionProfile();
 
     bool weekdayZeroBasedResolved = false;
     bool weekdayZeroBased = false;
 
+    // Кэш подготовленных запросов: ключ — текст SQL.
+    // Горячие методы берут statement через prepareCached() и возвращают его
+    // через releaseCached() (reset + clear_bindings) вместо prepare/finalize.
+    // Кэш финализируется в disconnect().
+    // Прозрачные hash/equal: поиск по string_view без построения std::string на каждый вызов.
+    struct SqlHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view sql) const noexcept { return std::hash<std::string_view>{}(sql); }
+    };
+    std::unordered_map<std::string, sqlite3_stmt*, SqlHash, std::equal_to<>> stmtCache;
+    unsigned long long stmtCacheHits = 0;
+    unsigned long long stmtCacheMisses = 0;
+
+    sqlite3_stmt* prepareCached(const char* sql);
+    void releaseCached(sqlite3_stmt* stmt);
+    void clearStatementCache();
+
+    // Версионированные миграции схемы (PRAGMA user_version), вызываются из initialize()
+    bool applyMigrations();
+    // Версия схемы в файле: читается в connect(), обновляется applyMigrations()
+    int appliedSchemaVersion = 0;
+
+    // Календарь недель цикла (cycleweeks) в памяти: загружается при первом обращении,
+    // сбрасывается через invalidateCalendar() после записи в БД.
+    CycleCalendar calendar;
+    bool calendarLoaded = false;
+    bool ensureCalendar();
+
+    // Полнотекстовый индекс userssearch (FTS5, trigram) по "name username".
+    // Создаётся в initialize(), если SQLite собран с FTS5; иначе searchUsers сканирует users.
+    bool userSearchFts = false;
+    bool ensureUserSearchIndex();
+    // Тёплый старт: индекс и его триггеры уже есть — выставляет userSearchFts без пересчёта
+    bool userSearchIndexReady();
+
+    // Номер пары, тип и аудитория для записей студента (см. getStudentGradesWithLessons)
+    bool attachLessonSlots(int studentId, int semesterId, std::vector<StudentLessonRecord>& rows);
+    bool loadStudentLessonRecords(const char* sql, const char* what, int studentId, int semesterId,
+                                  std::vector<StudentLessonRecord>& out);
+
     bool resolveWeekdayZeroBased();
     int normalizeWeekdayForDb(int weekday);
     int normalizeWeekdayFromDb(int weekday);
@@ -52,8 +237,14 @@ public:
     // Возвращает true, если успешно, false при ошибке
     bool connect();
 
+    // Профиль PRAGMA для следующего connect() (по умолчанию — из окружения)
+    void setConnectionProfile(const ConnectionProfile& p) { profile = p; }
+    const ConnectionProfile& connectionProfile() const { return profile; }
+
     // Проверить, открыта ли БД
     bool isConnected() const;
+    // Путь к файлу БД (для дополнительных соединений, например DbExecutor)
+    const std::string& filePath() const { return fileName; }
 
     // Закрыть БД
     void disconnect();
@@ -61,7 +252,13 @@ public:
     // Выполнить SQL без выборки (CREATE TABLE, INSERT, UPDATE, DELETE)
     bool execute(const std::string& sql);
 
+    // Схема и миграции. Если файл уже на последней миграции (user_version), DDL не
+    // выполняется: тёплый старт стоит одного PRAGMA, прочитанного в connect()
     bool initialize();
+    // Текущая версия схемы (PRAGMA user_version), -1 при ошибке
+    int schemaVersion();
+    // Есть ли сводка studentstats (миграция 2); иначе статистика считается по grades/absences
+    bool hasStudentStats() const { return appliedSchemaVersion >= 2; }
     bool initializeDemoData();  // ← новый метод для наполнения БД
     bool findUser(const std::string& username,
               const std::string& password,
@@ -84,13 +281,26 @@ public:
         std::vector<std::tuple<int, std::string, std::string, std::string, int, int>>& outUsers
     );
 
+    // Поиск пользователей для админки: страница [offset, offset + limit) и общее число совпадений.
+    // query — подстрока "ФИО логин" без учёта регистра ("" — все), role — "admin"/"teacher"/"student"
+    // или "" (любая). Строки в формате getAllUsers. Порядок — по sortKey, при равенстве по id.
+    enum class UserSortKey { Id, Username, Name, Role, GroupId, Subgroup };
+    bool searchUsers(const std::string& query,
+                     const std::string& role,
+                     int offset,
+                     int limit,
+                     std::vector<std::tuple<int, std::string, std::string, std::string, int, int>>& outUsers,
+                     int& outTotal,
+                     UserSortKey sortKey = UserSortKey::Id,
+                     bool ascending = true);
+
     bool getUserIdByUsername(const std::string& username, int& outUserId);
     bool getStudentGradesForSemester(int studentId, int semesterId,
     std::vector<std::tuple<std::string, int, std::string, std::string>>& outGrades);
     // (subjectName, value, date, grade_type)
 
     // ===== Student monthly stats (UI helpers) =====
-    // subjectId: 0 means "all subjects". year/month are calendar values (e.g. 2025, 12).
+    // subjectId: 0 means "all subjects". year/month are calendar values (e.g. 2025, 12), year in 1..9999.
     bool getStudentAverageGradeForMonth(int studentId, int semesterId,
                                         int year, int month, int subjectId,
                                         double& outAvg, int& outCount);
@@ -100,6 +310,22 @@ public:
                                         int year, int month, int subjectId,
                                         int& outTotalHours, int& outUnexcusedHours);
 
+    // Весь семестр одним запросом: строка на (месяц, предмет), по возрастанию месяца.
+    // Страницы считают из неё итоги месяца при переключении месяца/предмета без запросов.
+    bool getStudentMonthSeries(int studentId, int semesterId,
+                               std::vector<StudentMonthStats>& outSeries);
+
+    // Оценки/пропуски за семестр (по дате) с номером пары, типом занятия и аудиторией.
+    // Занятия берутся из LessonSlotIndexCache (индекс группы за семестр строится один раз),
+    // поэтому число запросов не зависит от числа записей.
+    bool getStudentGradesWithLessons(int studentId, int semesterId,
+                                     std::vector<StudentLessonRecord>& outGrades);
+    bool getStudentAbsencesWithLessons(int studentId, int semesterId,
+                                       std::vector<StudentLessonRecord>& outAbsences);
+    // Расписание группы (вместе с общими лекциями) и недели цикла семестра для
+    // LessonSlotIndex; обычно вызывается через LessonSlotIndexCache::get
+    bool buildLessonSlotIndex(int groupId, int semesterId, LessonSlotIndex& out);
+
     bool getStudentsOfGroup(int groupId,
                             std::vector<std::pair<int, std::string>>& outStudents);
     bool getStudentSubjectGrades(int studentId,
@@ -165,6 +391,19 @@ public:
     bool getAbsenceById(int absenceId, int& outHours, std::string& outDate, std::string& outType);
     bool deleteAbsence(int absenceId);
 
+    // Оценки и пропуски всех студентов за занятие двумя запросами (по studentId, без пустых)
+    bool getJournalEntries(int subjectId, int semesterId, const std::string& date,
+                           std::vector<JournalEntry>& outEntries);
+
+    // Применить правки журнала за одно занятие в одной транзакции (BEGIN IMMEDIATE ... COMMIT).
+    // Текущие записи читаются одним getJournalEntries на весь пакет; строка, после которой
+    // у студента были бы и оценка, и пропуск, получает Conflict и пропускается, остальные
+    // применяются. outResults — по результату на строку rows, в том же порядке.
+    // false — ошибка SQL: всё откатывается, строки Applied становятся Failed.
+    bool applyJournalBatch(int subjectId, int semesterId, const std::string& date,
+                           const std::vector<JournalBatchRow>& rows,
+                           std::vector<JournalBatchRowResult>& outResults);
+
     bool getStudentAbsencesForSemester(
     int studentId,
     int semesterId,
@@ -217,6 +456,13 @@ public:
      std::vector<std::tuple<int,int,int,std::string,std::string,std::string,std::string>>& rows
  );
 
+    // Вся неделя группы одним запросом (weekday 1..6 в ячейках, как в UI).
+    // subgroup: 0 — все подгруппы, иначе общие пары + пары этой подгруппы.
+    bool getScheduleForGroupWeek(int groupId,
+                                 int weekOfCycle,
+                                 int subgroup,
+                                 GroupWeekSchedule& out);
+
     bool getLessonOccurrencesForStudent(
         int studentId,
         int subjectId,
@@ -224,6 +470,16 @@ public:
         int semesterId,
         std::vector<LessonOccurrence>& out);
 
+    // То же для группы/подгруппы напрямую (результат зависит только от них, не от студента).
+    // studentSubgroup: 0 — все подгруппы.
+    bool getLessonOccurrencesForGroup(
+        int groupId,
+        int studentSubgroup,
+        int subjectId,
+        const std::string& lessonType,
+        int semesterId,
+        std::vector<LessonOccurrence>& out);
+
     // Resolve teacher for a specific schedule entry (by scheduleId)
     bool getTeacherForScheduleId(int scheduleId, int& outTeacherId, std::string& outTeacherName);
 
@@ -265,10 +521,16 @@ public:
     sqlite3* getHandle() { return db; }
     sqlite3* getRawHandle() const { return db; }
     int  getWeekOfCycleForDate(const std::string& dateISO);
+    int  getWeekOfCycleForDate(CivilDate date);
+    // Сбросить календарь недель: следующий запрос перечитает cycleweeks
+    // (и заново определит, с 0 или с 1 в БД нумеруются дни недели). Общий LessonSlotIndexCache не сбрасывает
+    void invalidateCalendar();
     bool getCycleWeeks(std::vector<std::tuple<int,int,std::string,std::string>>& out);
     bool getDateForWeekdayByWeekId(int weekId, int weekday, std::string& outDateISO);
+    bool getDateForWeekdayByWeekId(int weekId, int weekday, CivilDate& outDate);
     int getWeekOfCycleByWeekId(int weekId);
     bool getDateForWeekday(int weekOfCycle, int weekday, std::string& outDateISO);
+    bool getDateForWeekday(int weekOfCycle, int weekday, CivilDate& outDate);
     // Проверить, не занята ли ячейка расписания (группа+день+пара+неделя+подгруппа)
     bool isScheduleSlotBusy(int groupId, int subgroup,
                             int weekday, int lessonNumber, int weekOfCycle);
@@ -335,6 +597,7 @@ bool deleteScheduleEntry(int scheduleId);
                              int lessonNumber, int weekOfCycle, int subjectId,
                              int teacherId, const std::string& room, const std::string& lessonType);
     int getWeekIdByDate(const std::string& dateISO);
+    int getWeekIdByDate(CivilDate date);
 
 
 };
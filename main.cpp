@@ -3,9 +3,12 @@
 #include "config.h"
 #include "database.h"
 #include "loginwindow.h"
+#include "services/schedule_importer.h"
 #include "ui/style/ThemeManager.h"
+#include "ui/util/DbExecutor.h"
 #include <QCoreApplication>
 #include <QDir>
+#include <chrono>
 #include <iostream>
 #include <memory>
  #include <utility>
@@ -54,19 +57,62 @@ static bool schemaLooksLikeSnakeCase(sqlite3* db)
     return false;
 }
 
+// Время этапов запуска до окна входа, мкс; печатается одной строкой перед app.exec()
+class StartupTrace {
+public:
+    void mark(const char* phase)
+    {
+        const auto now = Clock::now();
+        phases.emplace_back(phase, std::chrono::duration_cast<std::chrono::microseconds>(now - last).count());
+        last = now;
+    }
+
+    void print() const
+    {
+        std::cerr << "[startup]";
+        for (const auto& p : phases) std::cerr << " " << p.first << "=" << p.second << "us";
+        std::cerr << " total="
+                  << std::chrono::duration_cast<std::chrono::microseconds>(last - start).count() << "us\n";
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    Clock::time_point last = start;
+    std::vector<std::pair<const char*, long long>> phases;
+};
+
+// Диагностика БД при запуске (счётчики, self-test входа и расписания, проверка схемы)
+// стоит запросов на каждом старте, поэтому включается явно:
+// аргумент --db-diagnostics или SCHOOLDB_DIAGNOSTICS=1
+static bool diagnosticsRequested()
+{
+    if (QCoreApplication::arguments().contains("--db-diagnostics")) return true;
+    const QByteArray env = qgetenv("SCHOOLDB_DIAGNOSTICS");
+    return !env.isEmpty() && env != "0";
+}
+
 int main(int argc, char* argv[])
 {
+    StartupTrace trace;
+
     QApplication app(argc, argv);
+    trace.mark("qapp");
 
     // Тема
     ThemeManager::instance()->applyTheme(&app);
+    trace.mark("theme");
+
+    const bool diagnostics = diagnosticsRequested();
 
     // БД используем ту же, что и консольная версия (PROJECT_ROOT\school.db)
     const QString dbPath = QDir(QString::fromStdString(PROJECT_ROOT)).filePath("school.db");
 
     std::unique_ptr<Database> db = std::make_unique<Database>(dbPath.toStdString());
     if (!db->connect()) return 1;
+    trace.mark("connect");
     if (!db->initialize()) return 1;
+    trace.mark("initialize");
 
      std::cerr << "[DB] opened path: " << dbPath.toStdString() << "\n";
 
@@ -74,6 +120,7 @@ int main(int argc, char* argv[])
      if (!db->isScheduleEmpty(scheduleEmpty)) {
          std::cerr << "[DB] isScheduleEmpty failed\n";
      }
+     trace.mark("scheduleCheck");
 
      // Если БД пустая (обычно в Release), делаем ровно один раз демо-инициализацию и загрузку расписаний.
      if (scheduleEmpty) {
@@ -82,104 +129,116 @@ int main(int argc, char* argv[])
              return 1;
          }
 
-         const std::vector<std::pair<int, QString>> schedules = {
-             {1, QDir(QString::fromStdString(PROJECT_ROOT)).filePath("schedule_420601_newest.sql")},
-             {2, QDir(QString::fromStdString(PROJECT_ROOT)).filePath("schedule_420602_newest.sql")},
-             {3, QDir(QString::fromStdString(PROJECT_ROOT)).filePath("schedule_420603_newest.sql")},
-             {4, QDir(QString::fromStdString(PROJECT_ROOT)).filePath("schedule_420604_newest.sql")}
-         };
-
-         int successful = 0;
-         for (const auto& p : schedules) {
-             if (db->loadGroupSchedule(p.first, p.second.toStdString())) {
-                 ++successful;
-             } else {
-                 std::cerr << "[DB] failed to load schedule file: " << p.second.toStdString() << "\n";
-             }
+         // Файлы разбираются параллельно, строки пишет одно соединение одним
+         // подготовленным INSERT в одной транзакции; число строк — из разобранных данных
+         std::vector<std::string> schedules;
+         for (int group = 1; group <= 4; ++group) {
+             const QString name = QString("schedule_42060%1_newest.sql").arg(group);
+             schedules.push_back(QDir(QString::fromStdString(PROJECT_ROOT)).filePath(name).toStdString());
          }
 
-         std::cerr << "[DB] loaded schedules: " << successful << "/" << schedules.size() << "\n";
-     }
-
-     // Safe auth self-test: log current state; no destructive writes if DB already has users.
-     {
-         sqlite3_stmt* stmt = nullptr;
-         int usersCount = -1;
-         if (sqlite3_prepare_v2(db->getHandle(), "SELECT COUNT(*) FROM users;", -1, &stmt, nullptr) == SQLITE_OK) {
-             if (sqlite3_step(stmt) == SQLITE_ROW) {
-                 usersCount = sqlite3_column_int(stmt, 0);
+         ScheduleImporter importer(*db);
+         const auto imported = importer.importFiles(schedules, 0);
+         if (imported.ok) {
+             for (const auto& f : imported.value.perFile) {
+                 std::cerr << "[DB] schedule " << f.path << ": " << f.rows << " rows\n";
              }
+             std::cerr << "[DB] loaded schedules: " << imported.value.files << " files, "
+                       << imported.value.rows << " rows in " << imported.value.totalMs << " ms ("
+                       << static_cast<long long>(imported.value.rowsPerSec) << " rows/sec, "
+                       << imported.value.threadsUsed << " threads)\n";
+         } else {
+             std::cerr << "[DB] failed to load schedules: " << imported.error << "\n";
          }
-         sqlite3_finalize(stmt);
-         std::cerr << "[DB auth] users: " << usersCount << "\n";
-
-         int id = 0;
-         std::string name;
-         std::string role;
-         const bool ok = db->findUser("admin", "123", id, name, role);
-         std::cerr << "[DB auth] findUser(admin/123): " << (ok ? "OK" : "FAIL")
-                   << " id=" << id << " role=" << role << "\n";
+         trace.mark("demoData");
      }
 
-#ifdef QT_DEBUG
-    db->dumpDbStats();
-    db->dumpSchemaAndCounts();
-
-    // Если рядом с exe лежит "чужой" school.db со snake_case таблицами (cycle_weeks, ...),
-    // то не трогаем его, а в debug переключаемся на отдельный файл с нашей схемой.
-    if (schemaLooksLikeSnakeCase(db->getHandle())) {
-        const QString altPath = QDir(QCoreApplication::applicationDirPath()).filePath("school_qt.db");
-        std::cerr << "[DB] schema mismatch detected. Switching to: " << altPath.toStdString() << "\n";
-
-        db = std::make_unique<Database>(altPath.toStdString());
-        if (!db->connect()) return 1;
-        if (!db->initialize()) return 1;
+    if (diagnostics) {
+        // Safe auth self-test: log current state; no destructive writes if DB already has users.
+        {
+            sqlite3_stmt* stmt = nullptr;
+            int usersCount = -1;
+            if (sqlite3_prepare_v2(db->getHandle(), "SELECT COUNT(*) FROM users;", -1, &stmt, nullptr) == SQLITE_OK) {
+                if (sqlite3_step(stmt) == SQLITE_ROW) {
+                    usersCount = sqlite3_column_int(stmt, 0);
+                }
+            }
+            sqlite3_finalize(stmt);
+            std::cerr << "[DB auth] users: " << usersCount << "\n";
+
+            int id = 0;
+            std::string name;
+            std::string role;
+            const bool ok = db->findUser("admin", "123", id, name, role);
+            std::cerr << "[DB auth] findUser(admin/123): " << (ok ? "OK" : "FAIL")
+                       << " id=" << id << " role=" << role << "\n";
+        }
 
         db->dumpDbStats();
         db->dumpSchemaAndCounts();
-    }
 
-    // End-to-end self-test (DB -> schedule rows), no UI.
-    int testStudentId = 0;
-    {
-        sqlite3_stmt* stmt = nullptr;
-        if (sqlite3_prepare_v2(db->getHandle(),
-                               "SELECT id FROM users WHERE role='student' LIMIT 1;",
-                               -1, &stmt, nullptr) == SQLITE_OK) {
-            if (sqlite3_step(stmt) == SQLITE_ROW) {
-                testStudentId = sqlite3_column_int(stmt, 0);
+        // Если рядом с exe лежит "чужой" school.db со snake_case таблицами (cycle_weeks, ...),
+        // то не трогаем его, а переключаемся на отдельный файл с нашей схемой.
+        if (schemaLooksLikeSnakeCase(db->getHandle())) {
+            const QString altPath = QDir(QCoreApplication::applicationDirPath()).filePath("school_qt.db");
+            std::cerr << "[DB] schema mismatch detected. Switching to: " << altPath.toStdString() << "\n";
+
+            db = std::make_unique<Database>(altPath.toStdString());
+            if (!db->connect()) return 1;
+            if (!db->initialize()) return 1;
+
+            db->dumpDbStats();
+            db->dumpSchemaAndCounts();
+        }
+
+        // End-to-end self-test (DB -> schedule rows), no UI.
+        int testStudentId = 0;
+        {
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(db->getHandle(),
+                                   "SELECT id FROM users WHERE role='student' LIMIT 1;",
+                                   -1, &stmt, nullptr) == SQLITE_OK) {
+                if (sqlite3_step(stmt) == SQLITE_ROW) {
+                    testStudentId = sqlite3_column_int(stmt, 0);
+                }
             }
+            sqlite3_finalize(stmt);
         }
-        sqlite3_finalize(stmt);
-    }
 
-    if (testStudentId > 0) {
-        int groupId = 0;
-        int subgroup = 0;
-        if (db->getStudentGroupAndSubgroup(testStudentId, groupId, subgroup)) {
-            int total = 0;
-            for (int w = 1; w <= 4; ++w) {
-                for (int d = 0; d <= 5; ++d) {
-                    std::vector<std::tuple<int,int,int,std::string,std::string,std::string,std::string>> rows;
-                    if (db->getScheduleForGroup(groupId, d, w, rows)) {
-                        total += static_cast<int>(rows.size());
+        if (testStudentId > 0) {
+            int groupId = 0;
+            int subgroup = 0;
+            if (db->getStudentGroupAndSubgroup(testStudentId, groupId, subgroup)) {
+                int total = 0;
+                for (int w = 1; w <= 4; ++w) {
+                    for (int d = 0; d <= 5; ++d) {
+                        std::vector<std::tuple<int,int,int,std::string,std::string,std::string,std::string>> rows;
+                        if (db->getScheduleForGroup(groupId, d, w, rows)) {
+                            total += static_cast<int>(rows.size());
+                        }
                     }
                 }
+                std::cerr << "[DB self-test] studentId=" << testStudentId
+                          << " groupId=" << groupId
+                          << " subgroup=" << subgroup
+                          << " totalRows=" << total << "\n";
+            } else {
+                std::cerr << "[DB self-test] studentId=" << testStudentId << " has no group/subgroup\n";
             }
-            std::cerr << "[DB self-test] studentId=" << testStudentId
-                      << " groupId=" << groupId
-                      << " subgroup=" << subgroup
-                      << " totalRows=" << total << "\n";
         } else {
-            std::cerr << "[DB self-test] studentId=" << testStudentId << " has no group/subgroup\n";
+            std::cerr << "[DB self-test] no student found\n";
         }
-    } else {
-        std::cerr << "[DB self-test] no student found\n";
+        trace.mark("diagnostics");
     }
-#endif
+
+    // Чтения для окон — на отдельном потоке со своим соединением к тому же файлу
+    if (!DbExecutor::instance().start(db->filePath())) return 1;
+    trace.mark("dbExecutor");
 
     LoginWindow window(db.get());
     window.show();
+    trace.mark("loginWindow");
+    trace.print();
 
     return app.exec();
 }
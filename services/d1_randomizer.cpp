@@ -3,8 +3,12 @@
 #include <algorithm>
 #include <chrono>
 #include <cctype>
+#include <condition_variable>
 #include <iostream>
-#include <unordered_set>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <tuple>
 
 namespace {
 
@@ -46,26 +50,59 @@ static bool execGetStudentsOfGroupWithSubgroup(sqlite3* rawDb, int groupId, std:
     return rc == SQLITE_DONE;
 }
 
-static bool execGetSemesterDateRange(sqlite3* rawDb, int semesterId, std::string& outStartDate, std::string& outEndDate)
+static bool execGetGroupsWithStudents(sqlite3* rawDb, std::vector<int>& out)
 {
-    outStartDate.clear();
-    outEndDate.clear();
-    if (!rawDb || semesterId <= 0) return false;
+    out.clear();
+    if (!rawDb) return false;
+
+    const char* sql =
+        "SELECT DISTINCT groupid FROM users "
+        "WHERE role = 'student' AND groupid > 0 "
+        "ORDER BY groupid;";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(rawDb, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+
+    int rc = 0;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        out.push_back(sqlite3_column_int(stmt, 0));
+    }
+
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+// (studentId, subjectId) -> отсортированные даты уже существующих оценок
+using ExistingGradeDates = std::map<std::pair<int, int>, std::vector<CivilDate>>;
+
+// Все оценки студентов группы за семестр — одним запросом вместо getStudentSubjectGrades на каждое правило
+static bool execLoadExistingGradeDates(sqlite3* rawDb, int groupId, int semesterId, ExistingGradeDates& out)
+{
+    out.clear();
+    if (!rawDb) return false;
+
+    const char* sql =
+        "SELECT g.studentid, g.subjectid, COALESCE(g.date, '') "
+        "FROM users u "
+        "CROSS JOIN grades g ON g.studentid = u.id "  // от студентов группы по idxgradeskey, а не скан grades
+        "WHERE u.role = 'student' AND u.groupid = ? AND g.semesterid = ?;";
 
-    const char* sql = "SELECT COALESCE(startdate, ''), COALESCE(enddate, '') FROM semesters WHERE id = ? LIMIT 1;";
     sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(rawDb, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    if (sqlite3_prepare_v2(rawDb, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
 
-    sqlite3_bind_int(stmt, 1, semesterId);
+    sqlite3_bind_int(stmt, 1, groupId);
+    sqlite3_bind_int(stmt, 2, semesterId);
 
-    const int rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        const unsigned char* s = sqlite3_column_text(stmt, 0);
-        const unsigned char* e = sqlite3_column_text(stmt, 1);
-        outStartDate = s ? reinterpret_cast<const char*>(s) : "";
-        outEndDate = e ? reinterpret_cast<const char*>(e) : "";
-        sqlite3_finalize(stmt);
-        return true;
+    int rc = 0;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const int studentId = sqlite3_column_int(stmt, 0);
+        const int subjectId = sqlite3_column_int(stmt, 1);
+        const CivilDate date = CivilDate::parseISO(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
+        out[{studentId, subjectId}].push_back(date);
     }
 
     sqlite3_finalize(stmt);
@@ -96,19 +133,101 @@ static void execRollback(sqlite3* rawDb)
     sqlite3_exec(rawDb, "ROLLBACK;", nullptr, nullptr, nullptr);
 }
 
-static std::vector<std::string> uniqueSorted(std::vector<std::string> v)
+static std::vector<CivilDate> uniqueSorted(std::vector<CivilDate> v)
 {
     std::sort(v.begin(), v.end());
     v.erase(std::unique(v.begin(), v.end()), v.end());
     return v;
 }
 
-static std::vector<std::string> uniqueSortedFilteredNonEmpty(std::vector<std::string> v)
+static std::vector<CivilDate> uniqueSortedFilteredNonEmpty(std::vector<CivilDate> v)
 {
-    v.erase(std::remove_if(v.begin(), v.end(), [](const std::string& s) { return s.empty(); }), v.end());
+    v.erase(std::remove_if(v.begin(), v.end(), [](CivilDate d) { return d.isNull(); }), v.end());
     return uniqueSorted(std::move(v));
 }
 
+static double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void printReport(const D1RandomizerStats& stats)
+{
+    std::cerr << "[D1] Report: skippedBecauseLectureForbidden=" << stats.skippedBecauseLectureForbidden << "\n";
+    for (const auto& it : stats.reportByRule) {
+        const auto& key = it.first;
+        const auto& rep = it.second;
+        std::cerr << "[D1] Rule '" << key << "': candidatesFound=" << rep.candidatesFound
+                  << " requestedGrades=" << rep.requestedGrades
+                  << " created=" << rep.created
+                  << " updated=" << rep.updated
+                  << " skippedExisting=" << rep.skippedExisting
+                  << " skippedNoCandidates=" << rep.skippedNoCandidates
+                  << "\n";
+    }
+
+    const auto& t = stats.timing;
+    std::cerr << "[D1] Timing: groups=" << stats.groupRuns
+              << " students=" << stats.studentsProcessed
+              << " threads=" << stats.threadsUsed
+              << " seed=" << stats.seed
+              << " load=" << t.loadMs << "ms"
+              << " candidates=" << t.candidatesMs << "ms"
+              << " plan=" << t.planMs << "ms"
+              << " write=" << t.writeMs << "ms"
+              << " total=" << t.totalMs << "ms"
+              << " rows/sec=" << t.rowsPerSec << "\n";
+}
+
+// SplitMix64: из (seed, семестр, студент, правило) получаем независимые потоки ГПСЧ
+static std::uint64_t splitMix64(std::uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static std::uint64_t fnv1a64(const std::string& s)
+{
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+// Равномерное целое в [lo, hi]. std::uniform_int_distribution/discrete_distribution/shuffle
+// реализованы в каждой стандартной библиотеке по-своему, а сам mt19937 задан стандартом
+// бит-в-бит — поэтому выборку делаем сами, и при одном seed вывод совпадает между сборками.
+static int uniformInt(std::mt19937& rng, int lo, int hi)
+{
+    if (hi <= lo) return lo;
+    const std::uint32_t range = static_cast<std::uint32_t>(hi - lo) + 1u;
+    // Отбрасываем хвост, который не делится на range, чтобы не было смещения
+    const std::uint32_t limit = static_cast<std::uint32_t>(-range) % range;
+    std::uint32_t x = 0;
+    do {
+        x = static_cast<std::uint32_t>(rng());
+    } while (x < limit);
+    return lo + static_cast<int>(x % range);
+}
+
+// Значение из [lo, hi] с весом weightOf(v)
+template <typename WeightFn>
+static int weightedInt(std::mt19937& rng, int lo, int hi, WeightFn weightOf)
+{
+    int total = 0;
+    for (int v = lo; v <= hi; ++v) total += weightOf(v);
+    int r = uniformInt(rng, 0, total - 1);
+    for (int v = lo; v <= hi; ++v) {
+        r -= weightOf(v);
+        if (r < 0) return v;
+    }
+    return hi;
+}
+
 static std::string trimCopy(std::string s)
 {
     auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
@@ -120,14 +239,31 @@ static std::string trimCopy(std::string s)
 } 
 
 D1Randomizer::D1Randomizer(Database& db)
-    : db(db)
+    : D1Randomizer(db, static_cast<std::uint64_t>(
+          std::chrono::high_resolution_clock::now().time_since_epoch().count()))
 {
-    const auto seed = static_cast<std::uint32_t>(
-        std::chrono::high_resolution_clock::now().time_since_epoch().count());
-    rng.seed(seed);
 }
 
-std::vector<GradeRule> D1Randomizer::rules() const
+D1Randomizer::D1Randomizer(Database& db, std::uint64_t seed)
+    : db(db), seed(seed), ruleSet(defaultRules())
+{
+}
+
+void D1Randomizer::setRules(std::vector<GradeRule> rules)
+{
+    ruleSet = std::move(rules);
+}
+
+std::mt19937 D1Randomizer::streamFor(std::uint64_t seed, int semesterId, int studentId, std::uint64_t ruleKey)
+{
+    std::uint64_t h = splitMix64(seed);
+    h = splitMix64(h ^ static_cast<std::uint64_t>(semesterId));
+    h = splitMix64(h ^ static_cast<std::uint64_t>(studentId));
+    h = splitMix64(h ^ ruleKey);
+    return std::mt19937(static_cast<std::uint32_t>(h ^ (h >> 32)));
+}
+
+std::vector<GradeRule> D1Randomizer::defaultRules()
 {
     std::vector<GradeRule> r;
 
@@ -153,13 +289,12 @@ std::vector<GradeRule> D1Randomizer::rules() const
     return r;
 }
 
-int D1Randomizer::pickCount(const GradeRule& rule)
+int D1Randomizer::pickCount(std::mt19937& rng, const GradeRule& rule)
 {
     if (rule.minCount <= 0) return 0;
     if (rule.maxCount < rule.minCount) return rule.minCount;
 
-    std::uniform_int_distribution<int> dist(rule.minCount, rule.maxCount);
-    return dist(rng);
+    return uniformInt(rng, rule.minCount, rule.maxCount);
 }
 
 int D1Randomizer::clampGrade(int v)
@@ -169,7 +304,7 @@ int D1Randomizer::clampGrade(int v)
     return v;
 }
 
-int D1Randomizer::generateGradeValue(const GradeRule& rule)
+int D1Randomizer::generateGradeValue(std::mt19937& rng, const GradeRule& rule)
 {
     if (rule.fixedGrade.has_value()) {
         return clampGrade(*rule.fixedGrade);
@@ -181,63 +316,111 @@ int D1Randomizer::generateGradeValue(const GradeRule& rule)
 
     if (rule.bias == GradeBias::Often10) {
         if (hi >= 10 && lo <= 10) {
-            std::uniform_int_distribution<int> p(1, 100);
-            if (p(rng) <= 70) return 10;
+            if (uniformInt(rng, 1, 100) <= 70) return 10;
         }
-        std::uniform_int_distribution<int> dist(lo, hi);
-        return dist(rng);
+        return uniformInt(rng, lo, hi);
     }
 
     if (rule.bias == GradeBias::Often9_10) {
-        std::vector<int> values;
-        std::vector<int> weights;
-        for (int v = lo; v <= hi; ++v) {
-            values.push_back(v);
-            int w = 10;
-            if (v == 9 || v == 10) w = 35;
-            weights.push_back(w);
-        }
-        std::discrete_distribution<int> dist(weights.begin(), weights.end());
-        return values[dist(rng)];
+        return weightedInt(rng, lo, hi, [](int v) { return (v == 9 || v == 10) ? 35 : 10; });
     }
 
     if (rule.bias == GradeBias::OftenGE8) {
-        std::vector<int> values;
-        std::vector<int> weights;
-        for (int v = lo; v <= hi; ++v) {
-            values.push_back(v);
-            int w = (v >= 8) ? 25 : 10;
-            weights.push_back(w);
-        }
-        std::discrete_distribution<int> dist(weights.begin(), weights.end());
-        return values[dist(rng)];
+        return weightedInt(rng, lo, hi, [](int v) { return (v >= 8) ? 25 : 10; });
     }
 
-    std::uniform_int_distribution<int> dist(lo, hi);
-    return dist(rng);
+    return uniformInt(rng, lo, hi);
 }
 
-std::vector<std::string> D1Randomizer::pickRandomDistinct(
+std::vector<CivilDate> D1Randomizer::pickRandomDistinct(
     std::mt19937& rng,
-    const std::vector<std::string>& src,
+    const std::vector<CivilDate>& src,
     int count)
 {
     if (count <= 0 || src.empty()) return {};
 
-    std::vector<std::string> pool = src;
+    std::vector<CivilDate> pool = src;
     pool = uniqueSorted(std::move(pool));
 
     if (count >= static_cast<int>(pool.size())) {
         return pool;
     }
 
-    std::shuffle(pool.begin(), pool.end(), rng);
-    pool.resize(count);
+    // Частичный Фишер–Йейтс: первые count позиций — случайная выборка без повторов
+    const int n = static_cast<int>(pool.size());
+    for (int i = 0; i < count; ++i) {
+        const int j = uniformInt(rng, i, n - 1);
+        std::swap(pool[static_cast<size_t>(i)], pool[static_cast<size_t>(j)]);
+    }
+    pool.resize(static_cast<size_t>(count));
     pool = uniqueSorted(std::move(pool));
     return pool;
 }
 
-Result<std::vector<std::string>> D1Randomizer::collectLessonDatesForStudent(
+// Подготовленные INSERT/UPDATE для оценок: один раз на транзакцию генерации
+struct D1Randomizer::GradeWriter {
+    sqlite3* rawDb = nullptr;
+    sqlite3_stmt* insertStmt = nullptr;
+    sqlite3_stmt* updateStmt = nullptr;
+
+    static constexpr const char* kGradeType = "created by randomizer";
+
+    ~GradeWriter()
+    {
+        sqlite3_finalize(insertStmt);
+        sqlite3_finalize(updateStmt);
+    }
+
+    bool prepare(sqlite3* handle)
+    {
+        rawDb = handle;
+        const char* insertSql =
+            "INSERT INTO grades (studentid, subjectid, semesterid, value, date, gradetype) "
+            "VALUES (?, ?, ?, ?, ?, ?);";
+        const char* updateSql =
+            "UPDATE grades SET value = ?, gradetype = ? "
+            "WHERE studentid = ? AND subjectid = ? AND semesterid = ? AND date = ?;";
+
+        return sqlite3_prepare_v2(rawDb, insertSql, -1, &insertStmt, nullptr) == SQLITE_OK &&
+               sqlite3_prepare_v2(rawDb, updateSql, -1, &updateStmt, nullptr) == SQLITE_OK;
+    }
+
+    bool insert(int studentId, int subjectId, int semesterId, int value, CivilDate date)
+    {
+        char dateISO[CivilDate::kISOLength + 1];
+        date.formatISO(dateISO);
+
+        sqlite3_bind_int(insertStmt, 1, studentId);
+        sqlite3_bind_int(insertStmt, 2, subjectId);
+        sqlite3_bind_int(insertStmt, 3, semesterId);
+        sqlite3_bind_int(insertStmt, 4, value);
+        sqlite3_bind_text(insertStmt, 5, dateISO, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt, 6, kGradeType, -1, SQLITE_STATIC);
+
+        const int rc = sqlite3_step(insertStmt);
+        sqlite3_reset(insertStmt);
+        return rc == SQLITE_DONE;
+    }
+
+    bool update(int studentId, int subjectId, int semesterId, int value, CivilDate date)
+    {
+        char dateISO[CivilDate::kISOLength + 1];
+        date.formatISO(dateISO);
+
+        sqlite3_bind_int(updateStmt, 1, value);
+        sqlite3_bind_text(updateStmt, 2, kGradeType, -1, SQLITE_STATIC);
+        sqlite3_bind_int(updateStmt, 3, studentId);
+        sqlite3_bind_int(updateStmt, 4, subjectId);
+        sqlite3_bind_int(updateStmt, 5, semesterId);
+        sqlite3_bind_text(updateStmt, 6, dateISO, -1, SQLITE_TRANSIENT);
+
+        const int rc = sqlite3_step(updateStmt);
+        sqlite3_reset(updateStmt);
+        return rc == SQLITE_DONE;
+    }
+};
+
+Result<std::vector<CivilDate>> D1Randomizer::collectLessonDates(
     int groupId,
     int studentSubgroup,
     int subjectId,
@@ -245,128 +428,41 @@ Result<std::vector<std::string>> D1Randomizer::collectLessonDatesForStudent(
     int semesterId)
 {
     if (groupId <= 0) {
-        return Result<std::vector<std::string>>::Fail("groupId must be > 0");
+        return Result<std::vector<CivilDate>>::Fail("groupId must be > 0");
     }
-    if (studentSubgroup < 0 || studentSubgroup > 2) {
-        return Result<std::vector<std::string>>::Fail("studentSubgroup must be in [0..2]");
+    if (studentSubgroup < 0) {
+        return Result<std::vector<CivilDate>>::Fail("studentSubgroup must be >= 0");
     }
     if (subjectId <= 0) {
-        return Result<std::vector<std::string>>::Fail("subjectId must be > 0");
+        return Result<std::vector<CivilDate>>::Fail("subjectId must be > 0");
     }
     if (semesterId <= 0) {
-        return Result<std::vector<std::string>>::Fail("semesterId must be > 0");
+        return Result<std::vector<CivilDate>>::Fail("semesterId must be > 0");
     }
 
     const std::string ltype = trimCopy(lessonType);
     if (ltype.empty()) {
-        return Result<std::vector<std::string>>::Fail("lessonType is empty");
+        return Result<std::vector<CivilDate>>::Fail("lessonType is empty");
     }
 
-    sqlite3* rawDb = db.rawHandle();
-    if (!rawDb) {
-        return Result<std::vector<std::string>>::Fail("DB not connected");
+    std::vector<LessonOccurrence> occ;
+    if (!db.getLessonOccurrencesForGroup(groupId, studentSubgroup, subjectId, ltype, semesterId, occ)) {
+        return Result<std::vector<CivilDate>>::Fail("DB: getLessonOccurrencesForGroup failed");
     }
 
-    std::string semStart;
-    std::string semEnd;
-    if (!execGetSemesterDateRange(rawDb, semesterId, semStart, semEnd)) {
-        return Result<std::vector<std::string>>::Fail("DB: failed to load semester date range");
-    }
-
-    const bool filterBySemesterDates = (!semStart.empty() && !semEnd.empty());
-
-    std::vector<std::tuple<int, int, std::string, std::string>> weeks;
-    if (!db.getCycleWeeks(weeks)) {
-        return Result<std::vector<std::string>>::Fail("DB: getCycleWeeks failed");
-    }
-
-    std::vector<std::string> dates;
-
-    for (const auto& w : weeks) {
-        const int weekId = std::get<0>(w);
-        const int weekOfCycle = std::get<1>(w);
-        const std::string& weekStart = std::get<2>(w);
-        const std::string& weekEnd = std::get<3>(w);
-
-        if (filterBySemesterDates) {
-            if (!weekEnd.empty() && weekEnd < semStart) continue;
-            if (!weekStart.empty() && weekStart > semEnd) continue;
-        }
-
-        for (int weekday = 1; weekday <= 6; ++weekday) {
-            std::vector<std::tuple<int, int, int, std::string, std::string, std::string, std::string>> sched;
-            if (!db.getScheduleForGroup(groupId, weekday, weekOfCycle, sched)) {
-                return Result<std::vector<std::string>>::Fail("DB: getScheduleForGroup failed");
-            }
-
-            bool hasTargetLesson = false;
-            for (const auto& row : sched) {
-                const int subgroup = std::get<2>(row);
-                const std::string subjName = trimCopy(std::get<3>(row));
-                const std::string type = trimCopy(std::get<5>(row));
-
-                if (type != ltype) continue;
-
-                int sid = 0;
-                if (!db.getSubjectIdByName(subjName, sid)) {
-                    return Result<std::vector<std::string>>::Fail("DB: getSubjectIdByName failed");
-                }
-
-                if (sid != subjectId) continue;
-
-                if (!(subgroup == 0 || subgroup == studentSubgroup || studentSubgroup == 0)) {
-                    continue;
-                }
-
-                hasTargetLesson = true;
-                break;
-            }
-
-            if (!hasTargetLesson) continue;
-
-            std::string dateISO;
-            if (!db.getDateForWeekdayByWeekId(weekId, weekday, dateISO)) {
-                return Result<std::vector<std::string>>::Fail("DB: getDateForWeekdayByWeekId failed");
-            }
-            if (dateISO.empty()) continue;
-
-            if (filterBySemesterDates) {
-                if (dateISO < semStart || dateISO > semEnd) continue;
-            }
-
-            dates.push_back(std::move(dateISO));
-        }
+    std::vector<CivilDate> dates;
+    dates.reserve(occ.size());
+    for (const auto& o : occ) {
+        dates.push_back(o.lessonDate);
     }
 
-    dates = uniqueSorted(std::move(dates));
-    return Result<std::vector<std::string>>::Ok(std::move(dates));
+    dates = uniqueSortedFilteredNonEmpty(std::move(dates));
+    return Result<std::vector<CivilDate>>::Ok(std::move(dates));
 }
 
-Result<D1RandomizerStats> D1Randomizer::generateForGroup(int groupId, int semesterId, bool overwriteExisting)
+std::vector<D1Randomizer::ResolvedRule> D1Randomizer::resolveRules()
 {
-    if (groupId <= 0) {
-        return Result<D1RandomizerStats>::Fail("groupId must be > 0");
-    }
-    if (semesterId <= 0) {
-        return Result<D1RandomizerStats>::Fail("semesterId must be > 0");
-    }
-
-    sqlite3* rawDb = db.rawHandle();
-    if (!rawDb) {
-        return Result<D1RandomizerStats>::Fail("DB not connected");
-    }
-
-    std::vector<StudentRow> students;
-    if (!execGetStudentsOfGroupWithSubgroup(rawDb, groupId, students)) {
-        return Result<D1RandomizerStats>::Fail("DB: get students of group failed");
-    }
-
-    auto allRules = rules();
-
-    struct ResolvedRule {
-        GradeRule rule;
-        int subjectId = 0;
-    };
+    auto allRules = ruleSet;
 
     std::vector<ResolvedRule> resolved;
     resolved.reserve(allRules.size());
@@ -396,30 +492,132 @@ Result<D1RandomizerStats> D1Randomizer::generateForGroup(int groupId, int semest
             rule.fixedGrade = clampGrade(*rule.fixedGrade);
         }
 
-        resolved.push_back({rule, subjectId});
+        const std::uint64_t streamKey = fnv1a64(rule.subjectName + " " + rule.lessonType);
+        resolved.push_back({rule, subjectId, streamKey});
     }
 
-    D1RandomizerStats stats;
+    // Правила одного предмета видят оценки друг друга (общий счётчик existingCount),
+    // поэтому обходим их в фиксированном порядке, а не в порядке ruleSet
+    std::stable_sort(resolved.begin(), resolved.end(), [](const ResolvedRule& a, const ResolvedRule& b) {
+        return std::tie(a.rule.subjectName, a.rule.lessonType) < std::tie(b.rule.subjectName, b.rule.lessonType);
+    });
 
-    if (!execBegin(rawDb)) {
-        return Result<D1RandomizerStats>::Fail("DB: begin transaction failed");
+    return resolved;
+}
+
+// Всё, что нужно для генерации по одной паре (группа, семестр): читается из БД заранее,
+// дальше план строится без обращений к SQLite.
+struct D1Randomizer::GroupInput {
+    int groupId = 0;
+    int semesterId = 0;
+    std::vector<StudentRow> students;
+    ExistingGradeDates existing;
+    // (подгруппа, индекс в resolved) -> даты занятий по возрастанию
+    std::map<std::pair<int, size_t>, std::vector<CivilDate>> candidates;
+};
+
+struct D1Randomizer::GradeOp {
+    int studentId = 0;
+    int subjectId = 0;
+    int semesterId = 0;
+    int value = 0;
+    CivilDate date;
+    bool update = false;
+};
+
+struct D1Randomizer::GroupPlan {
+    std::vector<GradeOp> ops;
+    D1RandomizerStats stats;  // счётчики только этой группы
+    std::string log;          // SKIP-сообщения, печатаются из основного потока
+    Status status;
+};
+
+Status D1Randomizer::loadGroupInput(
+    int groupId,
+    int semesterId,
+    const std::vector<ResolvedRule>& resolved,
+    GroupInput& out,
+    D1RandomizerStats& stats)
+{
+    sqlite3* rawDb = db.rawHandle();
+    const auto loadStart = std::chrono::steady_clock::now();
+
+    out.groupId = groupId;
+    out.semesterId = semesterId;
+
+    if (!execGetStudentsOfGroupWithSubgroup(rawDb, groupId, out.students)) {
+        return Status::Fail("DB: get students of group failed");
     }
 
-    bool ok = true;
-    auto rollbackGuard = [&]() {
-        if (!ok) execRollback(rawDb);
-    };
+    if (!execLoadExistingGradeDates(rawDb, groupId, semesterId, out.existing)) {
+        return Status::Fail("DB: load existing grades failed");
+    }
+    for (auto& it : out.existing) {
+        it.second = uniqueSortedFilteredNonEmpty(std::move(it.second));
+    }
+
+    // Даты занятий зависят только от (подгруппа, правило) — по одному разу на группу
+    const auto candidatesStart = std::chrono::steady_clock::now();
+    std::vector<int> subgroups;
+    for (const auto& student : out.students) subgroups.push_back(student.subgroup);
+    std::sort(subgroups.begin(), subgroups.end());
+    subgroups.erase(std::unique(subgroups.begin(), subgroups.end()), subgroups.end());
+
+    for (int subgroup : subgroups) {
+        for (size_t ruleIndex = 0; ruleIndex < resolved.size(); ++ruleIndex) {
+            const auto& rr = resolved[ruleIndex];
+            if (rr.rule.lessonType == "ЛК" && !rr.rule.allowLecture) continue;
+
+            auto dates = collectLessonDates(groupId, subgroup, rr.subjectId, rr.rule.lessonType, semesterId);
+            if (!dates.ok) {
+                return Status::Fail("DB: getLessonOccurrencesForGroup failed");
+            }
+            out.candidates.emplace(std::make_pair(subgroup, ruleIndex), std::move(dates.value));
+        }
+    }
+    stats.timing.candidatesMs += elapsedMs(candidatesStart);
+
+    stats.timing.loadMs += elapsedMs(loadStart);
+    return Status::Ok();
+}
+
+void D1Randomizer::planGroup(
+    const GroupInput& input,
+    const std::vector<ResolvedRule>& resolved,
+    bool overwriteExisting,
+    std::uint64_t seed,
+    GroupPlan& out)
+{
+    auto& stats = out.stats;
+    std::ostringstream log;
+
+    // Копия: пополняется запланированными вставками, чтобы правила с тем же предметом
+    // (ЛК/ЛР одного дня) видели уже созданные оценки.
+    ExistingGradeDates existing = input.existing;
+
+    stats.groupRuns = 1;
 
-    for (const auto& student : students) {
+    // Ключи отчёта строятся один раз на группу; строка отчёта заводится при первом студенте
+    std::vector<std::string> ruleKeys;
+    ruleKeys.reserve(resolved.size());
+    for (const auto& rr : resolved) ruleKeys.push_back(rr.rule.subjectName + " " + rr.rule.lessonType);
+    std::vector<D1RandomizerStats::RuleReport*> reports(resolved.size(), nullptr);
+
+    for (const auto& student : input.students) {
         if (student.id <= 0) continue;
+        stats.studentsProcessed++;
 
-        for (const auto& rr : resolved) {
+        for (size_t ruleIndex = 0; ruleIndex < resolved.size(); ++ruleIndex) {
+            const auto& rr = resolved[ruleIndex];
             const auto& rule = rr.rule;
 
-            const std::string ruleKey = rule.subjectName + " " + rule.lessonType;
-            auto& report = stats.reportByRule[ruleKey];
+            std::mt19937 rng = streamFor(seed, input.semesterId, student.id, rr.streamKey);
+
+            const std::string& ruleKey = ruleKeys[ruleIndex];
+            if (!reports[ruleIndex]) reports[ruleIndex] = &stats.reportByRule[ruleKey];
+            auto& report = *reports[ruleIndex];
 
-            const int targetCount = pickCount(rule);
+            const int targetCount = pickCount(rng, rule);
             if (targetCount <= 0) continue;
 
             report.requestedGrades += targetCount;
@@ -427,60 +625,45 @@ Result<D1RandomizerStats> D1Randomizer::generateForGroup(int groupId, int semest
             if (rule.lessonType == "ЛК" && !rule.allowLecture) {
                 stats.skippedBecauseLectureForbidden++;
                 report.skippedNoCandidates += 1;
-                std::cerr << "[D1] SKIP: lecture forbidden for rule '" << ruleKey
-                          << "' studentId=" << student.id << "\n";
+                log << "[D1] SKIP: lecture forbidden for rule '" << ruleKey
+                    << "' studentId=" << student.id << "\n";
                 continue;
             }
 
-            std::vector<std::tuple<int, std::string, std::string>> existingGrades;
-            if (!db.getStudentSubjectGrades(student.id, rr.subjectId, semesterId, existingGrades)) {
-                ok = false;
-                rollbackGuard();
-                return Result<D1RandomizerStats>::Fail("DB: getStudentSubjectGrades failed");
-            }
-
-            std::vector<std::string> existingDates;
-            existingDates.reserve(existingGrades.size());
-            for (const auto& g : existingGrades) {
-                existingDates.push_back(std::get<1>(g));
-            }
-            existingDates = uniqueSortedFilteredNonEmpty(std::move(existingDates));
+            // Отсортирован и без повторов
+            std::vector<CivilDate>& existingDates = existing[{student.id, rr.subjectId}];
 
             const int existingCount = static_cast<int>(existingDates.size());
             int remainingToCreate = targetCount - existingCount;
             if (remainingToCreate < 0) remainingToCreate = 0;
 
-            std::vector<LessonOccurrence> occ;
-            if (!db.getLessonOccurrencesForStudent(student.id, rr.subjectId, rule.lessonType, semesterId, occ)) {
-                ok = false;
-                rollbackGuard();
-                return Result<D1RandomizerStats>::Fail("DB: getLessonOccurrencesForStudent failed");
-            }
-
-            std::vector<std::string> candidateDates;
-            candidateDates.reserve(occ.size());
-            for (const auto& o : occ) {
-                candidateDates.push_back(o.lessonDateISO);
-            }
-            candidateDates = uniqueSortedFilteredNonEmpty(std::move(candidateDates));
+            const auto candIt = input.candidates.find({student.subgroup, ruleIndex});
+            std::vector<CivilDate> candidateDates;
+            if (candIt != input.candidates.end()) candidateDates = candIt->second;
 
             report.candidatesFound += static_cast<int>(candidateDates.size());
             if (candidateDates.empty()) {
                 report.skippedNoCandidates += 1;
-                std::cerr << "[D1] SKIP: no real lesson dates for rule '" << ruleKey
-                          << "' studentId=" << student.id << "\n";
+                log << "[D1] SKIP: no real lesson dates for rule '" << ruleKey
+                    << "' studentId=" << student.id << "\n";
                 continue;
             }
 
-            if (!overwriteExisting) {
-                std::unordered_set<std::string> existingSet(existingDates.begin(), existingDates.end());
-                candidateDates.erase(
-                    std::remove_if(candidateDates.begin(), candidateDates.end(), [&](const std::string& d) {
-                        return existingSet.find(d) != existingSet.end();
-                    }),
-                    candidateDates.end()
-                );
-            }
+            // Оценки, которые были в БД до запуска; остальное в existingDates запланировали
+            // предыдущие правила того же предмета, и перезаписывать их нельзя
+            const auto snapshotIt = input.existing.find({student.id, rr.subjectId});
+            auto inSnapshot = [&](CivilDate d) {
+                return snapshotIt != input.existing.end() &&
+                       std::binary_search(snapshotIt->second.begin(), snapshotIt->second.end(), d);
+            };
+
+            candidateDates.erase(
+                std::remove_if(candidateDates.begin(), candidateDates.end(), [&](CivilDate d) {
+                    if (!std::binary_search(existingDates.begin(), existingDates.end(), d)) return false;
+                    return !overwriteExisting || !inSnapshot(d);
+                }),
+                candidateDates.end()
+            );
 
             int toPick = overwriteExisting ? targetCount : remainingToCreate;
             if (toPick <= 0) {
@@ -488,38 +671,27 @@ Result<D1RandomizerStats> D1Randomizer::generateForGroup(int groupId, int semest
             }
 
             const auto pickedDates = pickRandomDistinct(rng, candidateDates, toPick);
-            if (pickedDates.empty()) continue;
 
-#ifndef NDEBUG
-            std::unordered_set<std::string> candidatesSet(candidateDates.begin(), candidateDates.end());
-#endif
-
-            for (const auto& dateISO : pickedDates) {
-                if (dateISO.empty()) continue;
+            for (const CivilDate date : pickedDates) {
+                if (date.isNull()) continue;
 
 #ifndef NDEBUG
-                if (candidatesSet.find(dateISO) == candidatesSet.end()) {
-                    ok = false;
-                    rollbackGuard();
-                    return Result<D1RandomizerStats>::Fail("Internal: picked date not in candidates");
+                if (!std::binary_search(candidateDates.begin(), candidateDates.end(), date)) {
+                    out.status = Status::Fail("Internal: picked date not in candidates");
+                    return;
                 }
 #endif
 
-                const int value = generateGradeValue(rule);
+                const int value = generateGradeValue(rng, rule);
                 if (value < 0 || value > 10) {
-                    ok = false;
-                    rollbackGuard();
-                    return Result<D1RandomizerStats>::Fail("Internal: generated grade out of [0..10]");
+                    out.status = Status::Fail("Internal: generated grade out of [0..10]");
+                    return;
                 }
 
-                int existingId = 0;
-                if (!db.findGradeId(student.id, rr.subjectId, semesterId, dateISO, existingId)) {
-                    ok = false;
-                    rollbackGuard();
-                    return Result<D1RandomizerStats>::Fail("DB: findGradeId failed");
-                }
+                const auto existingPos = std::lower_bound(existingDates.begin(), existingDates.end(), date);
+                const bool exists = existingPos != existingDates.end() && *existingPos == date;
 
-                if (existingId > 0 && !overwriteExisting) {
+                if (exists && !overwriteExisting) {
                     stats.skippedExistingTotal++;
                     report.skippedExisting += 1;
                     continue;
@@ -529,22 +701,17 @@ Result<D1RandomizerStats> D1Randomizer::generateForGroup(int groupId, int semest
                     continue;
                 }
 
-                if (overwriteExisting && existingId <= 0 && existingCount >= targetCount) {
+                if (overwriteExisting && !exists && existingCount >= targetCount) {
                     continue;
                 }
 
-                const std::string gradeType = "created by randomizer";
-                const bool writeOk = db.upsertGradeByKey(student.id, rr.subjectId, semesterId, value, dateISO, gradeType);
-                if (!writeOk) {
-                    ok = false;
-                    rollbackGuard();
-                    return Result<D1RandomizerStats>::Fail("DB: upsertGradeByKey failed");
-                }
+                out.ops.push_back({student.id, rr.subjectId, input.semesterId, value, date, exists});
 
-                if (existingId > 0) {
+                if (exists) {
                     stats.updatedExistingTotal++;
                     report.updated += 1;
                 } else {
+                    existingDates.insert(existingPos, date);
                     stats.createdTotal++;
                     report.created += 1;
                     stats.createdBySubject[rule.subjectName] += 1;
@@ -556,24 +723,280 @@ Result<D1RandomizerStats> D1Randomizer::generateForGroup(int groupId, int semest
         }
     }
 
-    std::cerr << "[D1] Report: skippedBecauseLectureForbidden=" << stats.skippedBecauseLectureForbidden << "\n";
-    for (const auto& it : stats.reportByRule) {
-        const auto& key = it.first;
-        const auto& rep = it.second;
-        std::cerr << "[D1] Rule '" << key << "': candidatesFound=" << rep.candidatesFound
-                  << " requestedGrades=" << rep.requestedGrades
-                  << " created=" << rep.created
-                  << " updated=" << rep.updated
-                  << " skippedExisting=" << rep.skippedExisting
-                  << " skippedNoCandidates=" << rep.skippedNoCandidates
-                  << "\n";
+    out.log = log.str();
+    out.status = Status::Ok();
+}
+
+Status D1Randomizer::writePlan(const GroupPlan& plan, GradeWriter& writer)
+{
+    for (const auto& op : plan.ops) {
+        const bool ok = op.update
+            ? writer.update(op.studentId, op.subjectId, op.semesterId, op.value, op.date)
+            : writer.insert(op.studentId, op.subjectId, op.semesterId, op.value, op.date);
+        if (!ok) {
+            return Status::Fail(op.update ? "DB: update grade failed" : "DB: insert grade failed");
+        }
     }
+    return Status::Ok();
+}
 
-    ok = execCommit(rawDb);
-    if (!ok) {
-        rollbackGuard();
+void D1Randomizer::mergePlanStats(const GroupPlan& plan, D1RandomizerStats& stats)
+{
+    const auto& part = plan.stats;
+
+    for (const auto& it : part.createdBySubject) {
+        stats.createdBySubject[it.first] += it.second;
+    }
+    stats.createdTotal += part.createdTotal;
+    stats.skippedExistingTotal += part.skippedExistingTotal;
+    stats.updatedExistingTotal += part.updatedExistingTotal;
+
+    for (const auto& it : part.reportByRule) {
+        auto& dst = stats.reportByRule[it.first];
+        dst.candidatesFound += it.second.candidatesFound;
+        dst.requestedGrades += it.second.requestedGrades;
+        dst.created += it.second.created;
+        dst.updated += it.second.updated;
+        dst.skippedExisting += it.second.skippedExisting;
+        dst.skippedNoCandidates += it.second.skippedNoCandidates;
+    }
+    stats.skippedBecauseLectureForbidden += part.skippedBecauseLectureForbidden;
+
+    stats.groupRuns += part.groupRuns;
+    stats.studentsProcessed += part.studentsProcessed;
+
+    if (!plan.log.empty()) std::cerr << plan.log;
+}
+
+Result<D1RandomizerStats> D1Randomizer::generateForGroup(int groupId, int semesterId, bool overwriteExisting)
+{
+    if (groupId <= 0) {
+        return Result<D1RandomizerStats>::Fail("groupId must be > 0");
+    }
+    if (semesterId <= 0) {
+        return Result<D1RandomizerStats>::Fail("semesterId must be > 0");
+    }
+
+    return generateForGroups({groupId}, {semesterId}, overwriteExisting);
+}
+
+Result<D1RandomizerStats> D1Randomizer::generateForAllGroups(bool overwriteExisting, int threadCount)
+{
+    sqlite3* rawDb = db.rawHandle();
+    if (!rawDb) {
+        return Result<D1RandomizerStats>::Fail("DB not connected");
+    }
+
+    std::vector<int> groupIds;
+    if (!execGetGroupsWithStudents(rawDb, groupIds)) {
+        return Result<D1RandomizerStats>::Fail("DB: get groups failed");
+    }
+
+    std::vector<std::pair<int, std::string>> semesters;
+    if (!db.getAllSemesters(semesters)) {
+        return Result<D1RandomizerStats>::Fail("DB: getAllSemesters failed");
+    }
+
+    std::vector<int> semesterIds;
+    semesterIds.reserve(semesters.size());
+    for (const auto& s : semesters) {
+        if (s.first > 0) semesterIds.push_back(s.first);
+    }
+
+    return generateForGroups(groupIds, semesterIds, overwriteExisting, threadCount);
+}
+
+Result<D1RandomizerStats> D1Randomizer::generateForGroups(
+    const std::vector<int>& groupIds,
+    const std::vector<int>& semesterIds,
+    bool overwriteExisting,
+    int threadCount)
+{
+    const auto totalStart = std::chrono::steady_clock::now();
+
+    sqlite3* rawDb = db.rawHandle();
+    if (!rawDb) {
+        return Result<D1RandomizerStats>::Fail("DB not connected");
+    }
+
+    for (int groupId : groupIds) {
+        if (groupId <= 0) return Result<D1RandomizerStats>::Fail("groupId must be > 0");
+    }
+    for (int semesterId : semesterIds) {
+        if (semesterId <= 0) return Result<D1RandomizerStats>::Fail("semesterId must be > 0");
+    }
+
+    std::vector<std::pair<int, int>> jobs;  // (groupId, semesterId)
+    jobs.reserve(groupIds.size() * semesterIds.size());
+    for (int semesterId : semesterIds) {
+        for (int groupId : groupIds) {
+            jobs.emplace_back(groupId, semesterId);
+        }
+    }
+
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    threadCount = std::max(1, std::min(threadCount, static_cast<int>(jobs.size())));
+
+    const auto resolved = resolveRules();
+
+    D1RandomizerStats stats;
+    stats.threadsUsed = threadCount;
+    stats.seed = seed;
+
+    if (!execBegin(rawDb)) {
+        return Result<D1RandomizerStats>::Fail("DB: begin transaction failed");
+    }
+
+    Status st = Status::Ok();
+    {
+        GradeWriter writer;
+        if (!writer.prepare(rawDb)) {
+            execRollback(rawDb);
+            return Result<D1RandomizerStats>::Fail("DB: prepare grade statements failed");
+        }
+
+        if (threadCount == 1) {
+            // Последовательно: загрузка -> план -> запись для каждой группы
+            for (const auto& job : jobs) {
+                GroupInput input;
+                st = loadGroupInput(job.first, job.second, resolved, input, stats);
+                if (!st.ok) break;
+
+                GroupPlan plan;
+                const auto planStart = std::chrono::steady_clock::now();
+                planGroup(input, resolved, overwriteExisting, seed, plan);
+                stats.timing.planMs += elapsedMs(planStart);
+                if (!plan.status.ok) {
+                    st = plan.status;
+                    break;
+                }
+
+                const auto writeStart = std::chrono::steady_clock::now();
+                st = writePlan(plan, writer);
+                stats.timing.writeMs += elapsedMs(writeStart);
+                if (!st.ok) break;
+
+                mergePlanStats(plan, stats);
+            }
+        } else {
+            st = runParallel(jobs, resolved, overwriteExisting, threadCount, writer, stats);
+        }
+    }
+
+    if (!st.ok) {
+        execRollback(rawDb);
+        return Result<D1RandomizerStats>::Fail(st.error);
+    }
+
+    if (!execCommit(rawDb)) {
+        execRollback(rawDb);
         return Result<D1RandomizerStats>::Fail("DB: commit transaction failed");
     }
 
+    stats.timing.totalMs = elapsedMs(totalStart);
+    const int rowsWritten = stats.createdTotal + stats.updatedExistingTotal;
+    if (stats.timing.totalMs > 0.0) {
+        stats.timing.rowsPerSec = rowsWritten * 1000.0 / stats.timing.totalMs;
+    }
+    printReport(stats);
+
     return Result<D1RandomizerStats>::Ok(std::move(stats));
 }
+
+Status D1Randomizer::runParallel(
+    const std::vector<std::pair<int, int>>& jobs,
+    const std::vector<ResolvedRule>& resolved,
+    bool overwriteExisting,
+    int threadCount,
+    GradeWriter& writer,
+    D1RandomizerStats& stats)
+{
+    // Чтение и запись — в этом потоке (владелец соединения), планы строят worker'ы.
+    // Вперёд загружается не больше window групп: пока worker'ы планируют группу i,
+    // здесь читается группа i + k, и память не растёт с общим числом групп.
+    const size_t window = static_cast<size_t>(threadCount) * 2;
+    std::vector<GroupInput> inputs(jobs.size());
+    std::vector<GroupPlan> plans(jobs.size());
+    std::vector<char> ready(jobs.size(), 0);
+    size_t loaded = 0;   // inputs[0, loaded) можно планировать
+    size_t nextJob = 0;
+    bool stop = false;
+    long long planMicros = 0;
+    std::mutex mutex;
+    std::condition_variable jobCv;    // worker'ы ждут загруженную группу
+    std::condition_variable readyCv;  // этот поток ждёт план очередной группы
+
+    auto worker = [&]() {
+        for (;;) {
+            size_t i = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobCv.wait(lock, [&] { return stop || nextJob < loaded || nextJob >= jobs.size(); });
+                if (stop || nextJob >= jobs.size()) return;
+                i = nextJob++;
+            }
+
+            const auto started = std::chrono::steady_clock::now();
+            planGroup(inputs[i], resolved, overwriteExisting, seed, plans[i]);
+            const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started).count();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                planMicros += micros;
+                ready[i] = 1;
+            }
+            readyCv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(threadCount));
+    for (int t = 0; t < threadCount; ++t) workers.emplace_back(worker);
+
+    Status st = Status::Ok();
+    size_t loadedHere = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        while (loadedHere < jobs.size() && loadedHere < i + window) {
+            st = loadGroupInput(jobs[loadedHere].first, jobs[loadedHere].second, resolved, inputs[loadedHere], stats);
+            if (!st.ok) break;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                loaded = ++loadedHere;
+            }
+            jobCv.notify_one();
+        }
+        if (!st.ok) break;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            readyCv.wait(lock, [&] { return ready[i] != 0; });
+        }
+        if (!plans[i].status.ok) {
+            st = plans[i].status;
+            break;
+        }
+
+        const auto writeStart = std::chrono::steady_clock::now();
+        st = writePlan(plans[i], writer);
+        stats.timing.writeMs += elapsedMs(writeStart);
+        if (!st.ok) break;
+
+        mergePlanStats(plans[i], stats);
+        // Освобождаем память уже записанной группы
+        plans[i] = GroupPlan();
+        inputs[i] = GroupInput();
+    }
+
+    // При ошибке worker'ы доделывают текущие группы и выходят, не беря новых
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    jobCv.notify_all();
+    for (auto& t : workers) t.join();
+
+    stats.timing.planMs += static_cast<double>(planMicros) / 1000.0;
+    return st;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/civil_date.h"
 #include "core/result.h"
 #include "database.h"
 
@@ -52,34 +53,117 @@ struct D1RandomizerStats {
 
     std::map<std::string, RuleReport> reportByRule;
     int skippedBecauseLectureForbidden = 0;
+
+    int groupRuns = 0;          // обработано пар (группа, семестр)
+    int studentsProcessed = 0;
+    int threadsUsed = 1;
+    std::uint64_t seed = 0;     // с каким seed шла генерация (для воспроизведения)
+
+    // Время этапов генерации, мс
+    struct Timing {
+        double loadMs = 0.0;        // студенты и существующие оценки
+        double candidatesMs = 0.0;  // развёртка дат занятий по расписанию
+        double planMs = 0.0;        // выбор дат и значений (сумма по потокам)
+        double writeMs = 0.0;       // INSERT/UPDATE оценок
+        double totalMs = 0.0;       // весь вызов, включая COMMIT
+        double rowsPerSec = 0.0;    // (создано + обновлено) / totalMs
+    };
+    Timing timing;
 };
 
 class D1Randomizer {
 public:
+    // seed берётся из часов; для воспроизводимых прогонов — второй конструктор
     explicit D1Randomizer(Database& db);
+    D1Randomizer(Database& db, std::uint64_t seed);
+
+    [[nodiscard]] std::uint64_t seedValue() const { return seed; }
+
+    // Встроенный набор правил; setRules() заменяет его для следующих вызовов generate*
+    [[nodiscard]] static std::vector<GradeRule> defaultRules();
+    void setRules(std::vector<GradeRule> rules);
 
     [[nodiscard]] Result<D1RandomizerStats> generateForGroup(int groupId, int semesterId, bool overwriteExisting);
 
+    // Несколько групп × семестров одной транзакцией.
+    // threadCount: 1 — в вызывающем потоке, 0 — по числу ядер, N — N worker'ов строят планы,
+    // а вызывающий поток читает группы (не больше 2N вперёд) и пишет планы по порядку.
+    // Результат не зависит от threadCount и порядка групп: у каждой тройки
+    // (семестр, студент, правило) свой поток ГПСЧ, выведенный из seed.
+    // Правила одного предмета (ВМиКА ЛК/ЛР, БЖЧ ПЗ/ЛР, БД ЛР/ПЗ) делят счётчик оценок
+    // студента по предмету и видят даты, запланированные друг другом; их обход идёт
+    // в порядке (предмет, тип занятия), поэтому порядок правил в наборе тоже не важен.
+    // Даты, запланированные в этом же запуске, не перезаписываются и при overwriteExisting.
+    [[nodiscard]] Result<D1RandomizerStats> generateForGroups(
+        const std::vector<int>& groupIds,
+        const std::vector<int>& semesterIds,
+        bool overwriteExisting,
+        int threadCount = 1);
+
+    // Все группы со студентами × все семестры одной транзакцией
+    [[nodiscard]] Result<D1RandomizerStats> generateForAllGroups(bool overwriteExisting, int threadCount = 1);
+
 private:
+    struct ResolvedRule {
+        GradeRule rule;
+        int subjectId = 0;
+        std::uint64_t streamKey = 0;  // хэш "предмет тип", не зависит от порядка правил
+    };
+
+    struct GroupInput;
+    struct GroupPlan;
+    struct GradeOp;
+    struct GradeWriter;
+
     Database& db;
-    std::mt19937 rng;
+    std::uint64_t seed = 0;
+    std::vector<GradeRule> ruleSet;
 
-    [[nodiscard]] std::vector<GradeRule> rules() const;
+    [[nodiscard]] std::vector<ResolvedRule> resolveRules();
 
-    [[nodiscard]] int pickCount(const GradeRule& rule);
-    [[nodiscard]] int generateGradeValue(const GradeRule& rule);
+    [[nodiscard]] Status loadGroupInput(
+        int groupId,
+        int semesterId,
+        const std::vector<ResolvedRule>& resolved,
+        GroupInput& out,
+        D1RandomizerStats& stats);
+
+    [[nodiscard]] Status runParallel(
+        const std::vector<std::pair<int, int>>& jobs,
+        const std::vector<ResolvedRule>& resolved,
+        bool overwriteExisting,
+        int threadCount,
+        GradeWriter& writer,
+        D1RandomizerStats& stats);
+
+    // Без обращений к БД — безопасно вызывать из нескольких потоков
+    static void planGroup(
+        const GroupInput& input,
+        const std::vector<ResolvedRule>& resolved,
+        bool overwriteExisting,
+        std::uint64_t seed,
+        GroupPlan& out);
+
+    [[nodiscard]] static Status writePlan(const GroupPlan& plan, GradeWriter& writer);
+    static void mergePlanStats(const GroupPlan& plan, D1RandomizerStats& stats);
+
+    [[nodiscard]] static std::mt19937 streamFor(std::uint64_t seed, int semesterId, int studentId, std::uint64_t ruleKey);
+
+    [[nodiscard]] static int pickCount(std::mt19937& rng, const GradeRule& rule);
+    [[nodiscard]] static int generateGradeValue(std::mt19937& rng, const GradeRule& rule);
 
     [[nodiscard]] static int clampGrade(int v);
 
-    [[nodiscard]] Result<std::vector<std::string>> collectLessonDatesForStudent(
+    // Даты занятий (subject, lessonType) для подгруппы группы в семестре, по возрастанию
+    [[nodiscard]] Result<std::vector<CivilDate>> collectLessonDates(
         int groupId,
         int studentSubgroup,
         int subjectId,
         const std::string& lessonType,
         int semesterId);
 
-    [[nodiscard]] static std::vector<std::string> pickRandomDistinct(
+    [[nodiscard]] static std::vector<CivilDate> pickRandomDistinct(
         std::mt19937& rng,
-        const std::vector<std::string>& src,
+        const std::vector<CivilDate>& src,
         int count);
 };
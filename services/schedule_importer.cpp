@@ -0,0 +1,683 @@
+#include "services/schedule_importer.h"
+
+#include "core/lesson_slot_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+const char* const ScheduleImporter::kScheduleColumns[9] = {
+    "groupid", "subgroup", "weekday", "lessonnumber", "weekofcycle",
+    "subjectid", "teacherid", "room", "lessontype"
+};
+
+namespace {
+
+constexpr int kColumnCount = 9;
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+}
+
+bool startsWithNoCase(std::string_view s, std::string_view prefix)
+{
+    if (s.size() < prefix.size()) return false;
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(s[i])) != std::tolower(static_cast<unsigned char>(prefix[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string lowerAscii(std::string_view s)
+{
+    std::string out(s);
+    for (char& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+bool parseInt(std::string_view s, int& out)
+{
+    s = trim(s);
+    if (s.empty()) return false;
+    const auto res = std::from_chars(s.data(), s.data() + s.size(), out);
+    return res.ec == std::errc() && res.ptr == s.data() + s.size();
+}
+
+std::string lineError(int line, const std::string& what)
+{
+    return std::to_string(line) + ": " + what;
+}
+
+// Поля строки в порядке kScheduleColumns -> ScheduleImportRow
+bool fillRow(const std::vector<std::string>& fields, int line, ScheduleImportRow& row, std::string& error)
+{
+    if (fields.size() != kColumnCount) {
+        error = lineError(line, "expected " + std::to_string(kColumnCount) + " fields, got " +
+                                    std::to_string(fields.size()));
+        return false;
+    }
+
+    int* ints[7] = {&row.groupId, &row.subgroup, &row.weekday, &row.lessonNumber,
+                    &row.weekOfCycle, &row.subjectId, &row.teacherId};
+    for (int i = 0; i < 7; ++i) {
+        if (!parseInt(fields[i], *ints[i])) {
+            error = lineError(line, std::string("bad ") + ScheduleImporter::kScheduleColumns[i] +
+                                        " '" + fields[i] + "'");
+            return false;
+        }
+    }
+    row.room = std::string(trim(fields[7]));
+    row.lessonType = std::string(trim(fields[8]));
+    row.line = line;
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    out = buffer.str();
+    return true;
+}
+
+std::string extensionOf(const std::string& path)
+{
+    const size_t dot = path.find_last_of('.');
+    const size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return {};
+    return lowerAscii(std::string_view(path).substr(dot + 1));
+}
+
+// Список в скобках, начиная с text[pos] == '('. Значения — числа или строки в '...'
+// ('' внутри строки — кавычка). pos сдвигается за ')'.
+bool parseTuple(std::string_view text, size_t& pos, std::vector<std::string>& out, std::string& error)
+{
+    out.clear();
+    if (pos >= text.size() || text[pos] != '(') {
+        error = "expected '('";
+        return false;
+    }
+    ++pos;
+
+    std::string current;
+    bool quoted = false;
+    bool wasQuoted = false;
+    while (pos < text.size()) {
+        const char c = text[pos++];
+        if (quoted) {
+            if (c == '\'') {
+                if (pos < text.size() && text[pos] == '\'') {
+                    current += '\'';
+                    ++pos;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                current += c;
+            }
+            continue;
+        }
+
+        if (c == '\'') {
+            quoted = true;
+            wasQuoted = true;
+        } else if (c == ',' || c == ')') {
+            out.push_back(wasQuoted ? current : std::string(trim(current)));
+            current.clear();
+            wasQuoted = false;
+            if (c == ')') return true;
+        } else if (!wasQuoted) {
+            current += c;
+        } else if (!std::isspace(static_cast<unsigned char>(c))) {
+            error = "unexpected text after string";
+            return false;
+        }
+    }
+
+    error = quoted ? "unterminated string" : "expected ')'";
+    return false;
+}
+
+} // namespace
+
+struct ScheduleImporter::References {
+    std::unordered_set<int> groups;
+    std::unordered_set<int> subjects;
+    std::unordered_set<int> teachers;
+};
+
+ScheduleImporter::ScheduleImporter(Database& db)
+    : db(db)
+{
+}
+
+Result<std::vector<ScheduleImportRow>> ScheduleImporter::parseDelimited(const std::string& text, char delimiter)
+{
+    std::vector<ScheduleImportRow> rows;
+    rows.reserve(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+
+    std::vector<std::string> fields;
+    fields.reserve(kColumnCount);
+    std::string error;
+
+    size_t start = 0;
+    int line = 0;
+    bool firstData = true;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        std::string_view view = std::string_view(text).substr(start, end - start);
+        start = end + 1;
+        ++line;
+
+        if (!view.empty() && view.back() == '\r') view.remove_suffix(1);
+        if (line == 1 && view.size() >= 3 && std::memcmp(view.data(), "\xEF\xBB\xBF", 3) == 0) {
+            view.remove_prefix(3);  // BOM
+        }
+        const std::string_view trimmed = trim(view);
+        if (trimmed.empty() || trimmed.front() == '#') continue;
+
+        // Заголовок: первая непустая строка, начинающаяся с имени первой колонки
+        if (firstData) {
+            firstData = false;
+            if (startsWithNoCase(trimmed, kScheduleColumns[0])) continue;
+        }
+
+        fields.clear();
+        size_t fieldStart = 0;
+        while (true) {
+            const size_t sep = view.find(delimiter, fieldStart);
+            if (sep == std::string_view::npos) {
+                fields.emplace_back(view.substr(fieldStart));
+                break;
+            }
+            fields.emplace_back(view.substr(fieldStart, sep - fieldStart));
+            fieldStart = sep + 1;
+        }
+
+        ScheduleImportRow row;
+        if (!fillRow(fields, line, row, error)) return Result<std::vector<ScheduleImportRow>>::Fail(error);
+        rows.push_back(std::move(row));
+    }
+
+    return Result<std::vector<ScheduleImportRow>>::Ok(std::move(rows));
+}
+
+Result<std::vector<ScheduleImportRow>> ScheduleImporter::parseSqlScript(const std::string& text)
+{
+    std::vector<ScheduleImportRow> rows;
+    std::vector<std::string> columns;
+    std::vector<std::string> values;
+    std::vector<std::string> ordered(kColumnCount);
+    std::string error;
+
+    size_t start = 0;
+    int line = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        std::string_view view = trim(std::string_view(text).substr(start, end - start));
+        start = end + 1;
+        ++line;
+
+        if (view.empty() || view.substr(0, 2) == "--") continue;
+        if (!startsWithNoCase(view, "INSERT INTO schedule")) {
+            return Result<std::vector<ScheduleImportRow>>::Fail(
+                lineError(line, "only 'INSERT INTO schedule ... VALUES (...);' lines are supported"));
+        }
+
+        // (col, col, ...) VALUES (v, v, ...)[, (...)];
+        size_t pos = std::strlen("INSERT INTO schedule");
+        while (pos < view.size() && std::isspace(static_cast<unsigned char>(view[pos]))) ++pos;
+        if (!parseTuple(view, pos, columns, error)) {
+            return Result<std::vector<ScheduleImportRow>>::Fail(lineError(line, "column list: " + error));
+        }
+
+        // Позиция каждой колонки kScheduleColumns в списке INSERT
+        int columnIndex[kColumnCount];
+        if (columns.size() != kColumnCount) {
+            return Result<std::vector<ScheduleImportRow>>::Fail(
+                lineError(line, "expected " + std::to_string(kColumnCount) + " columns"));
+        }
+        for (int i = 0; i < kColumnCount; ++i) {
+            columnIndex[i] = -1;
+            for (int j = 0; j < kColumnCount; ++j) {
+                if (lowerAscii(columns[j]) == kScheduleColumns[i]) columnIndex[i] = j;
+            }
+            if (columnIndex[i] < 0) {
+                return Result<std::vector<ScheduleImportRow>>::Fail(
+                    lineError(line, std::string("missing column ") + kScheduleColumns[i]));
+            }
+        }
+
+        while (pos < view.size() && std::isspace(static_cast<unsigned char>(view[pos]))) ++pos;
+        if (!startsWithNoCase(view.substr(pos), "VALUES")) {
+            return Result<std::vector<ScheduleImportRow>>::Fail(lineError(line, "expected VALUES"));
+        }
+        pos += std::strlen("VALUES");
+
+        while (true) {
+            while (pos < view.size() && std::isspace(static_cast<unsigned char>(view[pos]))) ++pos;
+            if (!parseTuple(view, pos, values, error)) {
+                return Result<std::vector<ScheduleImportRow>>::Fail(lineError(line, "values: " + error));
+            }
+            if (values.size() != kColumnCount) {
+                return Result<std::vector<ScheduleImportRow>>::Fail(
+                    lineError(line, "values count does not match columns"));
+            }
+            for (int i = 0; i < kColumnCount; ++i) ordered[i] = std::move(values[columnIndex[i]]);
+
+            ScheduleImportRow row;
+            if (!fillRow(ordered, line, row, error)) return Result<std::vector<ScheduleImportRow>>::Fail(error);
+            rows.push_back(std::move(row));
+
+            while (pos < view.size() && std::isspace(static_cast<unsigned char>(view[pos]))) ++pos;
+            if (pos < view.size() && view[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            break;
+        }
+
+        if (trim(view.substr(pos)) != ";") {
+            return Result<std::vector<ScheduleImportRow>>::Fail(lineError(line, "expected ';' at end of line"));
+        }
+    }
+
+    return Result<std::vector<ScheduleImportRow>>::Ok(std::move(rows));
+}
+
+Result<std::vector<ScheduleImportRow>> ScheduleImporter::parseFile(const std::string& path)
+{
+    std::string text;
+    if (!readFile(path, text)) return Result<std::vector<ScheduleImportRow>>::Fail(path + ": cannot open file");
+
+    const std::string ext = extensionOf(path);
+    Result<std::vector<ScheduleImportRow>> parsed;
+    if (ext == "sql") parsed = parseSqlScript(text);
+    else if (ext == "tsv" || ext == "txt") parsed = parseDelimited(text, '\t');
+    else if (ext == "csv") parsed = parseDelimited(text, ',');
+    else return Result<std::vector<ScheduleImportRow>>::Fail(path + ": unknown format (expected .sql, .tsv or .csv)");
+
+    if (!parsed.ok) parsed.error = path + ":" + parsed.error;
+    return parsed;
+}
+
+std::string ScheduleImporter::toTsv(const std::vector<ScheduleImportRow>& rows)
+{
+    std::string out;
+    out.reserve(64 + rows.size() * 48);
+    for (int i = 0; i < kColumnCount; ++i) {
+        if (i) out += '\t';
+        out += kScheduleColumns[i];
+    }
+    out += '\n';
+
+    for (const auto& r : rows) {
+        const int ints[7] = {r.groupId, r.subgroup, r.weekday, r.lessonNumber,
+                             r.weekOfCycle, r.subjectId, r.teacherId};
+        for (int v : ints) {
+            out += std::to_string(v);
+            out += '\t';
+        }
+        out += r.room;
+        out += '\t';
+        out += r.lessonType;
+        out += '\n';
+    }
+    return out;
+}
+
+Status ScheduleImporter::loadReferences(References& out)
+{
+    struct Source {
+        const char* sql;
+        std::unordered_set<int>* ids;
+    };
+    const Source sources[] = {
+        {"SELECT id FROM groups;", &out.groups},
+        {"SELECT id FROM subjects;", &out.subjects},
+        {"SELECT id FROM users WHERE role = 'teacher';", &out.teachers},
+    };
+
+    for (const auto& src : sources) {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db.rawHandle(), src.sql, -1, &stmt, nullptr) != SQLITE_OK) {
+            return Status::Fail(std::string("prepare references: ") + sqlite3_errmsg(db.rawHandle()));
+        }
+        int rc = SQLITE_OK;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) src.ids->insert(sqlite3_column_int(stmt, 0));
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) {
+            return Status::Fail(std::string("read references: ") + sqlite3_errmsg(db.rawHandle()));
+        }
+    }
+
+    // Строки уже в таблице нумеруют дни с 1 — дописывать 0..5 к ним нельзя
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db.rawHandle(), "SELECT MIN(weekday) FROM schedule;", -1, &stmt, nullptr) != SQLITE_OK) {
+        return Status::Fail(std::string("prepare references: ") + sqlite3_errmsg(db.rawHandle()));
+    }
+    const bool oneBased = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL &&
+                          sqlite3_column_int(stmt, 0) > 0;
+    sqlite3_finalize(stmt);
+    if (oneBased) return Status::Fail("schedule already uses weekday 1..6; import expects 0..5");
+    return Status::Ok();
+}
+
+Status ScheduleImporter::validate(const std::vector<ScheduleImportRow>& rows, const References& refs,
+                                  const std::string& source)
+{
+    auto fail = [&](const ScheduleImportRow& r, const std::string& what) {
+        return Status::Fail(source + ":" + lineError(r.line, what));
+    };
+
+    for (const auto& r : rows) {
+        if (r.weekOfCycle < 1 || r.weekOfCycle > 4) return fail(r, "weekofcycle must be 1..4");
+        // Только 0..5, как в schedule_*.sql и SchoolGenerator: Database определяет нумерацию
+        // по MIN(weekday) всей таблицы, и файл с 1..6 сдвинул бы все дни
+        if (r.weekday < 0 || r.weekday >= GroupWeekSchedule::kDays) return fail(r, "weekday must be 0..5");
+        if (r.lessonNumber < 1 || r.lessonNumber > GroupWeekSchedule::kLessons) {
+            return fail(r, "lessonnumber must be 1..6");
+        }
+        if (r.subgroup < 0) return fail(r, "subgroup must be >= 0");
+        if (r.lessonType.empty()) return fail(r, "lessontype is empty");
+
+        // Лекция — общая для потока (как addScheduleEntry)
+        const bool lecture = r.lessonType == "ЛК";
+        if (lecture && (r.groupId != 0 || r.subgroup != 0)) return fail(r, "ЛК must have groupid 0 and subgroup 0");
+
+        if (!refs.groups.count(r.groupId)) return fail(r, "unknown groupid " + std::to_string(r.groupId));
+        if (!refs.subjects.count(r.subjectId)) return fail(r, "unknown subjectid " + std::to_string(r.subjectId));
+        if (!refs.teachers.count(r.teacherId)) return fail(r, "teacherid " + std::to_string(r.teacherId) + " is not a teacher");
+    }
+    return Status::Ok();
+}
+
+// Один подготовленный INSERT на весь импорт; пишет только поток-владелец соединения
+struct ScheduleImporter::RowWriter {
+    sqlite3* raw = nullptr;
+    sqlite3_stmt* stmt = nullptr;
+    bool open = false;
+
+    explicit RowWriter(sqlite3* handle) : raw(handle) {}
+
+    ~RowWriter()
+    {
+        if (stmt) sqlite3_finalize(stmt);
+        if (open) rollback();
+    }
+
+    std::string error(const std::string& what) const
+    {
+        const char* msg = sqlite3_errmsg(raw);
+        return what + ": " + (msg ? msg : "unknown");
+    }
+
+    Status begin()
+    {
+        if (sqlite3_exec(raw, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            return Status::Fail(error("BEGIN failed"));
+        }
+        open = true;
+
+        const char* sql =
+            "INSERT INTO schedule "
+            "(groupid, subgroup, weekday, lessonnumber, weekofcycle, subjectid, teacherid, room, lessontype) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);";
+        if (sqlite3_prepare_v2(raw, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+            return Status::Fail(error("prepare insert"));
+        }
+        return Status::Ok();
+    }
+
+    Status write(const std::vector<ScheduleImportRow>& rows, const std::string& source)
+    {
+        for (const auto& r : rows) {
+            sqlite3_bind_int(stmt, 1, r.groupId);
+            sqlite3_bind_int(stmt, 2, r.subgroup);
+            sqlite3_bind_int(stmt, 3, r.weekday);
+            sqlite3_bind_int(stmt, 4, r.lessonNumber);
+            sqlite3_bind_int(stmt, 5, r.weekOfCycle);
+            sqlite3_bind_int(stmt, 6, r.subjectId);
+            sqlite3_bind_int(stmt, 7, r.teacherId);
+            sqlite3_bind_text(stmt, 8, r.room.c_str(), static_cast<int>(r.room.size()), SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 9, r.lessonType.c_str(), static_cast<int>(r.lessonType.size()), SQLITE_STATIC);
+
+            const int rc = sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+            if (rc != SQLITE_DONE) return Status::Fail(source + ":" + lineError(r.line, error("insert schedule")));
+        }
+        return Status::Ok();
+    }
+
+    Status commit()
+    {
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+        if (sqlite3_exec(raw, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            return Status::Fail(error("COMMIT failed"));
+        }
+        open = false;
+        return Status::Ok();
+    }
+
+    void rollback()
+    {
+        sqlite3_exec(raw, "ROLLBACK;", nullptr, nullptr, nullptr);
+        open = false;
+    }
+};
+
+Result<ScheduleImportStats> ScheduleImporter::importRows(const std::vector<ScheduleImportRow>& rows)
+{
+    if (!db.isConnected()) return Result<ScheduleImportStats>::Fail("DB is not connected");
+
+    const auto totalStart = std::chrono::steady_clock::now();
+    ScheduleImportStats stats;
+    stats.rows = static_cast<int>(rows.size());
+
+    const auto validateStart = std::chrono::steady_clock::now();
+    References refs;
+    Status st = loadReferences(refs);
+    if (st.ok) st = validate(rows, refs, "rows");
+    if (!st.ok) return Result<ScheduleImportStats>::Fail(st.error);
+    stats.validateMs = elapsedMs(validateStart);
+
+    const auto insertStart = std::chrono::steady_clock::now();
+    RowWriter writer(db.rawHandle());
+    st = writer.begin();
+    if (st.ok) st = writer.write(rows, "rows");
+    if (st.ok) st = writer.commit();
+    if (!st.ok) return Result<ScheduleImportStats>::Fail(st.error);
+    stats.insertMs = elapsedMs(insertStart);
+
+    // Расписание могло задать нумерацию дней недели впервые (пустая таблица)
+    db.invalidateCalendar();
+    LessonSlotIndexCache::instance().invalidate();
+
+    stats.totalMs = elapsedMs(totalStart);
+    stats.rowsPerSec = stats.totalMs > 0.0 ? stats.rows * 1000.0 / stats.totalMs : 0.0;
+    return Result<ScheduleImportStats>::Ok(stats);
+}
+
+Result<ScheduleImportStats> ScheduleImporter::importFiles(const std::vector<std::string>& paths, int threadCount)
+{
+    if (!db.isConnected()) return Result<ScheduleImportStats>::Fail("DB is not connected");
+
+    const auto totalStart = std::chrono::steady_clock::now();
+    ScheduleImportStats stats;
+    stats.files = static_cast<int>(paths.size());
+    stats.perFile.resize(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) stats.perFile[i].path = paths[i];
+
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    threadCount = std::max(1, std::min(threadCount, static_cast<int>(paths.size())));
+    stats.threadsUsed = threadCount;
+
+    References refs;
+    Status st = loadReferences(refs);
+    if (!st.ok) return Result<ScheduleImportStats>::Fail(st.error);
+
+    RowWriter writer(db.rawHandle());
+    st = writer.begin();
+    if (st.ok) {
+        if (threadCount == 1) {
+            // Последовательно: разбор -> проверка -> запись для каждого файла
+            for (size_t i = 0; i < paths.size() && st.ok; ++i) {
+                std::vector<ScheduleImportRow> rows;
+                st = parseAndValidate(paths[i], refs, rows, stats);
+                if (!st.ok) break;
+
+                const auto insertStart = std::chrono::steady_clock::now();
+                st = writer.write(rows, paths[i]);
+                stats.insertMs += elapsedMs(insertStart);
+                stats.perFile[i].rows = static_cast<int>(rows.size());
+            }
+        } else {
+            st = runParallel(paths, refs, threadCount, writer, stats);
+        }
+    }
+    if (st.ok) st = writer.commit();
+    if (!st.ok) return Result<ScheduleImportStats>::Fail(st.error);
+
+    db.invalidateCalendar();
+    LessonSlotIndexCache::instance().invalidate();
+
+    for (const auto& f : stats.perFile) stats.rows += f.rows;
+    stats.totalMs = elapsedMs(totalStart);
+    stats.rowsPerSec = stats.totalMs > 0.0 ? stats.rows * 1000.0 / stats.totalMs : 0.0;
+    return Result<ScheduleImportStats>::Ok(std::move(stats));
+}
+
+Status ScheduleImporter::parseAndValidate(const std::string& path, const References& refs,
+                                          std::vector<ScheduleImportRow>& out, ScheduleImportStats& stats)
+{
+    const auto parseStart = std::chrono::steady_clock::now();
+    auto parsed = parseFile(path);
+    stats.parseMs += elapsedMs(parseStart);
+    if (!parsed.ok) return Status::Fail(parsed.error);
+
+    const auto validateStart = std::chrono::steady_clock::now();
+    Status st = validate(parsed.value, refs, path);
+    stats.validateMs += elapsedMs(validateStart);
+    if (!st.ok) return st;
+
+    out = std::move(parsed.value);
+    return Status::Ok();
+}
+
+Status ScheduleImporter::runParallel(const std::vector<std::string>& paths, const References& refs,
+                                     int threadCount, RowWriter& writer, ScheduleImportStats& stats)
+{
+    // Worker'ы разбирают и проверяют файлы; пишет только этот поток (владелец соединения)
+    // и строго в порядке paths, поэтому id в schedule не зависят от числа потоков.
+    // Worker не берётся за файл дальше window от записанного: в памяти не больше
+    // window разобранных файлов, даже если запись отстаёт от разбора.
+    const size_t window = static_cast<size_t>(threadCount) * 2;
+    std::vector<std::vector<ScheduleImportRow>> parsed(paths.size());
+    std::vector<char> ready(paths.size(), 0);
+    size_t written = 0;
+    bool cancelled = false;
+    std::mutex mutex;
+    std::condition_variable readyCv;   // writer ждёт очередной файл
+    std::condition_variable windowCv;  // worker'ы ждут места в окне
+
+    std::atomic<size_t> nextFile{0};
+    std::atomic<long long> parseMicros{0};
+    std::atomic<long long> validateMicros{0};
+    Status workerStatus = Status::Ok();
+
+    auto cancel = [&]() {
+        cancelled = true;
+        readyCv.notify_all();
+        windowCv.notify_all();
+    };
+
+    auto worker = [&]() {
+        size_t i = 0;
+        while ((i = nextFile.fetch_add(1)) < paths.size()) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                windowCv.wait(lock, [&] { return cancelled || i < written + window; });
+                if (cancelled) break;
+            }
+
+            ScheduleImportStats local;
+            std::vector<ScheduleImportRow> rows;
+            const Status st = parseAndValidate(paths[i], refs, rows, local);
+            parseMicros += static_cast<long long>(local.parseMs * 1000.0);
+            validateMicros += static_cast<long long>(local.validateMs * 1000.0);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!st.ok) {
+                if (workerStatus.ok) workerStatus = st;
+                cancel();
+                break;
+            }
+            parsed[i] = std::move(rows);
+            ready[i] = 1;
+            readyCv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(threadCount));
+    for (int t = 0; t < threadCount; ++t) workers.emplace_back(worker);
+
+    Status writeStatus = Status::Ok();
+    for (size_t i = 0; i < paths.size(); ++i) {
+        std::vector<ScheduleImportRow> rows;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            readyCv.wait(lock, [&] { return cancelled || ready[i] != 0; });
+            if (cancelled) break;
+            rows = std::move(parsed[i]);
+        }
+
+        const auto insertStart = std::chrono::steady_clock::now();
+        writeStatus = writer.write(rows, paths[i]);
+        stats.insertMs += elapsedMs(insertStart);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!writeStatus.ok) {
+            // worker'ы, ждущие места в окне, выходят без разбора
+            cancel();
+            break;
+        }
+        stats.perFile[i].rows = static_cast<int>(rows.size());
+        written = i + 1;
+        windowCv.notify_all();
+    }
+    for (auto& t : workers) t.join();
+
+    stats.parseMs += static_cast<double>(parseMicros.load()) / 1000.0;
+    stats.validateMs += static_cast<double>(validateMicros.load()) / 1000.0;
+
+    if (!workerStatus.ok) return workerStatus;
+    return writeStatus;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/result.h"
+#include "database.h"
+
+#include <string>
+#include <vector>
+
+// Строка расписания в значениях таблицы schedule. weekday хранится как в БД
+// (schedule_*.sql и school.db нумеруют дни с 0): принимаются только weekday 0..5
+// и lessonnumber 1..6. Импорт в таблицу, где дни уже нумеруются с 1, отклоняется.
+struct ScheduleImportRow {
+    int groupId = 0;       // 0 — общая лекция потока
+    int subgroup = 0;
+    int weekday = 0;
+    int lessonNumber = 0;
+    int weekOfCycle = 0;
+    int subjectId = 0;
+    int teacherId = 0;
+    std::string room;
+    std::string lessonType;
+    int line = 0;          // строка исходного файла, для сообщений об ошибках
+};
+
+struct ScheduleImportStats {
+    int files = 0;
+    int rows = 0;
+    int threadsUsed = 1;
+
+    // Строк по файлам — из разобранных данных, без COUNT(*) по таблице
+    struct FileReport {
+        std::string path;
+        int rows = 0;
+    };
+    std::vector<FileReport> perFile;
+
+    // Время этапов, мс
+    double parseMs = 0.0;     // чтение и разбор файлов (сумма по потокам)
+    double validateMs = 0.0;  // диапазоны и ссылки на groups/subjects/users (сумма по потокам)
+    double insertMs = 0.0;    // один подготовленный INSERT в одной транзакции
+    double totalMs = 0.0;
+    double rowsPerSec = 0.0;  // rows / totalMs
+};
+
+// Быстрая загрузка расписания вместо выполнения SQL-скриптов построчно
+// (Database::loadScheduleFromFile: каждый INSERT разбирается и планируется заново,
+// и каждый — отдельная транзакция).
+//
+// Форматы, по расширению файла:
+//   .tsv / .csv — строка на занятие, поля в порядке kScheduleColumns через таб/запятую;
+//                 пустые строки и строки с '#' пропускаются, заголовок необязателен.
+//                 Кавычки не поддерживаются: в аудитории и типе нет разделителей.
+//   .sql        — schedule_*.sql: строки вида INSERT INTO schedule (...) VALUES (...);
+//                 и комментарии '--'. Другие команды — ошибка.
+//
+// Все файлы пишутся одной транзакцией; при любой ошибке разбора, проверки или
+// записи она откатывается и таблица не меняется.
+class ScheduleImporter {
+public:
+    // groupid, subgroup, weekday, lessonnumber, weekofcycle, subjectid, teacherid, room, lessontype
+    static const char* const kScheduleColumns[9];
+
+    explicit ScheduleImporter(Database& db);
+
+    // Дописывает строки файлов в schedule (как скрипты); после COMMIT сбрасывает
+    // календарь и кэш занятий Database.
+    // threadCount: 1 — в вызывающем потоке, 0 — по числу ядер, N — N worker'ов разбирают
+    // файлы параллельно, пишет вызывающий поток (единственный writer соединения db).
+    // Строки пишутся в порядке paths при любом threadCount, поэтому id в schedule
+    // от числа потоков не зависят.
+    [[nodiscard]] Result<ScheduleImportStats> importFiles(const std::vector<std::string>& paths,
+                                                          int threadCount = 1);
+    [[nodiscard]] Result<ScheduleImportStats> importRows(const std::vector<ScheduleImportRow>& rows);
+
+    // Разбор без БД; ошибки вида "<строка>: <что не так>"
+    [[nodiscard]] static Result<std::vector<ScheduleImportRow>> parseFile(const std::string& path);
+    [[nodiscard]] static Result<std::vector<ScheduleImportRow>> parseDelimited(const std::string& text, char delimiter);
+    [[nodiscard]] static Result<std::vector<ScheduleImportRow>> parseSqlScript(const std::string& text);
+
+    // Конвертер schedule_*.sql -> TSV (с заголовком)
+    [[nodiscard]] static std::string toTsv(const std::vector<ScheduleImportRow>& rows);
+
+private:
+    struct References;
+    struct RowWriter;
+
+    Database& db;
+
+    [[nodiscard]] Status loadReferences(References& out);
+    [[nodiscard]] static Status validate(const std::vector<ScheduleImportRow>& rows, const References& refs,
+                                         const std::string& source);
+    // Без обращений к БД — безопасно вызывать из нескольких потоков
+    [[nodiscard]] static Status parseAndValidate(const std::string& path, const References& refs,
+                                                 std::vector<ScheduleImportRow>& out, ScheduleImportStats& stats);
+    [[nodiscard]] static Status runParallel(const std::vector<std::string>& paths, const References& refs,
+                                            int threadCount, RowWriter& writer, ScheduleImportStats& stats);
+};
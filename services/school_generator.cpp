@@ -0,0 +1,601 @@
+#include "school_generator.h"
+
+#include "d1_randomizer.h"
+#include "core/lesson_slot_index.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+// id предметов совпадают с initializeDemoData, чтобы SQL-скрипты и правила D1 подходили к обеим БД
+struct SubjectDef {
+    int id;
+    const char* name;
+    const char* slug;  // для логинов преподавателей
+};
+
+constexpr std::array<SubjectDef, 12> kSubjects = {{
+    {1, "АПЭЦ", "apec"},
+    {2, "ТВиМС", "tvims"},
+    {3, "ФизК", "fizk"},
+    {4, "ТГ", "tg"},
+    {5, "ВМиКА", "vmika"},
+    {6, "БЖЧ", "bzhch"},
+    {7, "ООП", "oop"},
+    {8, "ОИнфБ", "oinfb"},
+    {9, "БД", "bd"},
+    {10, "МСиСвИТ", "msisvit"},
+    {11, "Инф. час", "infchas"},
+    {12, "К.Ч.", "kch"},
+}};
+
+// Занятия групп: (предмет, тип) из правил D1Randomizer + физкультура
+struct PracticeItem {
+    int subjectId;
+    const char* lessonType;
+};
+
+constexpr std::array<PracticeItem, 12> kPracticeItems = {{
+    {1, "ЛР"}, {2, "ПЗ"}, {3, "ПЗ"}, {4, "ПЗ"}, {5, "ЛР"}, {6, "ПЗ"},
+    {6, "ЛР"}, {7, "ЛР"}, {8, "ПЗ"}, {9, "ЛР"}, {9, "ПЗ"}, {10, "ПЗ"},
+}};
+
+// Общие лекции потока (1-я пара), по кругу по дням цикла
+constexpr std::array<int, 9> kLectureSubjects = {1, 2, 4, 5, 6, 7, 8, 9, 10};
+
+constexpr int kDaysPerWeek = 6;  // пн..сб
+constexpr int kCycleWeeks = 4;
+constexpr int kLessonHours = 2;
+constexpr const char* kLectureRoom = "104-4";
+
+const char* const kSurnames[] = {
+    "Иванов", "Петров", "Сидоров", "Ковалёв", "Новик", "Мельник", "Шевчук", "Кравченко",
+    "Бондаренко", "Лях", "Савин", "Марчук", "Павлов", "Гончар", "Жук", "Карпович",
+    "Романов", "Соколов", "Лебедев", "Козлов", "Морозов", "Волков", "Зайцев", "Орлов",
+};
+const char* const kFirstNames[] = {
+    "Алексей", "Андрей", "Артём", "Даниил", "Дмитрий", "Егор", "Иван", "Кирилл",
+    "Максим", "Никита", "Павел", "Роман", "Тимофей", "Владислав", "Илья", "Матвей",
+};
+const char* const kPatronymics[] = {
+    "Александрович", "Алексеевич", "Андреевич", "Дмитриевич", "Сергеевич",
+    "Владимирович", "Игоревич", "Юрьевич", "Олегович", "Михайлович",
+};
+const char* const kInitials[] = {"А.", "В.", "Г.", "Д.", "Е.", "И.", "К.", "Л.", "М.", "Н.", "О.", "С.", "Т."};
+
+template <typename T, std::size_t N>
+const T& pick(std::mt19937_64& rng, const T (&items)[N])
+{
+    return items[rng() % N];
+}
+
+std::string twoDigits(int n)
+{
+    return n < 10 ? "0" + std::to_string(n) : std::to_string(n);
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Равномерное [0, 1) из старших 53 бит — одинаково во всех стандартных библиотеках
+double unitDouble(std::mt19937_64& rng)
+{
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+} // namespace
+
+// Раскладка id: всё считается заранее, поэтому строки пишутся без обратных SELECT.
+// Студенты группы g (0-based) — подряд с 1, затем admin, лекторы, преподаватели занятий.
+struct SchoolGenerator::Layout {
+    SchoolGeneratorOptions options;
+    int semesterId = 1;
+    int slotsPerDay = 0;   // пар для занятий групп в день
+    int poolSize = 0;      // преподавателей и аудиторий на пункт kPracticeItems
+    int adminId = 0;
+    int firstLecturerId = 0;
+    int firstPracticeTeacherId = 0;
+
+    explicit Layout(const SchoolGeneratorOptions& o)
+        : options(o)
+    {
+        const int items = static_cast<int>(kPracticeItems.size());
+        slotsPerDay = o.lessonsPerDay - 1;
+        poolSize = (o.groups + items - 1) / items;
+        adminId = o.groups * o.studentsPerGroup + 1;
+        firstLecturerId = adminId + 1;
+        firstPracticeTeacherId = firstLecturerId + static_cast<int>(kLectureSubjects.size());
+    }
+
+    int groupId(int g) const { return g + 1; }
+    int studentId(int g, int n) const { return 1 + g * options.studentsPerGroup + n; }
+    int subgroupOf(int n) const { return n < (options.studentsPerGroup + 1) / 2 ? 1 : 2; }
+
+    int lecturerId(int lectureIndex) const { return firstLecturerId + lectureIndex; }
+    int practiceTeacherId(int item, int j) const { return firstPracticeTeacherId + item * poolSize + j; }
+
+    // Группы g с одним пунктом в одном слоте отличаются на кратное kPracticeItems.size(),
+    // поэтому j = g / size у них разный — отсюда разные преподаватель и аудитория
+    int poolIndexOf(int g) const { return g / static_cast<int>(kPracticeItems.size()); }
+
+    static std::string practiceRoom(int item, int j) { return std::to_string(201 + item) + "-" + std::to_string(j + 1); }
+
+    CivilDate weekStart(int week) const { return options.semesterStart.addDays(7 * week); }
+    CivilDate semesterEnd() const { return weekStart(options.weeks).addDays(-1); }
+};
+
+struct SchoolGenerator::ScheduleRow {
+    int groupId = 0;
+    int subgroup = 0;
+    int weekday = 0;  // 0..5, как в schedule_*.sql
+    int lessonNumber = 0;
+    int weekOfCycle = 0;
+    int subjectId = 0;
+    int teacherId = 0;
+    std::string room;
+    const char* lessonType = "";
+};
+
+// Подготовленные statement'ы одной генерации; step() сразу сбрасывает привязки
+struct SchoolGenerator::Writer {
+    sqlite3* rawDb = nullptr;
+    std::vector<sqlite3_stmt*> owned;
+
+    explicit Writer(sqlite3* handle) : rawDb(handle) {}
+
+    ~Writer()
+    {
+        for (sqlite3_stmt* stmt : owned) sqlite3_finalize(stmt);
+    }
+
+    sqlite3_stmt* prepare(const char* sql)
+    {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(rawDb, sql, -1, &stmt, nullptr) != SQLITE_OK) return nullptr;
+        owned.push_back(stmt);
+        return stmt;
+    }
+
+    bool exec(const char* sql)
+    {
+        char* err = nullptr;
+        const int rc = sqlite3_exec(rawDb, sql, nullptr, nullptr, &err);
+        if (err) sqlite3_free(err);
+        return rc == SQLITE_OK;
+    }
+
+    static bool step(sqlite3_stmt* stmt)
+    {
+        const int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return rc == SQLITE_DONE;
+    }
+
+    void rollback() { sqlite3_exec(rawDb, "ROLLBACK;", nullptr, nullptr, nullptr); }
+
+    std::string error(const std::string& what) const
+    {
+        const char* msg = sqlite3_errmsg(rawDb);
+        return what + ": " + (msg ? msg : "unknown");
+    }
+};
+
+SchoolGenerator::SchoolGenerator(Database& db, std::uint64_t seed)
+    : db(db), seed(seed), rng(seed)
+{
+}
+
+std::string SchoolGenerator::randomStudentName()
+{
+    std::string name = pick(rng, kSurnames);
+    name += ' ';
+    name += pick(rng, kFirstNames);
+    name += ' ';
+    name += pick(rng, kPatronymics);
+    return name;
+}
+
+std::string SchoolGenerator::randomTeacherName()
+{
+    std::string name = pick(rng, kSurnames);
+    name += ' ';
+    name += pick(rng, kInitials);
+    name += ' ';
+    name += pick(rng, kInitials);
+    return name;
+}
+
+Result<SchoolGeneratorStats> SchoolGenerator::generate(const SchoolGeneratorOptions& options)
+{
+    if (!db.isConnected()) return Result<SchoolGeneratorStats>::Fail("DB is not connected");
+    if (options.groups <= 0) return Result<SchoolGeneratorStats>::Fail("groups must be > 0");
+    if (options.studentsPerGroup < 2) return Result<SchoolGeneratorStats>::Fail("studentsPerGroup must be >= 2");
+    if (options.lessonsPerDay < 2 || options.lessonsPerDay > GroupWeekSchedule::kLessons) {
+        // Пары после 6-й не попадают в сетку getScheduleForGroupWeek и отклоняются ScheduleImporter
+        return Result<SchoolGeneratorStats>::Fail("lessonsPerDay must be 2..6");
+    }
+    if (options.weeks <= 0) return Result<SchoolGeneratorStats>::Fail("weeks must be > 0");
+    if (options.semesterStart.isNull() || options.semesterStart.isoWeekday() != 1) {
+        return Result<SchoolGeneratorStats>::Fail("semesterStart must be a Monday");
+    }
+    if (options.absenceRate < 0.0 || options.absenceRate > 1.0) {
+        return Result<SchoolGeneratorStats>::Fail("absenceRate must be in [0, 1]");
+    }
+
+    const auto totalStart = std::chrono::steady_clock::now();
+    const Layout layout(options);
+
+    SchoolGeneratorStats stats;
+    stats.seed = seed;
+    rng.seed(seed);
+
+    Writer writer(db.rawHandle());
+    std::vector<ScheduleRow> scheduleRows;
+
+    // Справочники и расписание — одна транзакция: оценки D1 ищут занятия по расписанию
+    if (!writer.exec("BEGIN TRANSACTION;")) {
+        return Result<SchoolGeneratorStats>::Fail(writer.error("BEGIN failed"));
+    }
+
+    Status st = writeReference(layout, writer, stats);
+    if (st.ok) st = writeSchedule(layout, writer, scheduleRows, stats);
+    if (!st.ok) {
+        writer.rollback();
+        db.invalidateCalendar();
+        return Result<SchoolGeneratorStats>::Fail(st.error);
+    }
+    if (!writer.exec("COMMIT;")) {
+        const std::string err = writer.error("COMMIT failed");
+        writer.rollback();
+        db.invalidateCalendar();
+        return Result<SchoolGeneratorStats>::Fail(err);
+    }
+    db.invalidateCalendar();  // cycleweeks и расписание пересозданы
+    LessonSlotIndexCache::instance().invalidate();
+
+    const auto gradesStart = std::chrono::steady_clock::now();
+    D1Randomizer randomizer(db, seed);
+    auto grades = randomizer.generateForAllGroups(false, options.threads);
+    if (!grades.ok) {
+        return Result<SchoolGeneratorStats>::Fail("D1Randomizer: " + grades.error);
+    }
+    stats.grades = grades.value.createdTotal;
+    stats.timing.gradesMs = elapsedMs(gradesStart);
+
+    const auto absencesStart = std::chrono::steady_clock::now();
+    if (!writer.exec("BEGIN TRANSACTION;")) {
+        return Result<SchoolGeneratorStats>::Fail(writer.error("BEGIN failed"));
+    }
+    st = writeAbsences(layout, scheduleRows, writer, stats);
+    if (!st.ok) {
+        writer.rollback();
+        return Result<SchoolGeneratorStats>::Fail(st.error);
+    }
+    if (!writer.exec("COMMIT;")) {
+        const std::string err = writer.error("COMMIT failed");
+        writer.rollback();
+        return Result<SchoolGeneratorStats>::Fail(err);
+    }
+    stats.timing.absencesMs = elapsedMs(absencesStart);
+
+    stats.timing.totalMs = elapsedMs(totalStart);
+    const double rows = static_cast<double>(stats.students + stats.teachers + stats.scheduleRows +
+                                            stats.grades + stats.absences);
+    if (stats.timing.totalMs > 0.0) stats.timing.rowsPerSec = rows * 1000.0 / stats.timing.totalMs;
+
+    std::cerr << "[SchoolGenerator] groups=" << stats.groups
+              << " students=" << stats.students
+              << " teachers=" << stats.teachers
+              << " rooms=" << stats.rooms
+              << " schedule=" << stats.scheduleRows
+              << " grades=" << stats.grades
+              << " absences=" << stats.absences
+              << " seed=" << stats.seed
+              << " total=" << stats.timing.totalMs << "ms"
+              << " rows/sec=" << stats.timing.rowsPerSec << "\n";
+
+    return Result<SchoolGeneratorStats>::Ok(std::move(stats));
+}
+
+Status SchoolGenerator::writeReference(const Layout& layout, Writer& writer, SchoolGeneratorStats& stats)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const SchoolGeneratorOptions& o = layout.options;
+
+    // Сводку — первой: триггеры удаления grades/absences тогда ничего не обновляют
+    // и не оставляют нулевых строк. Дальше порядок как в initializeDemoData.
+    if (db.hasStudentStats() && !writer.exec("DELETE FROM studentstats;")) {
+        return Status::Fail(writer.error("clear studentstats"));
+    }
+    const bool cleared = writer.exec(
+        "DELETE FROM grades;"
+        "DELETE FROM gradechanges;"
+        "DELETE FROM absences;"
+        "DELETE FROM schedule;"
+        "DELETE FROM teachersubjects;"
+        "DELETE FROM teachergroups;"
+        "DELETE FROM users;"
+        "DELETE FROM subjects;"
+        "DELETE FROM semesters;"
+        "DELETE FROM groups;"
+        "DELETE FROM cycleweeks;"
+        "DELETE FROM sqlite_sequence WHERE name IN ("
+        " 'users','subjects','groups','schedule',"
+        " 'grades','gradechanges','absences','cycleweeks'"
+        ");");
+    if (!cleared) return Status::Fail(writer.error("clear tables"));
+
+    sqlite3_stmt* weekStmt = writer.prepare(
+        "INSERT INTO cycleweeks (id, weekofcycle, startdate, enddate) VALUES (?, ?, ?, ?);");
+    sqlite3_stmt* semesterStmt = writer.prepare(
+        "INSERT INTO semesters (id, name, startdate, enddate) VALUES (?, ?, ?, ?);");
+    sqlite3_stmt* groupStmt = writer.prepare("INSERT INTO groups (id, name) VALUES (?, ?);");
+    sqlite3_stmt* subjectStmt = writer.prepare("INSERT INTO subjects (id, name) VALUES (?, ?);");
+    sqlite3_stmt* userStmt = writer.prepare(
+        "INSERT INTO users (id, username, password, role, name, groupid, subgroup) "
+        "VALUES (?, ?, '123', ?, ?, ?, ?);");
+    sqlite3_stmt* teacherSubjectStmt = writer.prepare(
+        "INSERT OR IGNORE INTO teachersubjects (teacherid, subjectid) VALUES (?, ?);");
+    sqlite3_stmt* teacherGroupStmt = writer.prepare(
+        "INSERT OR IGNORE INTO teachergroups (teacherid, groupid) VALUES (?, ?);");
+    if (!weekStmt || !semesterStmt || !groupStmt || !subjectStmt || !userStmt ||
+        !teacherSubjectStmt || !teacherGroupStmt) {
+        return Status::Fail(writer.error("prepare reference inserts"));
+    }
+
+    // ===== НЕДЕЛИ ЦИКЛА И СЕМЕСТР =====
+    for (int w = 0; w < o.weeks; ++w) {
+        const std::string startISO = layout.weekStart(w).toISO();
+        const std::string endISO = layout.weekStart(w).addDays(6).toISO();
+        sqlite3_bind_int(weekStmt, 1, w + 1);
+        sqlite3_bind_int(weekStmt, 2, w % kCycleWeeks + 1);
+        sqlite3_bind_text(weekStmt, 3, startISO.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(weekStmt, 4, endISO.c_str(), -1, SQLITE_TRANSIENT);
+        if (!Writer::step(weekStmt)) return Status::Fail(writer.error("insert cycleweeks"));
+    }
+
+    {
+        const int year = o.semesterStart.year();
+        const std::string name = "1 семестр " + std::to_string(year) + "/" + std::to_string(year + 1);
+        const std::string startISO = o.semesterStart.toISO();
+        const std::string endISO = layout.semesterEnd().toISO();
+        sqlite3_bind_int(semesterStmt, 1, layout.semesterId);
+        sqlite3_bind_text(semesterStmt, 2, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(semesterStmt, 3, startISO.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(semesterStmt, 4, endISO.c_str(), -1, SQLITE_TRANSIENT);
+        if (!Writer::step(semesterStmt)) return Status::Fail(writer.error("insert semester"));
+    }
+
+    // ===== ГРУППЫ =====
+    auto insertGroup = [&](int id, const std::string& name) {
+        sqlite3_bind_int(groupStmt, 1, id);
+        sqlite3_bind_text(groupStmt, 2, name.c_str(), -1, SQLITE_TRANSIENT);
+        return Writer::step(groupStmt);
+    };
+    if (!insertGroup(0, "Общая лекция")) return Status::Fail(writer.error("insert groups"));
+    for (int g = 0; g < o.groups; ++g) {
+        if (!insertGroup(layout.groupId(g), std::to_string(420601 + g))) {
+            return Status::Fail(writer.error("insert groups"));
+        }
+    }
+    stats.groups = o.groups;
+
+    // ===== ПРЕДМЕТЫ =====
+    for (const auto& s : kSubjects) {
+        sqlite3_bind_int(subjectStmt, 1, s.id);
+        sqlite3_bind_text(subjectStmt, 2, s.name, -1, SQLITE_STATIC);
+        if (!Writer::step(subjectStmt)) return Status::Fail(writer.error("insert subjects"));
+    }
+
+    auto insertUser = [&](int id, const std::string& username, const char* role,
+                          const std::string& name, int groupId, int subgroup) {
+        sqlite3_bind_int(userStmt, 1, id);
+        sqlite3_bind_text(userStmt, 2, username.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(userStmt, 3, role, -1, SQLITE_STATIC);
+        sqlite3_bind_text(userStmt, 4, name.c_str(), -1, SQLITE_TRANSIENT);
+        if (groupId > 0) sqlite3_bind_int(userStmt, 5, groupId);
+        else sqlite3_bind_null(userStmt, 5);
+        sqlite3_bind_int(userStmt, 6, subgroup);
+        return Writer::step(userStmt);
+    };
+
+    // ===== СТУДЕНТЫ =====
+    for (int g = 0; g < o.groups; ++g) {
+        const std::string prefix = "s" + std::to_string(420601 + g) + "_";
+        for (int n = 0; n < o.studentsPerGroup; ++n) {
+            if (!insertUser(layout.studentId(g, n), prefix + twoDigits(n + 1), "student",
+                            randomStudentName(), layout.groupId(g), layout.subgroupOf(n))) {
+                return Status::Fail(writer.error("insert students"));
+            }
+            ++stats.students;
+        }
+    }
+
+    if (!insertUser(layout.adminId, "admin", "admin", "Administrator", 0, 0)) {
+        return Status::Fail(writer.error("insert admin"));
+    }
+
+    // ===== ПРЕПОДАВАТЕЛИ =====
+    auto linkTeacher = [&](int teacherId, int subjectId, int firstGroup, int lastGroup) {
+        sqlite3_bind_int(teacherSubjectStmt, 1, teacherId);
+        sqlite3_bind_int(teacherSubjectStmt, 2, subjectId);
+        if (!Writer::step(teacherSubjectStmt)) return false;
+        for (int g = firstGroup; g < lastGroup; ++g) {
+            sqlite3_bind_int(teacherGroupStmt, 1, teacherId);
+            sqlite3_bind_int(teacherGroupStmt, 2, layout.groupId(g));
+            if (!Writer::step(teacherGroupStmt)) return false;
+        }
+        return true;
+    };
+
+    // Лекторы потока читают всем группам
+    for (int k = 0; k < static_cast<int>(kLectureSubjects.size()); ++k) {
+        const SubjectDef& s = kSubjects[static_cast<size_t>(kLectureSubjects[static_cast<size_t>(k)] - 1)];
+        const int id = layout.lecturerId(k);
+        if (!insertUser(id, std::string("t_") + s.slug + "_lk", "teacher", randomTeacherName(), 0, 0) ||
+            !linkTeacher(id, s.id, 0, o.groups)) {
+            return Status::Fail(writer.error("insert lecturers"));
+        }
+        ++stats.teachers;
+    }
+
+    // Преподаватель j пункта item ведёт группы [j * size, (j + 1) * size)
+    const int items = static_cast<int>(kPracticeItems.size());
+    for (int item = 0; item < items; ++item) {
+        const PracticeItem& p = kPracticeItems[static_cast<size_t>(item)];
+        const SubjectDef& s = kSubjects[static_cast<size_t>(p.subjectId - 1)];
+        const std::string typeSlug = std::string(p.lessonType) == "ЛР" ? "lr" : "pz";
+        for (int j = 0; j < layout.poolSize; ++j) {
+            const int id = layout.practiceTeacherId(item, j);
+            const std::string username = std::string("t_") + s.slug + "_" + typeSlug + "_" + twoDigits(j + 1);
+            if (!insertUser(id, username, "teacher", randomTeacherName(), 0, 0) ||
+                !linkTeacher(id, s.id, j * items, std::min(o.groups, (j + 1) * items))) {
+                return Status::Fail(writer.error("insert teachers"));
+            }
+            ++stats.teachers;
+        }
+    }
+    stats.rooms = items * layout.poolSize + 1;
+
+    stats.timing.referenceMs = elapsedMs(start);
+    return Status::Ok();
+}
+
+Status SchoolGenerator::writeSchedule(const Layout& layout, Writer& writer,
+                                      std::vector<ScheduleRow>& outRows, SchoolGeneratorStats& stats)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const SchoolGeneratorOptions& o = layout.options;
+    const int items = static_cast<int>(kPracticeItems.size());
+    const int lectures = static_cast<int>(kLectureSubjects.size());
+
+    outRows.clear();
+    outRows.reserve(static_cast<size_t>(kCycleWeeks * kDaysPerWeek * (1 + layout.slotsPerDay * o.groups)));
+
+    for (int w = 0; w < kCycleWeeks; ++w) {
+        for (int d = 0; d < kDaysPerWeek; ++d) {
+            const int day = w * kDaysPerWeek + d;
+
+            // 1-я пара: общая лекция (groupid = 0), одна на весь поток
+            ScheduleRow lecture;
+            lecture.weekday = d;
+            lecture.lessonNumber = 1;
+            lecture.weekOfCycle = w + 1;
+            lecture.subjectId = kLectureSubjects[static_cast<size_t>(day % lectures)];
+            lecture.teacherId = layout.lecturerId(day % lectures);
+            lecture.room = kLectureRoom;
+            lecture.lessonType = "ЛК";
+            outRows.push_back(std::move(lecture));
+
+            // Остальные пары: группа g в слоте s берёт пункт (s + g) % items, поэтому
+            // за цикл каждая группа проходит все пункты поровну. ЛР — по подгруппам поочерёдно.
+            for (int l = 0; l < layout.slotsPerDay; ++l) {
+                const int slot = day * layout.slotsPerDay + l;
+                for (int g = 0; g < o.groups; ++g) {
+                    const int item = (slot + g) % items;
+                    const int j = layout.poolIndexOf(g);
+                    const PracticeItem& p = kPracticeItems[static_cast<size_t>(item)];
+
+                    ScheduleRow r;
+                    r.groupId = layout.groupId(g);
+                    r.subgroup = std::string(p.lessonType) == "ЛР" ? (slot / items) % 2 + 1 : 0;
+                    r.weekday = d;
+                    r.lessonNumber = l + 2;
+                    r.weekOfCycle = w + 1;
+                    r.subjectId = p.subjectId;
+                    r.teacherId = layout.practiceTeacherId(item, j);
+                    r.room = Layout::practiceRoom(item, j);
+                    r.lessonType = p.lessonType;
+                    outRows.push_back(std::move(r));
+                }
+            }
+        }
+    }
+
+    sqlite3_stmt* stmt = writer.prepare(
+        "INSERT INTO schedule (groupid, subgroup, weekday, lessonnumber, weekofcycle, "
+        "subjectid, teacherid, room, lessontype) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);");
+    if (!stmt) return Status::Fail(writer.error("prepare schedule insert"));
+
+    for (const auto& r : outRows) {
+        sqlite3_bind_int(stmt, 1, r.groupId);
+        sqlite3_bind_int(stmt, 2, r.subgroup);
+        sqlite3_bind_int(stmt, 3, r.weekday);
+        sqlite3_bind_int(stmt, 4, r.lessonNumber);
+        sqlite3_bind_int(stmt, 5, r.weekOfCycle);
+        sqlite3_bind_int(stmt, 6, r.subjectId);
+        sqlite3_bind_int(stmt, 7, r.teacherId);
+        sqlite3_bind_text(stmt, 8, r.room.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 9, r.lessonType, -1, SQLITE_STATIC);
+        if (!Writer::step(stmt)) return Status::Fail(writer.error("insert schedule"));
+    }
+    stats.scheduleRows = static_cast<int>(outRows.size());
+
+    stats.timing.scheduleMs = elapsedMs(start);
+    return Status::Ok();
+}
+
+Status SchoolGenerator::writeAbsences(const Layout& layout, const std::vector<ScheduleRow>& rows,
+                                      Writer& writer, SchoolGeneratorStats& stats)
+{
+    const SchoolGeneratorOptions& o = layout.options;
+    if (o.absenceRate <= 0.0) return Status::Ok();
+
+    // Пропуск ставится только туда, где нет оценки; второе занятие того же предмета
+    // в тот же день (лекция + практика) упирается в idxabsenceskey и пропускается
+    sqlite3_stmt* stmt = writer.prepare(
+        "INSERT OR IGNORE INTO absences (studentid, subjectid, semesterid, hours, date, type) "
+        "SELECT ?1, ?2, ?3, ?4, ?5, ?6 "
+        "WHERE NOT EXISTS (SELECT 1 FROM grades "
+        "  WHERE studentid = ?1 AND subjectid = ?2 AND semesterid = ?3 AND date = ?5);");
+    if (!stmt) return Status::Fail(writer.error("prepare absence insert"));
+
+    // Строки расписания по (неделя цикла, день)
+    std::vector<std::vector<const ScheduleRow*>> byDay(static_cast<size_t>(kCycleWeeks * kDaysPerWeek));
+    for (const auto& r : rows) {
+        byDay[static_cast<size_t>((r.weekOfCycle - 1) * kDaysPerWeek + r.weekday)].push_back(&r);
+    }
+
+    auto addAbsence = [&](int studentId, const ScheduleRow& r, const char* dateISO) {
+        if (unitDouble(rng) >= o.absenceRate) return true;
+        const char* type = unitDouble(rng) < 0.25 ? "excused" : "unexcused";
+        sqlite3_bind_int(stmt, 1, studentId);
+        sqlite3_bind_int(stmt, 2, r.subjectId);
+        sqlite3_bind_int(stmt, 3, layout.semesterId);
+        sqlite3_bind_int(stmt, 4, kLessonHours);
+        sqlite3_bind_text(stmt, 5, dateISO, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 6, type, -1, SQLITE_STATIC);
+        if (!Writer::step(stmt)) return false;
+        stats.absences += sqlite3_changes(writer.rawDb);
+        return true;
+    };
+
+    for (int week = 0; week < o.weeks; ++week) {
+        const int cycleWeek = week % kCycleWeeks;
+        for (int d = 0; d < kDaysPerWeek; ++d) {
+            char dateISO[CivilDate::kISOLength + 1];
+            layout.weekStart(week).addDays(d).formatISO(dateISO);
+
+            for (const ScheduleRow* r : byDay[static_cast<size_t>(cycleWeek * kDaysPerWeek + d)]) {
+                const int firstGroup = r->groupId == 0 ? 0 : r->groupId - 1;
+                const int lastGroup = r->groupId == 0 ? o.groups : r->groupId;
+                for (int g = firstGroup; g < lastGroup; ++g) {
+                    for (int n = 0; n < o.studentsPerGroup; ++n) {
+                        if (r->subgroup != 0 && layout.subgroupOf(n) != r->subgroup) continue;
+                        if (!addAbsence(layout.studentId(g, n), *r, dateISO)) {
+                            return Status::Fail(writer.error("insert absences"));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return Status::Ok();
+}
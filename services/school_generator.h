@@ -0,0 +1,75 @@
+#pragma once
+
+#include "core/civil_date.h"
+#include "core/result.h"
+#include "database.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Параметры синтетической школы. Соглашения те же, что у initializeDemoData:
+// группа 0 — общая лекция потока, студенты s<группа>_<nn> / '123', две подгруппы,
+// преподаватели t_... без группы, один семестр с понедельника semesterStart.
+struct SchoolGeneratorOptions {
+    int groups = 4;
+    int studentsPerGroup = 28;   // первая половина — подгруппа 1, вторая — 2
+    int lessonsPerDay = 4;       // 2..6; 1-я пара — общая лекция, остальные — занятия групп
+    int weeks = 17;              // недель семестра, weekofcycle идёт 1..4 по кругу
+    CivilDate semesterStart = CivilDate::fromYmd(2025, 9, 1);  // понедельник
+    double absenceRate = 0.03;   // доля (студент, занятие) с пропуском
+    int threads = 0;             // для D1Randomizer: 0 — по числу ядер
+};
+
+struct SchoolGeneratorStats {
+    int groups = 0;
+    int students = 0;
+    int teachers = 0;
+    int rooms = 0;
+    int scheduleRows = 0;
+    int grades = 0;
+    int absences = 0;
+    std::uint64_t seed = 0;
+
+    // Время этапов, мс
+    struct Timing {
+        double referenceMs = 0.0;  // очистка, недели, группы, пользователи, предметы
+        double scheduleMs = 0.0;   // расписание цикла
+        double gradesMs = 0.0;     // D1Randomizer по всем группам
+        double absencesMs = 0.0;   // пропуски по развёрнутым занятиям
+        double totalMs = 0.0;
+        double rowsPerSec = 0.0;   // все вставленные строки / totalMs
+    };
+    Timing timing;
+};
+
+// Генератор большой согласованной БД для нагрузочных прогонов.
+// Заменяет содержимое БД целиком (как initializeDemoData). Расписание без
+// конфликтов по построению: в каждом слоте у преподавателя и аудитории не больше
+// одного занятия; оценки ставит D1Randomizer по своим правилам, пропуски — только
+// на занятия без оценки. Всё пишется пакетами подготовленных INSERT в транзакциях.
+class SchoolGenerator {
+public:
+    SchoolGenerator(Database& db, std::uint64_t seed);
+
+    [[nodiscard]] Result<SchoolGeneratorStats> generate(const SchoolGeneratorOptions& options);
+
+private:
+    struct Layout;
+    struct ScheduleRow;
+    struct Writer;
+
+    Database& db;
+    std::uint64_t seed = 0;
+    std::mt19937_64 rng;
+
+    [[nodiscard]] Status writeReference(const Layout& layout, Writer& writer, SchoolGeneratorStats& stats);
+    [[nodiscard]] Status writeSchedule(const Layout& layout, Writer& writer,
+                                       std::vector<ScheduleRow>& outRows, SchoolGeneratorStats& stats);
+    [[nodiscard]] Status writeAbsences(const Layout& layout, const std::vector<ScheduleRow>& rows,
+                                       Writer& writer, SchoolGeneratorStats& stats);
+
+    [[nodiscard]] std::string randomStudentName();
+    [[nodiscard]] std::string randomTeacherName();
+};
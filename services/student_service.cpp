@@ -71,20 +71,29 @@ StudentService::getScheduleForGroup(int groupId, int weekday, int weekOfCycle) {
     return Result<std::vector<ScheduleRow>>::Ok(std::move(rows));
 }
 
-Result<std::string>
-StudentService::getDateISO(int weekOfCycle, int weekday) {
+Result<CivilDate>
+StudentService::getDate(int weekOfCycle, int weekday) {
     if (weekday < 0 || weekday > 5) {
-        return Result<std::string>::Fail("weekday must be in [0..5]");
+        return Result<CivilDate>::Fail("weekday must be in [0..5]");
     }
     if (weekOfCycle < 1 || weekOfCycle > 4) {
-        return Result<std::string>::Fail("weekOfCycle must be in [1..4]");
+        return Result<CivilDate>::Fail("weekOfCycle must be in [1..4]");
     }
 
-    std::string dateISO;
-    if (!db.getDateForWeekday(weekOfCycle, weekday, dateISO)) {
-        return Result<std::string>::Fail("DB: getDateForWeekday failed");
+    CivilDate date;
+    if (!db.getDateForWeekday(weekOfCycle, weekday, date)) {
+        return Result<CivilDate>::Fail("DB: getDateForWeekday failed");
     }
 
-    return Result<std::string>::Ok(std::move(dateISO));
+    return Result<CivilDate>::Ok(date);
 }
 
+Result<std::string>
+StudentService::getDateISO(int weekOfCycle, int weekday) {
+    auto date = getDate(weekOfCycle, weekday);
+    if (!date.ok) {
+        return Result<std::string>::Fail(date.error);
+    }
+
+    return Result<std::string>::Ok(date.value.toISO());
+}
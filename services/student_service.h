@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/civil_date.h"
 #include "core/result.h"
 #include "database.h"
 
@@ -16,14 +17,14 @@ struct LessonDto {
     std::string teacher;
     std::string room;
     std::string lessonType; // "ЛК"/"ПЗ"/"ЛР" или ""
-    std::string dateISO;    // "YYYY-MM-DD"
+    CivilDate   date;
 };
 
 struct GradeDto {
     int    id;
     int    value;
     std::string subject;
-    std::string dateISO;
+    CivilDate   date;
     std::string type;  // можно оставить "" если не используешь
 };
 
@@ -31,7 +32,7 @@ struct AbsenceDto {
     int    id;    // можно не хранить, если в БД нет
     int    hours;
     std::string subject;
-    std::string dateISO;
+    CivilDate   date;
     std::string type; // "excused"/"unexcused"
 };
 
@@ -60,6 +61,8 @@ public:
 
     [[nodiscard]] Result<std::vector<ScheduleRow>> getScheduleForGroup(int groupId, int weekday, int weekOfCycle);
 
+    [[nodiscard]] Result<CivilDate> getDate(int weekOfCycle, int weekday);
+
     [[nodiscard]] Result<std::string> getDateISO(int weekOfCycle, int weekday);
 
 private:
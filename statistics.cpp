@@ -2,6 +2,7 @@
 #include "database.h"
 
 #include <sqlite3.h>
+#include <algorithm>
 #include <iostream>
 
 double Statistics::calculateStudentAverage(Database& db,
@@ -14,10 +15,14 @@ double Statistics::calculateStudentAverage(Database& db,
         return 0.0;
     }
 
-    const char* sql =
-        "SELECT AVG(value) "
-        "FROM grades "
-        "WHERE studentid = ? AND semesterid = ?;";
+    // Сводка studentstats (миграция 2): суммы по месяцам вместо всех оценок семестра
+    const char* sql = db.hasStudentStats()
+        ? "SELECT CAST(SUM(gradesum) AS REAL) / SUM(gradecount) "
+          "FROM studentstats "
+          "WHERE studentid = ? AND semesterid = ?;"
+        : "SELECT AVG(value) "
+          "FROM grades "
+          "WHERE studentid = ? AND semesterid = ?;";
 
     sqlite3_stmt* stmt = nullptr;
     int rc = sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr);
@@ -54,10 +59,13 @@ double Statistics::calculateStudentSubjectAverage(Database& db,
         return 0.0;
     }
 
-    const char* sql =
-        "SELECT AVG(value) "
-        "FROM grades "
-        "WHERE studentid = ? AND subjectid = ? AND semesterid = ?;";
+    const char* sql = db.hasStudentStats()
+        ? "SELECT CAST(SUM(gradesum) AS REAL) / SUM(gradecount) "
+          "FROM studentstats "
+          "WHERE studentid = ? AND subjectid = ? AND semesterid = ?;"
+        : "SELECT AVG(value) "
+          "FROM grades "
+          "WHERE studentid = ? AND subjectid = ? AND semesterid = ?;";
 
     sqlite3_stmt* stmt = nullptr;
     int rc = sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr);
@@ -95,11 +103,16 @@ double Statistics::calculateGroupSubjectAverage(Database& db,
         return 0.0;
     }
 
-    const char* sql =
-        "SELECT AVG(g.value) "
-        "FROM grades g "
-        "JOIN users u ON g.studentid = u.id "
-        "WHERE u.groupid = ? AND g.subjectid = ? AND g.semesterid = ?;";
+    // По сводке: на студента группы — несколько строк (месяцы), а не все его оценки
+    const char* sql = db.hasStudentStats()
+        ? "SELECT CAST(SUM(s.gradesum) AS REAL) / SUM(s.gradecount) "
+          "FROM users u "
+          "JOIN studentstats s ON s.studentid = u.id "
+          "WHERE u.groupid = ? AND s.subjectid = ? AND s.semesterid = ?;"
+        : "SELECT AVG(g.value) "
+          "FROM grades g "
+          "JOIN users u ON g.studentid = u.id "
+          "WHERE u.groupid = ? AND g.subjectid = ? AND g.semesterid = ?;";
 
     sqlite3_stmt* stmt = nullptr;
     int rc = sqlite3_prepare_v2(handle, sql, -1, &stmt, nullptr);
@@ -125,3 +138,137 @@ double Statistics::calculateGroupSubjectAverage(Database& db,
     sqlite3_finalize(stmt);
     return avg;
 }
+
+double Statistics::percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0.0;
+    if (p <= 0.0) return sorted.front();
+    if (p >= 1.0) return sorted.back();
+
+    const double pos = p * static_cast<double>(sorted.size() - 1);
+    const size_t lo = static_cast<size_t>(pos);
+    const double frac = pos - static_cast<double>(lo);
+    if (lo + 1 >= sorted.size()) return sorted.back();
+    return sorted[lo] + (sorted[lo + 1] - sorted[lo]) * frac;
+}
+
+GroupReport Statistics::computeGroupReport(Database& db,
+                                           int groupId,
+                                           int semesterId,
+                                           int subjectId)
+{
+    GroupReport report;
+
+    sqlite3* handle = db.rawHandle();
+    if (!handle) {
+        std::cerr << "[✗] Statistics: нет соединения с БД\n";
+        return report;
+    }
+
+    // Без миграции 2 те же суммы собираются из grades/absences
+    const std::string source = db.hasStudentStats()
+        ? "studentstats"
+        : "(SELECT studentid, subjectid, semesterid, value AS gradesum, 1 AS gradecount,"
+          "        0 AS absencehours, 0 AS unexcusedhours FROM grades"
+          " UNION ALL"
+          " SELECT studentid, subjectid, semesterid, 0, 0, hours,"
+          "        CASE WHEN COALESCE(type, '') <> 'excused' THEN hours ELSE 0 END FROM absences)";
+
+    // Строка на (студент, предмет); студент без записей — одна строка с NULL-предметом
+    const std::string sql =
+        "SELECT u.id, u.name, s.subjectid, sub.name, "
+        "       COALESCE(SUM(s.gradesum), 0), COALESCE(SUM(s.gradecount), 0), "
+        "       COALESCE(SUM(s.absencehours), 0), COALESCE(SUM(s.unexcusedhours), 0) "
+        "FROM users u "
+        "LEFT JOIN " + source + " s ON s.studentid = u.id AND s.semesterid = ?1 "
+        "                          AND (?2 = 0 OR s.subjectid = ?2) "
+        "LEFT JOIN subjects sub ON sub.id = s.subjectid "
+        "WHERE u.role = 'student' AND u.groupid = ?3 "
+        "GROUP BY u.id, s.subjectid "
+        "ORDER BY u.name, u.id, sub.name;";
+
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(handle, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "[✗] Statistics: prepare error: "
+                  << sqlite3_errmsg(handle) << "\n";
+        return report;
+    }
+
+    sqlite3_bind_int(stmt, 1, semesterId);
+    sqlite3_bind_int(stmt, 2, subjectId);
+    sqlite3_bind_int(stmt, 3, groupId);
+
+    // Суммы оценок студентов, пока не поделены
+    std::vector<long long> gradeSums;
+
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const int studentId = sqlite3_column_int(stmt, 0);
+        if (report.students.empty() || report.students.back().studentId != studentId) {
+            StudentReport st;
+            st.studentId = studentId;
+            const unsigned char* name = sqlite3_column_text(stmt, 1);
+            st.name = name ? reinterpret_cast<const char*>(name) : "";
+            report.students.push_back(std::move(st));
+            gradeSums.push_back(0);
+        }
+        if (sqlite3_column_type(stmt, 2) == SQLITE_NULL) continue;
+
+        SubjectStats subj;
+        subj.subjectId = sqlite3_column_int(stmt, 2);
+        const unsigned char* subjName = sqlite3_column_text(stmt, 3);
+        subj.subjectName = subjName ? reinterpret_cast<const char*>(subjName) : "";
+        const long long gradeSum = sqlite3_column_int64(stmt, 4);
+        subj.gradeCount = sqlite3_column_int(stmt, 5);
+        subj.absenceHours = sqlite3_column_int(stmt, 6);
+        subj.unexcusedHours = sqlite3_column_int(stmt, 7);
+        // Строки сводки обнуляются удалениями, но не удаляются
+        if (subj.gradeCount == 0 && subj.absenceHours == 0) continue;
+        if (subj.gradeCount > 0) {
+            subj.average = static_cast<double>(gradeSum) / subj.gradeCount;
+        }
+
+        StudentReport& st = report.students.back();
+        gradeSums.back() += gradeSum;
+        st.gradeCount += subj.gradeCount;
+        st.absenceHours += subj.absenceHours;
+        st.unexcusedHours += subj.unexcusedHours;
+        st.subjects.push_back(std::move(subj));
+    }
+
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[✗] Statistics: step error: "
+                  << sqlite3_errmsg(handle) << "\n";
+        sqlite3_finalize(stmt);
+        return GroupReport{};
+    }
+    sqlite3_finalize(stmt);
+
+    std::vector<double> averages;
+    averages.reserve(report.students.size());
+    double total = 0.0;
+    for (size_t i = 0; i < report.students.size(); ++i) {
+        StudentReport& st = report.students[i];
+        report.gradeCount += st.gradeCount;
+        report.absenceHours += st.absenceHours;
+        report.unexcusedHours += st.unexcusedHours;
+        if (st.gradeCount > 0) {
+            st.average = static_cast<double>(gradeSums[i]) / st.gradeCount;
+            averages.push_back(st.average);
+            total += st.average;
+        }
+    }
+
+    std::sort(averages.begin(), averages.end());
+    report.gradedStudents = static_cast<int>(averages.size());
+    if (!averages.empty()) {
+        report.mean = total / static_cast<double>(averages.size());
+        report.median = percentile(averages, 0.5);
+        report.p25 = percentile(averages, 0.25);
+        report.p75 = percentile(averages, 0.75);
+        report.p90 = percentile(averages, 0.9);
+    }
+
+    report.ok = true;
+    return report;
+}
@@ -1,7 +1,50 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 class Database;
 
+// Итоги студента по одному предмету за семестр
+struct SubjectStats {
+    int subjectId = 0;
+    std::string subjectName;
+    double average = 0.0;  // 0, если оценок нет
+    int gradeCount = 0;
+    int absenceHours = 0;
+    int unexcusedHours = 0;
+};
+
+struct StudentReport {
+    int studentId = 0;
+    std::string name;
+    std::vector<SubjectStats> subjects;  // по имени предмета, только предметы с записями
+
+    // По всем оценкам студента (не среднее средних по предметам)
+    double average = 0.0;
+    int gradeCount = 0;
+    int absenceHours = 0;
+    int unexcusedHours = 0;
+};
+
+// Отчёт по группе за семестр. Распределение — по средним баллам студентов,
+// у которых есть оценки; студенты без оценок в него не входят.
+struct GroupReport {
+    bool ok = false;
+    std::vector<StudentReport> students;  // по имени, включая студентов без записей
+
+    int gradedStudents = 0;
+    double mean = 0.0;
+    double median = 0.0;
+    double p25 = 0.0;
+    double p75 = 0.0;
+    double p90 = 0.0;
+
+    int gradeCount = 0;
+    int absenceHours = 0;
+    int unexcusedHours = 0;
+};
+
 class Statistics {
 public:
     static double calculateStudentAverage(Database& db,
@@ -17,4 +60,14 @@ public:
                                                int groupId,
                                                int subjectId,
                                                int semesterId);
+
+    // Вся группа одним агрегирующим запросом (студент × предмет) и одним проходом в памяти.
+    // subjectId = 0 — все предметы, иначе итоги студентов только по этому предмету.
+    static GroupReport computeGroupReport(Database& db,
+                                          int groupId,
+                                          int semesterId,
+                                          int subjectId = 0);
+
+    // Перцентиль p (0..1) отсортированной по возрастанию выборки, линейная интерполяция
+    static double percentile(const std::vector<double>& sorted, double p);
 };
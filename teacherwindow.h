@@ -98,6 +98,7 @@ private:
     QComboBox* absenceTypeCombo = nullptr;
     QPushButton* saveAbsenceButton = nullptr;
     QLabel* currentAbsenceLabel = nullptr;
+    QPushButton* journalBatchButton = nullptr;
 
     // Group stats tab
     QComboBox* statsGroupCombo = nullptr;
@@ -125,6 +126,7 @@ private:
     void reloadSchedule();
     void reloadJournalStudents();
     void reloadJournalLessonsForSelectedStudent();
+    void fillJournalLessonsTable();
     void reloadGroupStats();
     void reloadGroupStatsSubjects();
     void reloadStatsStudentDetails(int studentId);
@@ -145,6 +147,7 @@ private slots:
     void onJournalLessonSelectionChanged();
     void onSaveGrade();
     void onSaveAbsence();
+    void openJournalBatchDialog();
 
     void onStatsGroupChanged(int);
     void onStatsSubjectChanged(int);
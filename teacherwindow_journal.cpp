@@ -1,6 +1,7 @@
 #include "teacherwindow.h"
 
 #include "ui/models/WeekSelection.h"
+#include "ui/util/DbExecutor.h"
 #include "ui/util/UiStyle.h"
 #include "ui/widgets/PeriodSelectorWidget.h"
 
@@ -30,6 +31,7 @@
 #include <QVBoxLayout>
 
 #include <algorithm>
+#include <unordered_map>
 
 namespace {
 
@@ -180,6 +182,12 @@ QWidget* TeacherWindow::buildJournalTab()
     topRow->addWidget(journalGroupCombo);
 
     topRow->addStretch();
+
+    journalBatchButton = new QPushButton("Вся группа…", root);
+    journalBatchButton->setToolTip("Оценки и пропуски всех студентов за выбранную пару, сохранение одной транзакцией");
+    journalBatchButton->setEnabled(false);
+    topRow->addWidget(journalBatchButton);
+
     layout->addLayout(topRow);
 
     auto* journalRoot = new QSplitter(Qt::Horizontal, root);
@@ -425,6 +433,7 @@ QWidget* TeacherWindow::buildJournalTab()
 
     connect(saveGradeButton, &QPushButton::clicked, this, &TeacherWindow::onSaveGrade);
     connect(saveAbsenceButton, &QPushButton::clicked, this, &TeacherWindow::onSaveAbsence);
+    connect(journalBatchButton, &QPushButton::clicked, this, &TeacherWindow::openJournalBatchDialog);
 
     onJournalPeriodChanged(journalPeriodSelector->currentSelection());
 
@@ -626,6 +635,204 @@ void TeacherWindow::openAbsenceDialog()
     refreshJournalCurrentValues();
 }
 
+void TeacherWindow::openJournalBatchDialog()
+{
+    if (!db) return;
+    if (!selectedLesson.valid || selectedLesson.subjectId <= 0 || selectedLesson.dateISO.isEmpty()) {
+        QMessageBox::warning(this, "Журнал", "Сначала выберите пару.");
+        return;
+    }
+    if (!journalStudentsTable || journalStudentsTable->rowCount() == 0) {
+        QMessageBox::warning(this, "Журнал", "В группе нет студентов.");
+        return;
+    }
+
+    const int semesterId = defaultSemesterId();
+    if (semesterId <= 0) return;
+
+    const int subjectId = selectedLesson.subjectId;
+    const std::string date = selectedLesson.dateISO.toStdString();
+    const bool lecture = selectedLesson.lessonType.contains("ЛК");
+
+    enum Column { ColStudent = 0, ColGrade, ColHours, ColType, ColResult, ColumnCount };
+
+    QDialog dlg(this);
+    dlg.setWindowTitle("Журнал: вся группа");
+    dlg.resize(720, 560);
+    auto* root = new QVBoxLayout(&dlg);
+
+    auto* info = new QLabel(QString("<b>%1</b><br>%2, пара %3%4")
+                            .arg(selectedLesson.subjectName)
+                            .arg(formatDdMm(selectedLesson.dateISO))
+                            .arg(selectedLesson.lessonNumber)
+                            .arg(lecture ? " — лекция, только пропуски" : ""), &dlg);
+    info->setWordWrap(true);
+    root->addWidget(info);
+
+    auto* grid = new QTableWidget(journalStudentsTable->rowCount(), ColumnCount, &dlg);
+    UiStyle::applyStandardTableStyle(grid);
+    grid->setHorizontalHeaderLabels({"Студент", "Оценка", "Пропуск, ч", "Тип", "Результат"});
+    grid->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    grid->horizontalHeader()->setSectionResizeMode(ColStudent, QHeaderView::Stretch);
+    grid->setSelectionMode(QAbstractItemView::NoSelection);
+    root->addWidget(grid, 1);
+
+    auto* summary = new QLabel(&dlg);
+    UiStyle::makeInfoLabel(summary);
+    root->addWidget(summary);
+
+    struct RowEditors {
+        int studentId = 0;
+        QSpinBox* grade = nullptr;
+        QSpinBox* hours = nullptr;
+        QComboBox* type = nullptr;
+    };
+    std::vector<RowEditors> editors(static_cast<size_t>(grid->rowCount()));
+
+    for (int row = 0; row < grid->rowCount(); ++row) {
+        RowEditors& ed = editors[static_cast<size_t>(row)];
+        const auto* idItem = journalStudentsTable->item(row, 0);
+        const auto* nameItem = journalStudentsTable->item(row, 1);
+        ed.studentId = idItem ? idItem->text().toInt() : 0;
+
+        auto* name = new QTableWidgetItem(nameItem ? nameItem->text() : QString("Студент %1").arg(ed.studentId));
+        name->setFlags(name->flags() & ~Qt::ItemIsEditable);
+        grid->setItem(row, ColStudent, name);
+
+        ed.grade = new QSpinBox(grid);
+        ed.grade->setRange(-1, 10);
+        ed.grade->setSpecialValueText("—");
+        ed.grade->setValue(-1);
+        ed.grade->setEnabled(!lecture);
+        grid->setCellWidget(row, ColGrade, ed.grade);
+
+        ed.hours = new QSpinBox(grid);
+        ed.hours->setRange(0, 8);
+        ed.hours->setSpecialValueText("—");
+        ed.hours->setValue(0);
+        grid->setCellWidget(row, ColHours, ed.hours);
+
+        ed.type = new QComboBox(grid);
+        ed.type->addItem("Уважительный", "excused");
+        ed.type->addItem("Неуважительный", "unexcused");
+        ed.type->setCurrentIndex(1);
+        grid->setCellWidget(row, ColType, ed.type);
+
+        grid->setItem(row, ColResult, new QTableWidgetItem());
+    }
+
+    // Текущее состояние занятия одним запросом на всю группу; по нему же считаются правки
+    std::unordered_map<int, JournalEntry> baseline;
+    auto loadBaseline = [&]() {
+        baseline.clear();
+        std::vector<JournalEntry> entries;
+        if (!db->getJournalEntries(subjectId, semesterId, date, entries)) return false;
+        for (auto& e : entries) baseline.emplace(e.studentId, std::move(e));
+        return true;
+    };
+
+    if (!loadBaseline()) {
+        QMessageBox::critical(this, "Журнал", "Не удалось загрузить журнал занятия.");
+        return;
+    }
+
+    for (auto& ed : editors) {
+        const auto it = baseline.find(ed.studentId);
+        if (it == baseline.end()) continue;
+        const JournalEntry& e = it->second;
+        if (e.gradeId > 0) ed.grade->setValue(e.gradeValue);
+        if (e.absenceId > 0) {
+            ed.hours->setValue(e.absenceHours);
+            const int idx = ed.type->findData(QString::fromStdString(e.absenceType));
+            if (idx >= 0) ed.type->setCurrentIndex(idx);
+        }
+    }
+    summary->setText(QString("Студентов: %1. Оценка и пропуск одновременно не допускаются.").arg(editors.size()));
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Save | QDialogButtonBox::Close, &dlg);
+    buttons->button(QDialogButtonBox::Save)->setText("Сохранить всё");
+    buttons->button(QDialogButtonBox::Close)->setText("Закрыть");
+    root->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+
+    connect(buttons, &QDialogButtonBox::accepted, &dlg, [&]() {
+        using Action = JournalBatchRow::Action;
+
+        // В пакет идут только изменённые строки
+        std::vector<JournalBatchRow> rows;
+        std::vector<int> rowOfBatch;
+        for (int row = 0; row < static_cast<int>(editors.size()); ++row) {
+            const RowEditors& ed = editors[static_cast<size_t>(row)];
+            if (ed.studentId <= 0) continue;
+
+            const auto it = baseline.find(ed.studentId);
+            const JournalEntry cur = (it != baseline.end()) ? it->second : JournalEntry{};
+
+            JournalBatchRow r;
+            r.studentId = ed.studentId;
+
+            const int grade = ed.grade->value();
+            if (grade < 0 && cur.gradeId > 0) r.grade = Action::Clear;
+            else if (grade >= 0 && (cur.gradeId == 0 || cur.gradeValue != grade)) r.grade = Action::Set;
+            r.gradeValue = grade;
+
+            const int hours = ed.hours->value();
+            const std::string type = ed.type->currentData().toString().toStdString();
+            if (hours == 0 && cur.absenceId > 0) r.absence = Action::Clear;
+            else if (hours > 0 && (cur.absenceId == 0 || cur.absenceHours != hours || cur.absenceType != type)) r.absence = Action::Set;
+            r.absenceHours = hours;
+            r.absenceType = type;
+
+            if (r.grade == Action::Keep && r.absence == Action::Keep) {
+                if (auto* item = grid->item(row, ColResult)) item->setText(QString());
+                continue;
+            }
+            rows.push_back(std::move(r));
+            rowOfBatch.push_back(row);
+        }
+
+        if (rows.empty()) {
+            summary->setText("Изменений нет.");
+            return;
+        }
+
+        std::vector<JournalBatchRowResult> results;
+        const bool ok = db->applyJournalBatch(subjectId, semesterId, date, rows, results);
+
+        int applied = 0;
+        int rejected = 0;
+        for (size_t i = 0; i < results.size(); ++i) {
+            QString text;
+            switch (results[i].status) {
+            case JournalBatchStatus::Applied: text = "сохранено"; ++applied; break;
+            case JournalBatchStatus::Unchanged: text = "без изменений"; break;
+            case JournalBatchStatus::Conflict: text = "конфликт: "; ++rejected; break;
+            case JournalBatchStatus::Invalid: text = "ошибка: "; ++rejected; break;
+            case JournalBatchStatus::Failed: text = "не сохранено: "; ++rejected; break;
+            }
+            text += QString::fromStdString(results[i].message);
+            if (auto* item = grid->item(rowOfBatch[i], ColResult)) item->setText(text);
+        }
+
+        loadBaseline();
+        refreshJournalCurrentValues();
+
+        if (!ok) {
+            summary->setText("Не удалось сохранить: изменения откачены.");
+            return;
+        }
+        if (rejected == 0) {
+            QMessageBox::information(&dlg, "Журнал", QString("Сохранено записей: %1.").arg(applied));
+            dlg.accept();
+            return;
+        }
+        summary->setText(QString("Сохранено: %1, не применено: %2 — см. колонку «Результат».")
+                         .arg(applied).arg(rejected));
+    });
+
+    dlg.exec();
+}
+
 void TeacherWindow::onJournalPeriodChanged(const WeekSelection&)
 {
     reloadJournalLessonsForSelectedStudent();
@@ -643,17 +850,30 @@ void TeacherWindow::reloadJournalStudents()
 
     journalStudentsTable->setRowCount(0);
     const int groupId = journalGroupCombo->currentData().toInt();
-    if (groupId <= 0 || !db) return;
-
-    std::vector<std::pair<int, std::string>> students;
-    if (!db->getStudentsOfGroup(groupId, students)) return;
-
-    for (const auto& st : students) {
-        const int row = journalStudentsTable->rowCount();
-        journalStudentsTable->insertRow(row);
-        journalStudentsTable->setItem(row, 0, new QTableWidgetItem(QString::number(st.first)));
-        journalStudentsTable->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(st.second)));
+    if (groupId <= 0 || !db) {
+        DbExecutor::instance().cancel(DbExecutor::channel(this, "teacher.journal.students"));
+        return;
     }
+
+    using Students = std::vector<std::pair<int, std::string>>;
+    DbExecutor::instance().run<Students>(
+        DbExecutor::channel(this, "teacher.journal.students"),
+        [groupId](Database& wdb) {
+            Students students;
+            if (!wdb.getStudentsOfGroup(groupId, students)) students.clear();
+            return students;
+        },
+        this,
+        [this](const Students& students) {
+            if (!journalStudentsTable) return;
+            journalStudentsTable->setRowCount(0);
+            for (const auto& st : students) {
+                const int row = journalStudentsTable->rowCount();
+                journalStudentsTable->insertRow(row);
+                journalStudentsTable->setItem(row, 0, new QTableWidgetItem(QString::number(st.first)));
+                journalStudentsTable->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(st.second)));
+            }
+        });
 }
 
 void TeacherWindow::reloadJournalLessonsForSelectedStudent()
@@ -672,69 +892,94 @@ void TeacherWindow::reloadJournalLessonsForSelectedStudent()
     if (journalLessonCardGroup) journalLessonCardGroup->setText("—");
     if (journalLessonCardSubgroup) journalLessonCardSubgroup->setText("—");
     if (saveGradeButton) saveGradeButton->setEnabled(false);
+    if (journalBatchButton) journalBatchButton->setEnabled(false);
     refreshJournalCurrentValues();
 
+    const QString channel = DbExecutor::channel(this, "teacher.journal.lessons");
     const int groupId = journalGroupCombo->currentData().toInt();
-    if (groupId <= 0 || !db) return;
+    if (groupId <= 0 || !db) {
+        DbExecutor::instance().cancel(channel);
+        return;
+    }
 
     int weekId = 0;
     int weekOfCycle = 1;
     QString err;
     if (!resolveWeekSelection(journalPeriodSelector->currentSelection(), weekId, weekOfCycle, err)) {
+        DbExecutor::instance().cancel(channel);
         return;
     }
 
     // Strict layout: lessons list should not depend on currently selected student
     const int subgroupFilter = 0;
+    const int tId = teacherId;
 
-    std::vector<std::tuple<int,int,int,int,int,std::string,std::string,std::string>> rows;
-    if (!db->getScheduleForTeacherGroupWeekWithRoom(teacherId, groupId, weekOfCycle, subgroupFilter, rows) || rows.empty()) {
-        return;
-    }
+    // Занятия недели и их даты читаются на потоке DbExecutor, таблица заполняется здесь
+    DbExecutor::instance().run<std::vector<JournalLessonRow>>(
+        channel,
+        [=](Database& wdb) {
+            std::vector<JournalLessonRow> lessonRows;
 
-    const QStringList dayNames = {"Понедельник", "Вторник", "Среда", "Четверг", "Пятница", "Суббота"};
-    const QStringList pairTimes = {
-        "08:30-09:55", "10:05-11:30", "12:00-13:25",
-        "13:35-15:00", "15:30-16:55", "17:05-18:30"
-    };
+            std::vector<std::tuple<int,int,int,int,int,std::string,std::string,std::string>> rows;
+            if (!wdb.getScheduleForTeacherGroupWeekWithRoom(tId, groupId, weekOfCycle, subgroupFilter, rows) || rows.empty()) {
+                return lessonRows;
+            }
 
-    for (const auto& r : rows) {
-        const int scheduleId = std::get<0>(r);
-        const int subjectId = std::get<1>(r);
-        const int weekday = std::get<2>(r);
-        const int lessonNumber = std::get<3>(r);
-        const int subgroup = std::get<4>(r);
-        const QString subjectName = QString::fromStdString(std::get<5>(r));
-        const QString room = QString::fromStdString(std::get<6>(r));
-        const QString lessonType = QString::fromStdString(std::get<7>(r));
-
-        std::string dateISO;
-        if (weekId > 0) db->getDateForWeekdayByWeekId(weekId, weekday, dateISO);
-        else db->getDateForWeekday(weekOfCycle, weekday, dateISO);
-        const QString qISO = QString::fromStdString(dateISO);
-
-        JournalLessonRow rr;
-        rr.lesson.valid = true;
-        rr.lesson.scheduleId = scheduleId;
-        rr.lesson.subjectId = subjectId;
-        rr.lesson.weekday = weekday;
-        rr.lesson.subgroup = subgroup;
-        rr.lesson.subjectName = subjectName;
-        rr.lesson.room = room;
-        rr.lesson.lessonType = lessonType;
-        rr.lesson.dateISO = qISO;
-        rr.lesson.lessonNumber = lessonNumber;
-        rr.weekdayName = (weekday >= 0 && weekday < dayNames.size()) ? dayNames[weekday] : QString();
-        rr.timeText = (lessonNumber >= 1 && lessonNumber <= 6) ? pairTimes[lessonNumber - 1] : QString();
-
-        journalLessonRows.push_back(rr);
-    }
+            const QStringList dayNames = {"Понедельник", "Вторник", "Среда", "Четверг", "Пятница", "Суббота"};
+            const QStringList pairTimes = {
+                "08:30-09:55", "10:05-11:30", "12:00-13:25",
+                "13:35-15:00", "15:30-16:55", "17:05-18:30"
+            };
+
+            lessonRows.reserve(rows.size());
+            for (const auto& r : rows) {
+                const int scheduleId = std::get<0>(r);
+                const int subjectId = std::get<1>(r);
+                const int weekday = std::get<2>(r);
+                const int lessonNumber = std::get<3>(r);
+                const int subgroup = std::get<4>(r);
+                const QString subjectName = QString::fromStdString(std::get<5>(r));
+                const QString room = QString::fromStdString(std::get<6>(r));
+                const QString lessonType = QString::fromStdString(std::get<7>(r));
+
+                std::string dateISO;
+                if (weekId > 0) wdb.getDateForWeekdayByWeekId(weekId, weekday, dateISO);
+                else wdb.getDateForWeekday(weekOfCycle, weekday, dateISO);
+                const QString qISO = QString::fromStdString(dateISO);
+
+                JournalLessonRow rr;
+                rr.lesson.valid = true;
+                rr.lesson.scheduleId = scheduleId;
+                rr.lesson.subjectId = subjectId;
+                rr.lesson.weekday = weekday;
+                rr.lesson.subgroup = subgroup;
+                rr.lesson.subjectName = subjectName;
+                rr.lesson.room = room;
+                rr.lesson.lessonType = lessonType;
+                rr.lesson.dateISO = qISO;
+                rr.lesson.lessonNumber = lessonNumber;
+                rr.weekdayName = (weekday >= 0 && weekday < dayNames.size()) ? dayNames[weekday] : QString();
+                rr.timeText = (lessonNumber >= 1 && lessonNumber <= 6) ? pairTimes[lessonNumber - 1] : QString();
+
+                lessonRows.push_back(rr);
+            }
 
-    std::sort(journalLessonRows.begin(), journalLessonRows.end(), [](const JournalLessonRow& a, const JournalLessonRow& b) {
-        if (a.lesson.dateISO != b.lesson.dateISO) return a.lesson.dateISO < b.lesson.dateISO;
-        return a.lesson.lessonNumber < b.lesson.lessonNumber;
-    });
+            std::sort(lessonRows.begin(), lessonRows.end(), [](const JournalLessonRow& a, const JournalLessonRow& b) {
+                if (a.lesson.dateISO != b.lesson.dateISO) return a.lesson.dateISO < b.lesson.dateISO;
+                return a.lesson.lessonNumber < b.lesson.lessonNumber;
+            });
+            return lessonRows;
+        },
+        this,
+        [this](const std::vector<JournalLessonRow>& lessonRows) {
+            if (!journalLessonsTable) return;
+            journalLessonRows = lessonRows;
+            fillJournalLessonsTable();
+        });
+}
 
+void TeacherWindow::fillJournalLessonsTable()
+{
     journalLessonsTable->setRowCount(static_cast<int>(journalLessonRows.size()));
     for (int i = 0; i < static_cast<int>(journalLessonRows.size()); ++i) {
         const auto& rr = journalLessonRows[i];
@@ -839,6 +1084,7 @@ void TeacherWindow::onJournalLessonCardClicked(int index)
     if (saveGradeButton) {
         saveGradeButton->setEnabled(!selectedLesson.lessonType.contains("ЛК"));
     }
+    if (journalBatchButton) journalBatchButton->setEnabled(selectedLesson.valid);
 
     refreshJournalCurrentValues();
 }
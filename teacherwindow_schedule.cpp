@@ -1,6 +1,7 @@
 #include "teacherwindow.h"
 
 #include "ui/models/WeekSelection.h"
+#include "ui/util/DbExecutor.h"
 #include "ui/widgets/PeriodSelectorWidget.h"
 #include "ui/widgets/WeekGridScheduleWidget.h"
 
@@ -126,6 +127,7 @@ void TeacherWindow::reloadSchedule()
     int weekOfCycle = 1;
     QString err;
     if (!resolveWeekSelection(schedulePeriodSelector->currentSelection(), weekId, weekOfCycle, err)) {
+        DbExecutor::instance().cancel(DbExecutor::channel(this, "teacher.schedule"));
         scheduleEmptyLabel->setText(err);
         scheduleEmptyLabel->setVisible(true);
         scheduleGrid->setVisible(false);
@@ -137,10 +139,18 @@ void TeacherWindow::reloadSchedule()
     scheduleEmptyLabel->setVisible(false);
     scheduleGrid->setVisible(true);
 
-    if (allGroups) {
-        scheduleGrid->setTeacherScheduleAllGroups(db, teacherId, weekOfCycle, weekId, subgroupFilter);
-    } else {
-        const QString groupName = scheduleGroupCombo ? scheduleGroupCombo->currentText() : QString();
-        scheduleGrid->setTeacherSchedule(db, teacherId, groupId, groupName, weekOfCycle, weekId, subgroupFilter);
-    }
+    // Неделя читается на потоке DbExecutor; при быстром переключении
+    // группы/периода доставляется только последний запрос.
+    const int tId = teacherId;
+    const QString groupName = allGroups ? QString()
+                                        : (scheduleGroupCombo ? scheduleGroupCombo->currentText() : QString());
+    DbExecutor::instance().run<WeekGridScheduleWidget::TeacherWeek>(
+        DbExecutor::channel(this, "teacher.schedule"),
+        [=](Database& wdb) {
+            return WeekGridScheduleWidget::loadTeacherWeek(wdb, tId, groupId, weekOfCycle, weekId, subgroupFilter);
+        },
+        this,
+        [this, groupName, subgroupFilter](const WeekGridScheduleWidget::TeacherWeek& week) {
+            if (scheduleGrid) scheduleGrid->showTeacherWeek(week, groupName, subgroupFilter);
+        });
 }
@@ -1,5 +1,7 @@
 #include "teacherwindow.h"
 
+#include "statistics.h"
+#include "ui/util/DbExecutor.h"
 #include "ui/util/UiStyle.h"
 
 #include <QAbstractItemView>
@@ -13,8 +15,8 @@
 #include <QSplitter>
 #include <QTableWidget>
 #include <QVBoxLayout>
-#include <QDate>
 
+#include <cmath>
 #include <tuple>
 #include <vector>
 
@@ -40,103 +42,141 @@ void TeacherWindow::onStatsStudentSelected()
     reloadStatsStudentDetails(studentId);
 }
 
-void TeacherWindow::reloadStatsStudentDetails(int studentId)
+namespace {
+
+struct StatsGradeRow {
+    QString date;
+    QString time;
+    QString subject;
+    int value = 0;
+    QString lessonType;
+    QString room;
+    QString gradeType;
+};
+
+struct StatsAbsenceRow {
+    QString date;
+    QString time;
+    QString subject;
+    int hours = 0;
+    bool excused = false;
+    QString lessonType;
+    QString room;
+};
+
+struct StatsStudentDetails {
+    std::vector<StatsGradeRow> grades;
+    std::vector<StatsAbsenceRow> absences;
+};
+
+// Время/тип/аудитория занятия записи; номер пары уже найден по LessonSlotIndex группы
+std::tuple<QString, QString, QString> lessonMeta(const StudentLessonRecord& rec)
 {
-    if (!db || studentId <= 0) return;
-    if (!statsDetailGradesTable || !statsDetailAbsencesTable || !statsDetailGradesSummaryLabel || !statsDetailAbsencesSummaryLabel) return;
-    if (!statsGroupCombo || !statsSubjectCombo) return;
-
-    const int groupId = statsGroupCombo->currentData().toInt();
-    const int semesterId = defaultSemesterId();
-    const int subjectId = statsSubjectCombo->currentData().toInt();
-    const QString subjectName = statsSubjectCombo->currentText();
-
-    statsDetailGradesTable->setSortingEnabled(false);
-    statsDetailAbsencesTable->setSortingEnabled(false);
-    statsDetailGradesTable->setRowCount(0);
-    statsDetailAbsencesTable->setRowCount(0);
-
-    const QStringList pairTimes = {
+    static const QStringList pairTimes = {
         "08:30-09:55", "10:05-11:30", "12:00-13:25",
         "13:35-15:00", "15:30-16:55", "17:05-18:30"
     };
 
-    auto resolveLessonMeta = [&](const QString& dateISO, const QString& subj) {
-        QString outTime = "—";
-        QString outType = "—";
-        QString outRoom = "—";
+    QString outTime = "—";
+    QString outType = "—";
+    QString outRoom = "—";
+    if (rec.lessonNumber >= 1 && rec.lessonNumber <= pairTimes.size()) {
+        outTime = pairTimes[rec.lessonNumber - 1];
+    }
+    if (rec.lessonNumber > 0) {
+        if (!rec.lessonType.empty()) outType = QString::fromStdString(rec.lessonType);
+        if (!rec.room.empty()) outRoom = QString::fromStdString(rec.room);
+    }
+    return std::make_tuple(outTime, outType, outRoom);
+}
 
-        if (!db || groupId <= 0 || dateISO.size() < 10 || subj.isEmpty()) {
-            return std::make_tuple(outTime, outType, outRoom);
+// Все чтения для правой панели статистики; выполняется на потоке DbExecutor.
+// Занятия берутся из общего LessonSlotIndexCache, без запросов расписания на каждую строку.
+StatsStudentDetails loadStatsStudentDetails(Database& db, int studentId, int semesterId, int subjectId)
+{
+    StatsStudentDetails out;
+
+    std::vector<StudentLessonRecord> grades;
+    if (db.getStudentGradesWithLessons(studentId, semesterId, grades)) {
+        for (const auto& g : grades) {
+            if (subjectId > 0 && g.subjectId != subjectId) continue;
+
+            StatsGradeRow r;
+            r.subject = QString::fromStdString(g.subject);
+            r.value = g.value;
+            r.date = QString::fromStdString(g.date);
+            r.gradeType = QString::fromStdString(g.type);
+            std::tie(r.time, r.lessonType, r.room) = lessonMeta(g);
+            out.grades.push_back(std::move(r));
         }
+    }
 
-        const QDate d = QDate::fromString(dateISO, "yyyy-MM-dd");
-        if (!d.isValid()) {
-            return std::make_tuple(outTime, outType, outRoom);
+    std::vector<StudentLessonRecord> abs;
+    if (db.getStudentAbsencesWithLessons(studentId, semesterId, abs)) {
+        for (const auto& a : abs) {
+            if (subjectId > 0 && a.subjectId != subjectId) continue;
+
+            StatsAbsenceRow r;
+            r.subject = QString::fromStdString(a.subject);
+            r.hours = a.value;
+            r.date = QString::fromStdString(a.date);
+            r.excused = (a.type == "excused");
+            std::tie(r.time, r.lessonType, r.room) = lessonMeta(a);
+            out.absences.push_back(std::move(r));
         }
+    }
 
-        const int weekday = d.dayOfWeek();
-        if (weekday < 1 || weekday > 6) {
-            return std::make_tuple(outTime, outType, outRoom);
-        }
-        const int weekId = db->getWeekIdByDate(dateISO.toStdString());
-        const int weekOfCycle = (weekId > 0) ? db->getWeekOfCycleByWeekId(weekId) : 0;
-        if (weekOfCycle <= 0) {
-            return std::make_tuple(outTime, outType, outRoom);
-        }
+    return out;
+}
 
-        std::vector<std::tuple<int, int, int, std::string, std::string, std::string, std::string>> sched;
-        if (!db->getScheduleForGroup(groupId, weekday, weekOfCycle, sched)) {
-            return std::make_tuple(outTime, outType, outRoom);
-        }
+}
 
-        for (const auto& s : sched) {
-            const int lessonNumber = std::get<1>(s);
-            const QString sSubj = QString::fromStdString(std::get<3>(s));
-            const QString sRoom = QString::fromStdString(std::get<4>(s));
-            const QString sType = QString::fromStdString(std::get<5>(s));
-            if (sSubj == subj) {
-                if (lessonNumber >= 1 && lessonNumber <= pairTimes.size()) {
-                    outTime = pairTimes[lessonNumber - 1];
-                }
-                if (!sType.isEmpty()) outType = sType;
-                if (!sRoom.isEmpty()) outRoom = sRoom;
-                break;
-            }
-        }
+void TeacherWindow::reloadStatsStudentDetails(int studentId)
+{
+    if (!db || studentId <= 0) return;
+    if (!statsDetailGradesTable || !statsDetailAbsencesTable || !statsDetailGradesSummaryLabel || !statsDetailAbsencesSummaryLabel) return;
+    if (!statsGroupCombo || !statsSubjectCombo) return;
 
-        return std::make_tuple(outTime, outType, outRoom);
-    };
+    const int semesterId = defaultSemesterId();
+    const int subjectId = statsSubjectCombo->currentData().toInt();
 
-    // ===== detailed grades =====
-    double sum = 0.0;
-    int cnt = 0;
-    if (subjectId > 0) {
-        std::vector<std::tuple<int, std::string, std::string>> grades;
-        if (db->getStudentSubjectGrades(studentId, subjectId, semesterId, grades)) {
-            for (const auto& g : grades) {
-                const int value = std::get<0>(g);
-                const QString date = QString::fromStdString(std::get<1>(g));
-                const QString gType = QString::fromStdString(std::get<2>(g));
-                const auto [time, ltype, room] = resolveLessonMeta(date, subjectName);
+    statsDetailGradesTable->setSortingEnabled(false);
+    statsDetailAbsencesTable->setSortingEnabled(false);
+    statsDetailGradesTable->setRowCount(0);
+    statsDetailAbsencesTable->setRowCount(0);
 
+    DbExecutor::instance().run<StatsStudentDetails>(
+        DbExecutor::channel(this, "teacher.stats.details"),
+        [=](Database& wdb) {
+            return loadStatsStudentDetails(wdb, studentId, semesterId, subjectId);
+        },
+        this,
+        [this](const StatsStudentDetails& details) {
+            if (!statsDetailGradesTable || !statsDetailAbsencesTable) return;
+            statsDetailGradesTable->setRowCount(0);
+            statsDetailAbsencesTable->setRowCount(0);
+
+            // ===== detailed grades =====
+            double sum = 0.0;
+            int cnt = 0;
+            for (const auto& g : details.grades) {
                 const int row = statsDetailGradesTable->rowCount();
                 statsDetailGradesTable->insertRow(row);
-                statsDetailGradesTable->setItem(row, 0, new QTableWidgetItem(date));
-                statsDetailGradesTable->setItem(row, 1, new QTableWidgetItem(time));
-                statsDetailGradesTable->setItem(row, 2, new QTableWidgetItem(subjectName));
+                statsDetailGradesTable->setItem(row, 0, new QTableWidgetItem(g.date));
+                statsDetailGradesTable->setItem(row, 1, new QTableWidgetItem(g.time));
+                statsDetailGradesTable->setItem(row, 2, new QTableWidgetItem(g.subject));
 
-                auto* badge = new QLabel(QString::number(value), statsDetailGradesTable);
+                auto* badge = new QLabel(QString::number(g.value), statsDetailGradesTable);
                 badge->setAlignment(Qt::AlignCenter);
                 badge->setMinimumHeight(22);
-                badge->setStyleSheet(UiStyle::badgeGradeStyle(value));
+                badge->setStyleSheet(UiStyle::badgeGradeStyle(g.value));
                 statsDetailGradesTable->setCellWidget(row, 3, badge);
 
-                if (!ltype.isEmpty() && ltype != "—") {
-                    auto* ltBadge = new QLabel(ltype, statsDetailGradesTable);
+                if (!g.lessonType.isEmpty() && g.lessonType != "—") {
+                    auto* ltBadge = new QLabel(g.lessonType, statsDetailGradesTable);
                     ltBadge->setAlignment(Qt::AlignCenter);
                     ltBadge->setMinimumHeight(22);
-                    ltBadge->setStyleSheet(UiStyle::badgeLessonTypeStyle(ltype));
+                    ltBadge->setStyleSheet(UiStyle::badgeLessonTypeStyle(g.lessonType));
                     statsDetailGradesTable->setCellWidget(row, 4, ltBadge);
                 } else {
                     auto* it = new QTableWidgetItem("—");
@@ -144,120 +184,65 @@ void TeacherWindow::reloadStatsStudentDetails(int studentId)
                     statsDetailGradesTable->setItem(row, 4, it);
                 }
 
-                statsDetailGradesTable->setItem(row, 5, new QTableWidgetItem(room));
-                statsDetailGradesTable->setItem(row, 6, new QTableWidgetItem(gType.isEmpty() ? "" : gType));
+                statsDetailGradesTable->setItem(row, 5, new QTableWidgetItem(g.room));
+                statsDetailGradesTable->setItem(row, 6, new QTableWidgetItem(g.gradeType));
 
-                sum += value;
+                sum += g.value;
                 ++cnt;
             }
-        }
-    } else {
-        std::vector<std::tuple<std::string, int, std::string, std::string>> grades;
-        if (db->getStudentGradesForSemester(studentId, semesterId, grades)) {
-            for (const auto& g : grades) {
-                const QString subj = QString::fromStdString(std::get<0>(g));
-                const int value = std::get<1>(g);
-                const QString date = QString::fromStdString(std::get<2>(g));
-                const QString gType = QString::fromStdString(std::get<3>(g));
-                const auto [time, ltype, room] = resolveLessonMeta(date, subj);
-
-                const int row = statsDetailGradesTable->rowCount();
-                statsDetailGradesTable->insertRow(row);
-                statsDetailGradesTable->setItem(row, 0, new QTableWidgetItem(date));
-                statsDetailGradesTable->setItem(row, 1, new QTableWidgetItem(time));
-                statsDetailGradesTable->setItem(row, 2, new QTableWidgetItem(subj));
 
-                auto* badge = new QLabel(QString::number(value), statsDetailGradesTable);
-                badge->setAlignment(Qt::AlignCenter);
-                badge->setMinimumHeight(22);
-                badge->setStyleSheet(UiStyle::badgeGradeStyle(value));
-                statsDetailGradesTable->setCellWidget(row, 3, badge);
-
-                if (!ltype.isEmpty() && ltype != "—") {
-                    auto* ltBadge = new QLabel(ltype, statsDetailGradesTable);
+            const double avg = (cnt > 0) ? (sum / cnt) : 0.0;
+            statsDetailGradesSummaryLabel->setText(QString("Оценки: %1 записей, средний %2")
+                                                  .arg(cnt)
+                                                  .arg(cnt > 0 ? QString::number(avg, 'f', 2) : "—"));
+
+            // ===== detailed absences =====
+            int totalH = 0;
+            int unexcH = 0;
+            for (const auto& a : details.absences) {
+                const int row = statsDetailAbsencesTable->rowCount();
+                statsDetailAbsencesTable->insertRow(row);
+                statsDetailAbsencesTable->setItem(row, 0, new QTableWidgetItem(a.date));
+                statsDetailAbsencesTable->setItem(row, 1, new QTableWidgetItem(a.time));
+                statsDetailAbsencesTable->setItem(row, 2, new QTableWidgetItem(a.subject));
+
+                auto* hItem = new QTableWidgetItem(QString::number(a.hours));
+                hItem->setTextAlignment(Qt::AlignCenter);
+                statsDetailAbsencesTable->setItem(row, 3, hItem);
+
+                auto* typeBadge = new QLabel(a.excused ? "Уважительный" : "Неуважительный", statsDetailAbsencesTable);
+                typeBadge->setAlignment(Qt::AlignCenter);
+                typeBadge->setMinimumHeight(22);
+                typeBadge->setStyleSheet(UiStyle::badgeAbsenceStyle(a.excused));
+                statsDetailAbsencesTable->setCellWidget(row, 4, typeBadge);
+
+                if (!a.lessonType.isEmpty() && a.lessonType != "—") {
+                    auto* ltBadge = new QLabel(a.lessonType, statsDetailAbsencesTable);
                     ltBadge->setAlignment(Qt::AlignCenter);
                     ltBadge->setMinimumHeight(22);
-                    ltBadge->setStyleSheet(UiStyle::badgeLessonTypeStyle(ltype));
-                    statsDetailGradesTable->setCellWidget(row, 4, ltBadge);
+                    ltBadge->setStyleSheet(UiStyle::badgeLessonTypeStyle(a.lessonType));
+                    statsDetailAbsencesTable->setCellWidget(row, 5, ltBadge);
                 } else {
                     auto* it = new QTableWidgetItem("—");
                     it->setTextAlignment(Qt::AlignCenter);
-                    statsDetailGradesTable->setItem(row, 4, it);
+                    statsDetailAbsencesTable->setItem(row, 5, it);
                 }
 
-                statsDetailGradesTable->setItem(row, 5, new QTableWidgetItem(room));
-                statsDetailGradesTable->setItem(row, 6, new QTableWidgetItem(gType.isEmpty() ? "" : gType));
+                statsDetailAbsencesTable->setItem(row, 6, new QTableWidgetItem(a.room));
 
-                sum += value;
-                ++cnt;
+                totalH += a.hours;
+                if (!a.excused) unexcH += a.hours;
             }
-        }
-    }
 
-    const double avg = (cnt > 0) ? (sum / cnt) : 0.0;
-    statsDetailGradesSummaryLabel->setText(QString("Оценки: %1 записей, средний %2")
-                                          .arg(cnt)
-                                          .arg(cnt > 0 ? QString::number(avg, 'f', 2) : "—"));
+            statsDetailAbsencesSummaryLabel->setText(QString("Пропуски: всего %1 ч, неуважительных %2 ч")
+                                                    .arg(totalH)
+                                                    .arg(unexcH));
 
-    // ===== detailed absences =====
-    int totalH = 0;
-    int unexcH = 0;
-    std::vector<std::tuple<std::string, int, std::string, std::string>> abs;
-    if (db->getStudentAbsencesForSemester(studentId, semesterId, abs)) {
-        for (const auto& a : abs) {
-            const QString subj = QString::fromStdString(std::get<0>(a));
-            const int hours = std::get<1>(a);
-            const QString date = QString::fromStdString(std::get<2>(a));
-            const QString type = QString::fromStdString(std::get<3>(a));
-
-            if (subjectId > 0 && subj != subjectName) continue;
-
-            const auto [time, ltype, room] = resolveLessonMeta(date, subj);
-
-            const int row = statsDetailAbsencesTable->rowCount();
-            statsDetailAbsencesTable->insertRow(row);
-            statsDetailAbsencesTable->setItem(row, 0, new QTableWidgetItem(date));
-            statsDetailAbsencesTable->setItem(row, 1, new QTableWidgetItem(time));
-            statsDetailAbsencesTable->setItem(row, 2, new QTableWidgetItem(subj));
-
-            auto* hItem = new QTableWidgetItem(QString::number(hours));
-            hItem->setTextAlignment(Qt::AlignCenter);
-            statsDetailAbsencesTable->setItem(row, 3, hItem);
-
-            const bool excused = (type == "excused");
-            auto* typeBadge = new QLabel(excused ? "Уважительный" : "Неуважительный", statsDetailAbsencesTable);
-            typeBadge->setAlignment(Qt::AlignCenter);
-            typeBadge->setMinimumHeight(22);
-            typeBadge->setStyleSheet(UiStyle::badgeAbsenceStyle(excused));
-            statsDetailAbsencesTable->setCellWidget(row, 4, typeBadge);
-
-            if (!ltype.isEmpty() && ltype != "—") {
-                auto* ltBadge = new QLabel(ltype, statsDetailAbsencesTable);
-                ltBadge->setAlignment(Qt::AlignCenter);
-                ltBadge->setMinimumHeight(22);
-                ltBadge->setStyleSheet(UiStyle::badgeLessonTypeStyle(ltype));
-                statsDetailAbsencesTable->setCellWidget(row, 5, ltBadge);
-            } else {
-                auto* it = new QTableWidgetItem("—");
-                it->setTextAlignment(Qt::AlignCenter);
-                statsDetailAbsencesTable->setItem(row, 5, it);
-            }
-
-            statsDetailAbsencesTable->setItem(row, 6, new QTableWidgetItem(room));
-
-            totalH += hours;
-            if (!excused) unexcH += hours;
-        }
-    }
-
-    statsDetailAbsencesSummaryLabel->setText(QString("Пропуски: всего %1 ч, неуважительных %2 ч")
-                                            .arg(totalH)
-                                            .arg(unexcH));
-
-    statsDetailGradesTable->setSortingEnabled(true);
-    statsDetailAbsencesTable->setSortingEnabled(true);
-    statsDetailGradesTable->sortItems(0, Qt::DescendingOrder);
-    statsDetailAbsencesTable->sortItems(0, Qt::DescendingOrder);
+            statsDetailGradesTable->setSortingEnabled(true);
+            statsDetailAbsencesTable->setSortingEnabled(true);
+            statsDetailGradesTable->sortItems(0, Qt::DescendingOrder);
+            statsDetailAbsencesTable->sortItems(0, Qt::DescendingOrder);
+        });
 }
 
 QWidget* TeacherWindow::buildGroupStatsTab()
@@ -319,9 +304,10 @@ QWidget* TeacherWindow::buildGroupStatsTab()
 
     statsGradesTable = new QTableWidget(studentsBox);
     UiStyle::applyStandardTableStyle(statsGradesTable);
-    statsGradesTable->setColumnCount(1);
-    statsGradesTable->setHorizontalHeaderLabels({"ФИО"});
-    statsGradesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    statsGradesTable->setColumnCount(5);
+    statsGradesTable->setHorizontalHeaderLabels({"ФИО", "Средний", "Оценок", "Пропуски, ч", "Неуваж., ч"});
+    statsGradesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    statsGradesTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
     statsGradesTable->setSortingEnabled(true);
     statsGradesTable->setSelectionMode(QAbstractItemView::SingleSelection);
     statsGradesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -484,30 +470,74 @@ void TeacherWindow::reloadGroupStats()
 
     statsGradesTable->setRowCount(0);
 
+    // Смена группы/предмета делает устаревшими прошлые загрузки вкладки
+    DbExecutor::instance().cancel(DbExecutor::channel(this, "teacher.stats.details"));
+    DbExecutor::instance().cancel(DbExecutor::channel(this, "teacher.stats.students"));
+
     if (groupId <= 0 || semesterId <= 0) {
         statsGradesSummaryLabel->setText("Студенты: выберите группу и семестр");
         return;
     }
 
-    std::vector<std::pair<int, std::string>> students;
-    if (!db->getStudentsOfGroup(groupId, students)) {
-        statsGradesSummaryLabel->setText("Студенты: не удалось загрузить");
-        return;
-    }
-
-    for (const auto& st : students) {
-        const int studentId = st.first;
-        const QString studentName = QString::fromStdString(st.second);
+    statsGradesSummaryLabel->setText("Студенты: загрузка…");
 
-        const int row = statsGradesTable->rowCount();
-        statsGradesTable->insertRow(row);
-        auto* nameItem = new QTableWidgetItem(studentName.isEmpty() ? QString("ID %1").arg(studentId) : studentName);
-        nameItem->setData(Qt::UserRole, studentId);
-        statsGradesTable->setItem(row, 0, nameItem);
-    }
+    const int subjectId = statsSubjectCombo->currentData().toInt();
+    DbExecutor::instance().run<GroupReport>(
+        DbExecutor::channel(this, "teacher.stats.students"),
+        [groupId, semesterId, subjectId](Database& wdb) {
+            return Statistics::computeGroupReport(wdb, groupId, semesterId, subjectId);
+        },
+        this,
+        [this](const GroupReport& report) {
+            if (!statsGradesTable || !statsGradesSummaryLabel) return;
+            if (!report.ok) {
+                statsGradesSummaryLabel->setText("Студенты: не удалось загрузить");
+                return;
+            }
 
-    statsGradesSummaryLabel->setText(QString("Студенты: %1").arg(statsGradesTable->rowCount()));
-    statsGradesTable->sortItems(0, Qt::AscendingOrder);
+            // Числа кладём в DisplayRole как double/int, чтобы сортировка по столбцу была числовой
+            auto numberItem = [](const QVariant& value) {
+                auto* it = new QTableWidgetItem();
+                it->setData(Qt::DisplayRole, value);
+                it->setTextAlignment(Qt::AlignCenter);
+                return it;
+            };
+
+            statsGradesTable->setSortingEnabled(false);
+            statsGradesTable->setRowCount(0);
+            for (const auto& st : report.students) {
+                const QString studentName = QString::fromStdString(st.name);
+
+                const int row = statsGradesTable->rowCount();
+                statsGradesTable->insertRow(row);
+                auto* nameItem = new QTableWidgetItem(studentName.isEmpty() ? QString("ID %1").arg(st.studentId) : studentName);
+                nameItem->setData(Qt::UserRole, st.studentId);
+                statsGradesTable->setItem(row, 0, nameItem);
+
+                statsGradesTable->setItem(row, 1, st.gradeCount > 0
+                                                      ? numberItem(std::round(st.average * 100.0) / 100.0)
+                                                      : numberItem(QString("—")));
+                statsGradesTable->setItem(row, 2, numberItem(st.gradeCount));
+                statsGradesTable->setItem(row, 3, numberItem(st.absenceHours));
+                statsGradesTable->setItem(row, 4, numberItem(st.unexcusedHours));
+            }
+            statsGradesTable->setSortingEnabled(true);
+
+            QString summary = QString("Студенты: %1").arg(report.students.size());
+            if (report.gradedStudents > 0) {
+                summary += QString(" · средний %1, медиана %2, P25–P75 %3–%4, P90 %5")
+                               .arg(report.mean, 0, 'f', 2)
+                               .arg(report.median, 0, 'f', 2)
+                               .arg(report.p25, 0, 'f', 2)
+                               .arg(report.p75, 0, 'f', 2)
+                               .arg(report.p90, 0, 'f', 2);
+            }
+            summary += QString(" · пропуски %1 ч (неуваж. %2 ч)")
+                           .arg(report.absenceHours)
+                           .arg(report.unexcusedHours);
+            statsGradesSummaryLabel->setText(summary);
+            statsGradesTable->sortItems(0, Qt::AscendingOrder);
+        });
 }
 
 void TeacherWindow::onStatsGroupChanged(int)
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../database.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+
+// Общая обвязка тестов, которые пишут в school.db: работают с копией во временном
+// каталоге, а не с файлом репозитория. Копия удаляется вместе с -wal/-shm
+// (профиль соединения по умолчанию переводит файл в WAL).
+
+// Удалить файл БД и его -wal/-shm
+inline void removeDbFiles(const std::filesystem::path& file)
+{
+    if (file.empty()) return;
+    std::error_code ec;
+    std::filesystem::remove(file, ec);
+    std::filesystem::remove(file.string() + "-wal", ec);
+    std::filesystem::remove(file.string() + "-shm", ec);
+}
+
+// Копия school.db с фиксированным именем во временном каталоге
+class SchoolDbCopy {
+public:
+    explicit SchoolDbCopy(const std::string& name)
+        : file(std::filesystem::temp_directory_path() / name) {}
+    ~SchoolDbCopy() { remove(); }
+
+    SchoolDbCopy(const SchoolDbCopy&) = delete;
+    SchoolDbCopy& operator=(const SchoolDbCopy&) = delete;
+
+    static bool sourceExists() { return std::filesystem::exists(SCHOOL_DB_PATH); }
+
+    // Свежая копия поверх прежней (соединения к прежней должны быть закрыты)
+    bool refresh()
+    {
+        remove();
+        std::error_code ec;
+        std::filesystem::copy_file(SCHOOL_DB_PATH, file, std::filesystem::copy_options::overwrite_existing, ec);
+        return !ec;
+    }
+
+    // Свежая копия и соединение к ней; nullptr, если скопировать или открыть не удалось
+    std::unique_ptr<Database> open(bool initialize = true)
+    {
+        if (!refresh()) return nullptr;
+        auto db = std::make_unique<Database>(path());
+        if (!db->connect()) return nullptr;
+        if (initialize && !db->initialize()) return nullptr;
+        return db;
+    }
+
+    void remove() { removeDbFiles(file); }
+
+    std::string path() const { return file.string(); }
+
+private:
+    std::filesystem::path file;
+};
+
+// Фикстура: перед каждым тестом — свежая копия school.db и открытое соединение db,
+// после — соединение закрыто, копия удалена. Без school.db тест пропускается.
+// Наследники с собственным SetUp() сначала вызывают SchoolDbTest::SetUp() и выходят,
+// если IsSkipped() || HasFatalFailure().
+class SchoolDbTest : public ::testing::Test {
+protected:
+    explicit SchoolDbTest(const std::string& copyName, bool initialize = true)
+        : dbCopy(copyName), initializeSchema(initialize) {}
+
+    void SetUp() override
+    {
+        if (!SchoolDbCopy::sourceExists()) GTEST_SKIP() << "school.db not found: " << SCHOOL_DB_PATH;
+        db = freshDb();
+        ASSERT_TRUE(db) << "cannot open copy of school.db: " << dbCopy.path();
+    }
+
+    void TearDown() override
+    {
+        db.reset();
+        dbCopy.remove();
+    }
+
+    // Закрыть db и открыть соединение к новой копии school.db (nullptr при ошибке)
+    std::unique_ptr<Database> freshDb()
+    {
+        db.reset();
+        return dbCopy.open(initializeSchema);
+    }
+
+    SchoolDbCopy dbCopy;
+    std::unique_ptr<Database> db;
+
+private:
+    bool initializeSchema = true;
+};
@@ -0,0 +1,139 @@
+#include "../core/connection_pool.h"
+#include "db_copy_fixture.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ConnectionPool: читатели работают параллельно, Lease возвращает соединение в пул,
+// читающие соединения не пишут, запись писателя видна читателям.
+
+namespace {
+
+int countUsers(Database& db)
+{
+    int count = -1;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db.getHandle(), "SELECT COUNT(*) FROM users;", -1, &stmt, nullptr) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+} // namespace
+
+class ConnectionPoolTest : public SchoolDbTest {
+protected:
+    ConnectionPoolTest() : SchoolDbTest("connection_pool_school.db") {}
+
+    void SetUp() override {
+        // Схему создаёт основное соединение, как в main.cpp; пул открывается к тому же файлу
+        SchoolDbTest::SetUp();
+        db.reset();
+    }
+};
+
+TEST_F(ConnectionPoolTest, LeaseReturnsConnection) {
+    ConnectionPool pool(dbCopy.path(), 2, ConnectionProfile::balanced());
+    ASSERT_TRUE(pool.open());
+    EXPECT_EQ(pool.readerCount(), 2);
+
+    Database* first = nullptr;
+    {
+        auto a = pool.read();
+        auto b = pool.read();
+        ASSERT_TRUE(a);
+        ASSERT_TRUE(b);
+        EXPECT_NE(a.get(), b.get());
+        first = a.get();
+    }
+
+    // Оба вернулись — следующие две выдачи без ожидания
+    auto c = pool.read();
+    auto d = pool.read();
+    EXPECT_TRUE(c.get() == first || d.get() == first);
+    EXPECT_EQ(pool.readWaits(), 0u);
+}
+
+TEST_F(ConnectionPoolTest, ReadersAreReadOnly) {
+    ConnectionPool pool(dbCopy.path(), 1, ConnectionProfile::balanced());
+    ASSERT_TRUE(pool.open());
+
+    auto reader = pool.read();
+    ASSERT_TRUE(reader);
+    EXPECT_FALSE(reader->execute("DELETE FROM users;"));
+    EXPECT_GT(countUsers(*reader), 0);
+}
+
+TEST_F(ConnectionPoolTest, WriterCommitVisibleToReaders) {
+    ConnectionPool pool(dbCopy.path(), 2, ConnectionProfile::balanced());
+    ASSERT_TRUE(pool.open());
+
+    int before = 0;
+    {
+        auto reader = pool.read();
+        before = countUsers(*reader);
+    }
+    {
+        auto writer = pool.write();
+        ASSERT_TRUE(writer);
+        ASSERT_TRUE(writer->execute(
+            "INSERT INTO users (username, password, name, role) VALUES ('pool_test', 'x', 'Pool Test', 'student');"));
+    }
+
+    auto reader = pool.read();
+    EXPECT_EQ(countUsers(*reader), before + 1);
+}
+
+TEST_F(ConnectionPoolTest, ConcurrentReaders) {
+    constexpr int kReaders = 4;
+    constexpr int kThreads = 8;
+    constexpr int kIterations = 50;
+
+    ConnectionPool pool(dbCopy.path(), kReaders, ConnectionProfile::balanced());
+    ASSERT_TRUE(pool.open());
+
+    int expected = 0;
+    {
+        auto reader = pool.read();
+        expected = countUsers(*reader);
+    }
+    ASSERT_GT(expected, 0);
+
+    std::atomic<int> mismatches{0};
+    std::atomic<int> inUse{0};
+    std::atomic<int> maxInUse{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < kIterations; ++i) {
+                auto lease = pool.read();
+                const int now = ++inUse;
+                int seen = maxInUse.load();
+                while (now > seen && !maxInUse.compare_exchange_weak(seen, now)) {}
+
+                if (!lease || countUsers(*lease) != expected) ++mismatches;
+                --inUse;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(mismatches.load(), 0);
+    // Одновременно выдано не больше соединений, чем есть в пуле
+    EXPECT_LE(maxInUse.load(), kReaders);
+}
+
+TEST_F(ConnectionPoolTest, ClosedPoolGivesEmptyLease) {
+    ConnectionPool pool(dbCopy.path(), 1, ConnectionProfile::balanced());
+    ASSERT_TRUE(pool.open());
+    pool.close();
+
+    EXPECT_FALSE(pool.isOpen());
+    EXPECT_FALSE(pool.read());
+    EXPECT_FALSE(pool.write());
+}
@@ -0,0 +1,132 @@
+#include "../services/d1_randomizer.h"
+#include "db_copy_fixture.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Golden-тест D1Randomizer: с фиксированным seed генерация на school.db должна давать
+// ровно те же оценки. Если правила или school.db менялись намеренно — пересчитать
+// kGolden* (значения печатаются в сообщении о провале).
+
+namespace {
+
+constexpr std::uint64_t kSeed = 20250901;
+
+// Все группы, все семестры, без перезаписи существующих оценок
+constexpr int kGoldenCreated = 137;
+constexpr int kGoldenRows = 5713;
+constexpr std::uint64_t kGoldenDigest = 18230802529318450904ull;
+
+// FNV-1a по (studentid, subjectid, semesterid, date, value) в порядке ключа
+struct GradesDigest {
+    int rows = 0;
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+
+    void add(const void* data, size_t size) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= p[i];
+            hash *= 0x100000001B3ull;
+        }
+    }
+};
+
+GradesDigest digestGrades(Database& db)
+{
+    GradesDigest d;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db.getHandle(),
+                           "SELECT studentid, subjectid, semesterid, date, value FROM grades "
+                           "ORDER BY studentid, subjectid, semesterid, date;",
+                           -1, &stmt, nullptr) != SQLITE_OK) {
+        return d;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const std::int32_t ints[3] = {sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1),
+                                      sqlite3_column_int(stmt, 2)};
+        d.add(ints, sizeof(ints));
+        const auto* date = sqlite3_column_text(stmt, 3);
+        d.add(date, static_cast<size_t>(sqlite3_column_bytes(stmt, 3)));
+        const std::int32_t value = sqlite3_column_int(stmt, 4);
+        d.add(&value, sizeof(value));
+        d.rows++;
+    }
+    sqlite3_finalize(stmt);
+    return d;
+}
+
+} // namespace
+
+class D1RandomizerTest : public SchoolDbTest {
+protected:
+    D1RandomizerTest() : SchoolDbTest("d1_randomizer_school.db") {}
+
+    // Каждый прогон — на свежей копии school.db: generate + digest
+    GradesDigest generate(std::uint64_t seed, int threadCount, bool overwrite, D1RandomizerStats* stats = nullptr,
+                          const std::vector<GradeRule>* rules = nullptr) {
+        db = freshDb();
+        if (!db) {
+            ADD_FAILURE() << "cannot open copy of school.db: " << dbCopy.path();
+            return {};
+        }
+        D1Randomizer rnd(*db, seed);
+        if (rules) rnd.setRules(*rules);
+        const auto res = rnd.generateForAllGroups(overwrite, threadCount);
+        EXPECT_TRUE(res.ok) << res.error;
+        if (stats) *stats = res.value;
+        return digestGrades(*db);
+    }
+};
+
+// Фиксированный seed -> ровно те же оценки, что зафиксированы в golden-значениях
+TEST_F(D1RandomizerTest, GoldenOutputForFixedSeed) {
+    D1RandomizerStats stats;
+    const auto d = generate(kSeed, 1, false, &stats);
+
+    EXPECT_EQ(stats.seed, kSeed);
+    EXPECT_EQ(stats.createdTotal, kGoldenCreated);
+    EXPECT_EQ(d.rows, kGoldenRows);
+    EXPECT_EQ(d.hash, kGoldenDigest) << "created=" << stats.createdTotal << " rows=" << d.rows
+                                     << " digest=" << d.hash << "ull";
+}
+
+// Число потоков и повторный запуск не влияют на результат
+TEST_F(D1RandomizerTest, OutputIndependentOfThreadCount) {
+    for (bool overwrite : {false, true}) {
+        const auto single = generate(kSeed, 1, overwrite);
+        const auto again = generate(kSeed, 1, overwrite);
+        const auto parallel = generate(kSeed, 4, overwrite);
+
+        EXPECT_EQ(single.rows, again.rows) << "overwrite=" << overwrite;
+        EXPECT_EQ(single.hash, again.hash) << "overwrite=" << overwrite;
+        EXPECT_EQ(single.rows, parallel.rows) << "overwrite=" << overwrite;
+        EXPECT_EQ(single.hash, parallel.hash) << "overwrite=" << overwrite;
+    }
+}
+
+// Другой seed даёт другие оценки
+TEST_F(D1RandomizerTest, DifferentSeedChangesOutput) {
+    const auto a = generate(kSeed, 1, true);
+    const auto b = generate(kSeed + 1, 1, true);
+    EXPECT_NE(a.hash, b.hash);
+}
+
+// Порядок правил в наборе не влияет на результат, в том числе для правил одного
+// предмета (ВМиКА ЛК/ЛР, БЖЧ ПЗ/ЛР, БД ЛР/ПЗ)
+TEST_F(D1RandomizerTest, OutputIndependentOfRuleOrder) {
+    auto reversed = D1Randomizer::defaultRules();
+    std::reverse(reversed.begin(), reversed.end());
+    auto rotated = D1Randomizer::defaultRules();
+    std::rotate(rotated.begin(), rotated.begin() + 4, rotated.end());
+
+    for (bool overwrite : {false, true}) {
+        const auto base = generate(kSeed, 1, overwrite);
+        for (const auto* rules : {&reversed, &rotated}) {
+            const auto permuted = generate(kSeed, 1, overwrite, nullptr, rules);
+            EXPECT_EQ(base.rows, permuted.rows) << "overwrite=" << overwrite;
+            EXPECT_EQ(base.hash, permuted.hash) << "overwrite=" << overwrite;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#include "../database.h"
+#include "db_copy_fixture.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+// Database::applyJournalBatch: пакет правок за одно занятие в одной транзакции,
+// конфликты оценка/пропуск проверяются по всему пакету, результат — по строке.
+
+namespace {
+
+constexpr int kSubjectId = 1;
+constexpr int kSemesterId = 1;
+// Воскресенье: в school.db на эту дату нет ни оценок, ни пропусков
+const std::string kDate = "2025-09-14";
+
+JournalBatchRow setGrade(int studentId, int value)
+{
+    JournalBatchRow r;
+    r.studentId = studentId;
+    r.grade = JournalBatchRow::Action::Set;
+    r.gradeValue = value;
+    return r;
+}
+
+JournalBatchRow setAbsence(int studentId, int hours, const std::string& type = "unexcused")
+{
+    JournalBatchRow r;
+    r.studentId = studentId;
+    r.absence = JournalBatchRow::Action::Set;
+    r.absenceHours = hours;
+    r.absenceType = type;
+    return r;
+}
+
+} // namespace
+
+class JournalBatchTest : public SchoolDbTest {
+protected:
+    JournalBatchTest() : SchoolDbTest("journal_batch_school.db") {}
+
+    void SetUp() override {
+        SchoolDbTest::SetUp();
+        if (IsSkipped() || HasFatalFailure()) return;
+
+        ASSERT_TRUE(db->getStudentsOfGroup(1, students));
+        ASSERT_GE(students.size(), 4u);
+
+        std::vector<JournalEntry> entries;
+        ASSERT_TRUE(db->getJournalEntries(kSubjectId, kSemesterId, kDate, entries));
+        ASSERT_TRUE(entries.empty()) << "test date must have no journal records";
+    }
+
+    int student(size_t i) const { return students[i].first; }
+
+    std::vector<std::pair<int, std::string>> students;
+};
+
+TEST_F(JournalBatchTest, AppliesWholeGroup) {
+    std::vector<JournalBatchRow> rows;
+    for (size_t i = 0; i < students.size(); ++i) {
+        if (i % 5 == 0) rows.push_back(setAbsence(student(i), 2));
+        else rows.push_back(setGrade(student(i), 4 + static_cast<int>(i % 6)));
+    }
+
+    std::vector<JournalBatchRowResult> results;
+    ASSERT_TRUE(db->applyJournalBatch(kSubjectId, kSemesterId, kDate, rows, results));
+    ASSERT_EQ(results.size(), rows.size());
+    for (const auto& r : results) EXPECT_EQ(r.status, JournalBatchStatus::Applied) << r.studentId;
+
+    std::vector<JournalEntry> entries;
+    ASSERT_TRUE(db->getJournalEntries(kSubjectId, kSemesterId, kDate, entries));
+    EXPECT_EQ(entries.size(), students.size());
+
+    // Повтор того же пакета ничего не меняет
+    ASSERT_TRUE(db->applyJournalBatch(kSubjectId, kSemesterId, kDate, rows, results));
+    for (const auto& r : results) EXPECT_EQ(r.status, JournalBatchStatus::Unchanged) << r.studentId;
+}
+
+TEST_F(JournalBatchTest, ConflictsAreRejectedPerRow) {
+    std::vector<JournalBatchRowResult> results;
+    ASSERT_TRUE(db->applyJournalBatch(kSubjectId, kSemesterId, kDate,
+                                      {setAbsence(student(0), 2), setGrade(student(1), 7)}, results));
+
+    // Оценка поверх пропуска и пропуск поверх оценки — конфликт; соседняя строка применяется
+    std::vector<JournalBatchRow> rows = {setGrade(student(0), 5), setAbsence(student(1), 2), setGrade(student(2), 9)};
+    ASSERT_TRUE(db->applyJournalBatch(kSubjectId, kSemesterId, kDate, rows, results));
+    EXPECT_EQ(results[0].status, JournalBatchStatus::Conflict);
+    EXPECT_EQ(results[1].status, JournalBatchStatus::Conflict);
+    EXPECT_EQ(results[2].status, JournalBatchStatus::Applied);
+
+    // Снять пропуск и поставить оценку в одной строке можно
+    JournalBatchRow swap = setGrade(student(0), 5);
+    swap.absence = JournalBatchRow::Action::Clear;
+    ASSERT_TRUE(db->applyJournalBatch(kSubjectId, kSemesterId, kDate, {swap}, results));
+    EXPECT_EQ(results[0].status, JournalBatchStatus::Applied);
+
+    std::vector<JournalEntry> entries;
+    ASSERT_TRUE(db->getJournalEntries(kSubjectId, kSemesterId, kDate, entries));
+    ASSERT_EQ(entries.size(), 3u);
+    for (const auto& e : entries) {
+        EXPECT_FALSE(e.gradeId > 0 && e.absenceId > 0) << e.studentId;
+        if (e.studentId == student(0)) {
+            EXPECT_EQ(e.gradeValue, 5);
+        }
+        if (e.studentId == student(1)) {
+            EXPECT_EQ(e.gradeValue, 7);
+        }
+    }
+}
+
+TEST_F(JournalBatchTest, InvalidRows) {
+    std::vector<JournalBatchRow> rows = {
+        setGrade(student(0), 11),
+        setAbsence(student(1), 0),
+        setAbsence(student(2), 2, "sick"),
+        setGrade(student(3), 8),
+        setGrade(student(3), 9),
+    };
+
+    std::vector<JournalBatchRowResult> results;
+    ASSERT_TRUE(db->applyJournalBatch(kSubjectId, kSemesterId, kDate, rows, results));
+    EXPECT_EQ(results[0].status, JournalBatchStatus::Invalid);
+    EXPECT_EQ(results[1].status, JournalBatchStatus::Invalid);
+    EXPECT_EQ(results[2].status, JournalBatchStatus::Invalid);
+    EXPECT_EQ(results[3].status, JournalBatchStatus::Applied);
+    EXPECT_EQ(results[4].status, JournalBatchStatus::Invalid);
+
+    std::vector<JournalEntry> entries;
+    ASSERT_TRUE(db->getJournalEntries(kSubjectId, kSemesterId, kDate, entries));
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].gradeValue, 8);
+}
+
+TEST_F(JournalBatchTest, ClearRemovesRecords) {
+    std::vector<JournalBatchRowResult> results;
+    ASSERT_TRUE(db->applyJournalBatch(kSubjectId, kSemesterId, kDate,
+                                      {setGrade(student(0), 6), setAbsence(student(1), 4, "excused")}, results));
+
+    JournalBatchRow clearGrade;
+    clearGrade.studentId = student(0);
+    clearGrade.grade = JournalBatchRow::Action::Clear;
+    JournalBatchRow clearAbsence;
+    clearAbsence.studentId = student(1);
+    clearAbsence.absence = JournalBatchRow::Action::Clear;
+
+    ASSERT_TRUE(db->applyJournalBatch(kSubjectId, kSemesterId, kDate, {clearGrade, clearAbsence}, results));
+    EXPECT_EQ(results[0].status, JournalBatchStatus::Applied);
+    EXPECT_EQ(results[1].status, JournalBatchStatus::Applied);
+
+    std::vector<JournalEntry> entries;
+    ASSERT_TRUE(db->getJournalEntries(kSubjectId, kSemesterId, kDate, entries));
+    EXPECT_TRUE(entries.empty());
+}
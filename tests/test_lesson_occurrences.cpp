@@ -0,0 +1,366 @@
+#include "../database.h"
+#include "../core/connection_pool.h"
+#include "../core/lesson_slot_index.h"
+#include "db_copy_fixture.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Регрессия для getLessonOccurrencesForStudent: сравниваем с прежним алгоритмом
+// (недели × дни недели через getScheduleForGroup + subjectid/teacherid по id)
+// на реальной school.db. Работаем с копией, чтобы не трогать файл в репозитории.
+
+namespace {
+
+std::string trimCopy(std::string s)
+{
+    auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
+    while (!s.empty() && isSpace(static_cast<unsigned char>(s.front()))) s.erase(s.begin());
+    while (!s.empty() && isSpace(static_cast<unsigned char>(s.back()))) s.pop_back();
+    return s;
+}
+
+bool scheduleMeta(Database& db, int scheduleId, int& subjectId, int& teacherId)
+{
+    subjectId = 0;
+    teacherId = 0;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db.getHandle(), "SELECT subjectid, teacherid FROM schedule WHERE id = ? LIMIT 1;",
+                           -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, scheduleId);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        subjectId = sqlite3_column_int(stmt, 0);
+        teacherId = sqlite3_column_int(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+// Прежняя реализация (до перехода на один запрос)
+bool referenceOccurrences(Database& db, int studentId, int subjectId, const std::string& lessonType,
+                          int semesterId, std::vector<LessonOccurrence>& out)
+{
+    out.clear();
+
+    int groupId = 0;
+    int studentSubgroup = 0;
+    if (!db.getStudentGroupAndSubgroup(studentId, groupId, studentSubgroup) || groupId <= 0) return false;
+
+    std::string semStart;
+    std::string semEnd;
+    {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db.getHandle(), "SELECT startdate, enddate FROM semesters WHERE id = ?;",
+                               -1, &stmt, nullptr) != SQLITE_OK) {
+            return false;
+        }
+        sqlite3_bind_int(stmt, 1, semesterId);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            semStart = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            semEnd = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    std::vector<std::tuple<int, int, std::string, std::string>> weeks;
+    if (!db.getCycleWeeks(weeks)) return false;
+
+    const std::string type = trimCopy(lessonType);
+    for (const auto& w : weeks) {
+        const int weekId = std::get<0>(w);
+        if (std::get<3>(w) < semStart || std::get<2>(w) > semEnd) continue;
+
+        for (int weekday = 1; weekday <= 6; ++weekday) {
+            std::vector<std::tuple<int, int, int, std::string, std::string, std::string, std::string>> sched;
+            if (!db.getScheduleForGroup(groupId, weekday, std::get<1>(w), sched)) return false;
+
+            for (const auto& row : sched) {
+                if (trimCopy(std::get<5>(row)) != type) continue;
+
+                int rowSubjectId = 0;
+                int teacherId = 0;
+                if (!scheduleMeta(db, std::get<0>(row), rowSubjectId, teacherId)) return false;
+                if (rowSubjectId != subjectId) continue;
+
+                const int subgroup = std::get<2>(row);
+                if (!(subgroup == 0 || studentSubgroup == 0 || subgroup == studentSubgroup)) continue;
+
+                std::string dateISO;
+                if (!db.getDateForWeekdayByWeekId(weekId, weekday, dateISO)) return false;
+                if (dateISO < semStart || dateISO > semEnd) continue;
+
+                LessonOccurrence occ;
+                occ.lessonDate = CivilDate::parseISO(dateISO);
+                occ.scheduleId = std::get<0>(row);
+                occ.teacherId = teacherId;
+                occ.pairNumber = std::get<1>(row);
+                out.push_back(occ);
+            }
+        }
+    }
+
+    std::sort(out.begin(), out.end(), [](const LessonOccurrence& a, const LessonOccurrence& b) {
+        if (a.lessonDate != b.lessonDate) return a.lessonDate < b.lessonDate;
+        if (a.pairNumber != b.pairNumber) return a.pairNumber < b.pairNumber;
+        return a.scheduleId < b.scheduleId;
+    });
+    out.erase(std::unique(out.begin(), out.end(), [](const LessonOccurrence& a, const LessonOccurrence& b) {
+                  return a.lessonDate == b.lessonDate;
+              }),
+              out.end());
+    return true;
+}
+
+std::vector<int> queryIds(Database& db, const char* sql)
+{
+    std::vector<int> ids;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db.getHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) return ids;
+    while (sqlite3_step(stmt) == SQLITE_ROW) ids.push_back(sqlite3_column_int(stmt, 0));
+    sqlite3_finalize(stmt);
+    return ids;
+}
+
+} // namespace
+
+class LessonOccurrencesTest : public ::testing::Test {
+protected:
+    // Тесты только читают — одна копия на весь набор
+    static void SetUpTestSuite() {
+        if (!SchoolDbCopy::sourceExists()) return;
+        db = dbCopy.open(false);
+        ASSERT_TRUE(db) << "cannot open copy of school.db: " << dbCopy.path();
+    }
+
+    static void TearDownTestSuite() {
+        db.reset();
+        dbCopy.remove();
+    }
+
+    void SetUp() override {
+        if (!db) GTEST_SKIP() << "school.db not found: " << SCHOOL_DB_PATH;
+    }
+
+    static std::unique_ptr<Database> db;
+    static SchoolDbCopy dbCopy;
+};
+
+std::unique_ptr<Database> LessonOccurrencesTest::db = nullptr;
+SchoolDbCopy LessonOccurrencesTest::dbCopy("lesson_occurrences_school.db");
+
+// Новый запрос даёт те же даты, пары, scheduleId и преподавателей в том же порядке
+TEST_F(LessonOccurrencesTest, MatchesReferenceForAllStudents) {
+    const auto students = queryIds(*db, "SELECT id FROM users WHERE role = 'student' ORDER BY id;");
+    const auto subjects = queryIds(*db, "SELECT id FROM subjects ORDER BY id;");
+    const auto semesters = queryIds(*db, "SELECT id FROM semesters ORDER BY id;");
+    ASSERT_FALSE(students.empty());
+    ASSERT_FALSE(subjects.empty());
+    ASSERT_FALSE(semesters.empty());
+
+    const std::vector<std::string> types = {"ЛК", "ПЗ", "ЛР"};
+
+    size_t compared = 0;
+    for (int semesterId : semesters) {
+        for (int studentId : students) {
+            for (int subjectId : subjects) {
+                for (const auto& type : types) {
+                    std::vector<LessonOccurrence> expected;
+                    std::vector<LessonOccurrence> actual;
+                    const bool expectedOk = referenceOccurrences(*db, studentId, subjectId, type, semesterId, expected);
+                    const bool actualOk = db->getLessonOccurrencesForStudent(studentId, subjectId, type, semesterId, actual);
+
+                    ASSERT_EQ(expectedOk, actualOk)
+                        << "student=" << studentId << " subject=" << subjectId << " type=" << type;
+                    ASSERT_EQ(expected.size(), actual.size())
+                        << "student=" << studentId << " subject=" << subjectId << " type=" << type;
+
+                    for (size_t i = 0; i < expected.size(); ++i) {
+                        EXPECT_EQ(expected[i].lessonDate, actual[i].lessonDate);
+                        EXPECT_EQ(expected[i].scheduleId, actual[i].scheduleId);
+                        EXPECT_EQ(expected[i].teacherId, actual[i].teacherId);
+                        EXPECT_EQ(expected[i].pairNumber, actual[i].pairNumber);
+                    }
+                    compared += expected.size();
+                }
+            }
+        }
+    }
+
+    EXPECT_GT(compared, 0u) << "school.db has no lessons to compare";
+}
+
+// Тип занятия сравнивается после trim, пустой тип — ошибка
+TEST_F(LessonOccurrencesTest, LessonTypeIsTrimmed) {
+    const auto students = queryIds(*db, "SELECT id FROM users WHERE role = 'student' ORDER BY id LIMIT 1;");
+    const auto subjects = queryIds(*db, "SELECT subjectid FROM schedule WHERE lessontype = 'ПЗ' LIMIT 1;");
+    ASSERT_FALSE(students.empty());
+    ASSERT_FALSE(subjects.empty());
+
+    std::vector<LessonOccurrence> plain;
+    std::vector<LessonOccurrence> padded;
+    ASSERT_TRUE(db->getLessonOccurrencesForStudent(students[0], subjects[0], "ПЗ", 1, plain));
+    ASSERT_TRUE(db->getLessonOccurrencesForStudent(students[0], subjects[0], "  ПЗ ", 1, padded));
+    EXPECT_EQ(plain.size(), padded.size());
+
+    std::vector<LessonOccurrence> none;
+    EXPECT_FALSE(db->getLessonOccurrencesForStudent(students[0], subjects[0], "   ", 1, none));
+}
+
+// getStudentGradesWithLessons/getStudentAbsencesWithLessons дают те же пару и тип занятия,
+// что прежний поиск по строке (неделя по дате + getScheduleForGroup на каждую запись,
+// практика важнее лекции), и те же записи, что getStudent*ForSemester
+TEST_F(LessonOccurrencesTest, LessonSlotsMatchPerRowLookup) {
+    const auto students = queryIds(*db, "SELECT id FROM users WHERE role = 'student' ORDER BY id;");
+    ASSERT_FALSE(students.empty());
+
+    auto referenceSlot = [](Database& d, int groupId, int subgroup, const StudentLessonRecord& r,
+                            int& outLesson, std::string& outType, std::string& outRoom) {
+        outLesson = 0;
+        outType.clear();
+        outRoom.clear();
+        const CivilDate date = CivilDate::parseISO(r.date);
+        if (date.isNull() || date.isoWeekday() > 6) return;
+        const int weekId = d.getWeekIdByDate(r.date);
+        const int weekOfCycle = weekId > 0 ? d.getWeekOfCycleByWeekId(weekId) : 0;
+        if (weekOfCycle <= 0) return;
+
+        std::vector<std::tuple<int, int, int, std::string, std::string, std::string, std::string>> sched;
+        if (!d.getScheduleForGroup(groupId, date.isoWeekday(), weekOfCycle, sched)) return;
+        for (const auto& s : sched) {
+            if (std::get<3>(s) != r.subject) continue;
+            const int schSubgroup = std::get<2>(s);
+            if (!(schSubgroup == 0 || subgroup == 0 || schSubgroup == subgroup)) continue;
+
+            const std::string type = trimCopy(std::get<5>(s));
+            const bool lecture = type.find("ЛК") != std::string::npos;
+            if (outLesson == 0 || !lecture) {
+                outLesson = std::get<1>(s);
+                outType = type;
+                outRoom = std::get<4>(s);
+            }
+            if (!lecture) break;
+        }
+    };
+
+    size_t matched = 0;
+    for (int studentId : students) {
+        int groupId = 0;
+        int subgroup = 0;
+        ASSERT_TRUE(db->getStudentGroupAndSubgroup(studentId, groupId, subgroup));
+
+        std::vector<StudentLessonRecord> grades;
+        std::vector<StudentLessonRecord> absences;
+        ASSERT_TRUE(db->getStudentGradesWithLessons(studentId, 1, grades));
+        ASSERT_TRUE(db->getStudentAbsencesWithLessons(studentId, 1, absences));
+
+        std::vector<std::tuple<std::string, int, std::string, std::string>> plainGrades;
+        std::vector<std::tuple<std::string, int, std::string, std::string>> plainAbsences;
+        ASSERT_TRUE(db->getStudentGradesForSemester(studentId, 1, plainGrades));
+        ASSERT_TRUE(db->getStudentAbsencesForSemester(studentId, 1, plainAbsences));
+        ASSERT_EQ(grades.size(), plainGrades.size()) << "student=" << studentId;
+        ASSERT_EQ(absences.size(), plainAbsences.size()) << "student=" << studentId;
+
+        for (const auto* rows : {&grades, &absences}) {
+            for (const auto& r : *rows) {
+                int lesson = 0;
+                std::string type;
+                std::string room;
+                referenceSlot(*db, groupId, subgroup, r, lesson, type, room);
+                EXPECT_EQ(r.lessonNumber, lesson) << "student=" << studentId << " " << r.subject << " " << r.date;
+                EXPECT_EQ(r.lessonType, type) << "student=" << studentId << " " << r.subject << " " << r.date;
+                EXPECT_EQ(r.room, room) << "student=" << studentId << " " << r.subject << " " << r.date;
+                if (lesson > 0) ++matched;
+            }
+        }
+    }
+
+    EXPECT_GT(matched, 0u) << "school.db has no grades on scheduled lessons";
+}
+
+// Индекс занятий кэшируется на (группа, семестр) и перестраивается после invalidate()
+TEST_F(LessonOccurrencesTest, LessonSlotIndexCacheInvalidates) {
+    const auto students = queryIds(*db, "SELECT DISTINCT studentid FROM grades WHERE semesterid = 1 ORDER BY studentid;");
+    ASSERT_FALSE(students.empty());
+
+    int studentId = 0;
+    StudentLessonRecord slotted;
+    for (int id : students) {
+        std::vector<StudentLessonRecord> grades;
+        ASSERT_TRUE(db->getStudentGradesWithLessons(id, 1, grades));
+        auto it = std::find_if(grades.begin(), grades.end(),
+                               [](const StudentLessonRecord& r) { return r.lessonNumber > 0; });
+        if (it != grades.end()) {
+            studentId = id;
+            slotted = *it;
+            break;
+        }
+    }
+    ASSERT_GT(studentId, 0) << "school.db has no grades on scheduled lessons";
+
+    auto firstRoom = [&]() {
+        std::vector<StudentLessonRecord> grades;
+        EXPECT_TRUE(db->getStudentGradesWithLessons(studentId, 1, grades));
+        for (const auto& r : grades) {
+            if (r.subjectId == slotted.subjectId && r.date == slotted.date) return r.room;
+        }
+        return std::string();
+    };
+
+    // Запись в обход Database: кэш не знает об изменении, пока его не сбросят
+    ASSERT_EQ(sqlite3_exec(db->getHandle(), "UPDATE schedule SET room = room || '*';", nullptr, nullptr, nullptr),
+              SQLITE_OK);
+    EXPECT_EQ(firstRoom(), slotted.room);
+
+    LessonSlotIndexCache::instance().invalidate();
+    EXPECT_EQ(firstRoom(), slotted.room + "*");
+
+    ASSERT_EQ(sqlite3_exec(db->getHandle(), "UPDATE schedule SET room = substr(room, 1, length(room) - 1);",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+
+    // Сброс календаря соединения (execute, выдача из пула) общий кэш индексов не трогает
+    ASSERT_TRUE(db->execute("BEGIN; ROLLBACK;"));
+    EXPECT_EQ(firstRoom(), slotted.room + "*");
+    {
+        ConnectionPool pool(db->filePath(), 1, ConnectionProfile::balanced());
+        ASSERT_TRUE(pool.open());
+        pool.invalidateCalendars();
+        auto reader = pool.read();
+        ASSERT_TRUE(reader);
+    }
+    EXPECT_EQ(firstRoom(), slotted.room + "*");
+
+    LessonSlotIndexCache::instance().invalidate();
+    EXPECT_EQ(firstRoom(), slotted.room);
+}
+
+// id и weekOfCycle берутся из файла БД: большие значения не должны раздувать таблицы календаря
+TEST(CycleCalendarTest, SparseIdsAndCycleWeeks) {
+    const CivilDate monday = CivilDate::fromYmd(2024, 9, 2);
+    CycleCalendar calendar;
+    calendar.assign({
+        {2000000000, 1000000000, monday.addDays(7), monday.addDays(13)},
+        {5, 2, monday, monday.addDays(6)},
+        {7, 2, monday.addDays(14), monday.addDays(20)},
+    });
+
+    ASSERT_EQ(calendar.weeks().size(), 3u);
+    ASSERT_NE(calendar.findById(2000000000), nullptr);
+    EXPECT_EQ(calendar.findById(2000000000)->weekOfCycle, 1000000000);
+    EXPECT_EQ(calendar.findById(6), nullptr);
+    EXPECT_EQ(calendar.findById(2000000001), nullptr);
+
+    ASSERT_NE(calendar.firstOfCycleWeek(2), nullptr);
+    EXPECT_EQ(calendar.firstOfCycleWeek(2)->id, 5);
+    ASSERT_NE(calendar.firstOfCycleWeek(1000000000), nullptr);
+    EXPECT_EQ(calendar.firstOfCycleWeek(1000000000)->id, 2000000000);
+    EXPECT_EQ(calendar.firstOfCycleWeek(1), nullptr);
+
+    ASSERT_NE(calendar.findByDate(monday.addDays(8)), nullptr);
+    EXPECT_EQ(calendar.findByDate(monday.addDays(8))->id, 2000000000);
+}
@@ -0,0 +1,88 @@
+#include "../core/request_channels.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// RequestChannels (каналы DbExecutor): новая задача канала делает прежние билеты
+// устаревшими, каналы уничтоженного владельца удаляются.
+
+TEST(RequestChannelsTest, NewTicketInvalidatesPrevious) {
+    RequestChannels channels;
+    const auto first = channels.issue("teacher.schedule@1");
+    EXPECT_TRUE(first.isCurrent());
+
+    const auto second = channels.issue("teacher.schedule@1");
+    EXPECT_FALSE(first.isCurrent());
+    EXPECT_TRUE(second.isCurrent());
+
+    // Другой канал (другое окно) не затрагивается
+    const auto other = channels.issue("teacher.schedule@2");
+    EXPECT_TRUE(second.isCurrent());
+    EXPECT_TRUE(other.isCurrent());
+
+    EXPECT_FALSE(RequestChannels::Ticket().isCurrent());
+}
+
+TEST(RequestChannelsTest, CancelInvalidatesTickets) {
+    RequestChannels channels;
+    const auto a = channels.issue("a");
+    const auto b = channels.issue("b");
+
+    channels.cancel("a");
+    EXPECT_FALSE(a.isCurrent());
+    EXPECT_TRUE(b.isCurrent());
+
+    // Неизвестный канал не создаётся
+    channels.cancel("missing");
+    EXPECT_EQ(channels.channelCount(), 2u);
+
+    channels.cancelAll();
+    EXPECT_FALSE(b.isCurrent());
+    EXPECT_TRUE(channels.issue("b").isCurrent());
+}
+
+TEST(RequestChannelsTest, ReleaseDropsOwnerChannels) {
+    RequestChannels channels;
+    int window = 0;
+    int otherWindow = 0;
+
+    EXPECT_TRUE(channels.bind("student.schedule@w", &window));
+    EXPECT_FALSE(channels.bind("student.grades@w", &window));
+    EXPECT_FALSE(channels.bind("student.schedule@w", &window));
+    EXPECT_TRUE(channels.bind("student.schedule@o", &otherWindow));
+
+    const auto pending = channels.issue("student.schedule@w");
+    const auto otherPending = channels.issue("student.schedule@o");
+    ASSERT_EQ(channels.channelCount(), 3u);
+
+    channels.release(&window);
+    EXPECT_EQ(channels.channelCount(), 1u);
+    EXPECT_FALSE(pending.isCurrent());
+    EXPECT_TRUE(otherPending.isCurrent());
+
+    // Новый владелец по тому же адресу привязывается заново
+    EXPECT_TRUE(channels.bind("student.schedule@w", &window));
+    EXPECT_EQ(channels.channelCount(), 2u);
+}
+
+TEST(RequestChannelsTest, ConcurrentIssueLeavesOneCurrent) {
+    RequestChannels channels;
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 500;
+
+    std::vector<std::vector<RequestChannels::Ticket>> issued(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&channels, &issued, t]() {
+            for (int i = 0; i < kPerThread; ++i) issued[t].push_back(channels.issue("search"));
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    int current = 0;
+    for (const auto& tickets : issued) {
+        for (const auto& ticket : tickets) current += ticket.isCurrent() ? 1 : 0;
+    }
+    EXPECT_EQ(current, 1);
+}
@@ -0,0 +1,181 @@
+#include "../database.h"
+#include "../services/schedule_importer.h"
+#include "db_copy_fixture.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ScheduleImporter: те же строки, что и выполнение schedule_*.sql, и отказ без
+// частичной записи при ошибке в любом файле.
+
+namespace {
+
+const std::filesystem::path kRepoDir = std::filesystem::path(SCHOOL_DB_PATH).parent_path();
+
+std::vector<std::string> scheduleScripts()
+{
+    std::vector<std::string> paths;
+    for (int group = 1; group <= 4; ++group) {
+        paths.push_back((kRepoDir / ("schedule_42060" + std::to_string(group) + "_newest.sql")).string());
+    }
+    return paths;
+}
+
+// Расписание одной строкой на занятие: в каноническом порядке или в порядке вставки (id)
+std::vector<std::string> dumpSchedule(Database& db, bool insertionOrder = false)
+{
+    std::vector<std::string> out;
+    sqlite3_stmt* stmt = nullptr;
+    const std::string sql =
+        std::string("SELECT groupid || '|' || subgroup || '|' || weekday || '|' || lessonnumber || '|' || weekofcycle"
+                    "       || '|' || subjectid || '|' || teacherid || '|' || room || '|' || lessontype "
+                    "FROM schedule ORDER BY ") + (insertionOrder ? "id;" : "1;");
+    if (sqlite3_prepare_v2(db.rawHandle(), sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return out;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        out.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    }
+    sqlite3_finalize(stmt);
+    return out;
+}
+
+} // namespace
+
+class ScheduleImporterTest : public SchoolDbTest {
+protected:
+    ScheduleImporterTest() : SchoolDbTest("schedule_importer_school.db", false) {}
+
+    void SetUp() override {
+        SchoolDbTest::SetUp();
+        if (IsSkipped() || HasFatalFailure()) return;
+        ASSERT_TRUE(db->execute("DELETE FROM schedule;"));
+    }
+};
+
+TEST_F(ScheduleImporterTest, MatchesScriptExecution) {
+    for (const auto& path : scheduleScripts()) ASSERT_TRUE(db->loadScheduleFromFile(path)) << path;
+    const auto expected = dumpSchedule(*db);
+    ASSERT_FALSE(expected.empty());
+
+    ASSERT_TRUE(db->execute("DELETE FROM schedule;"));
+    ScheduleImporter importer(*db);
+    const auto result = importer.importFiles(scheduleScripts());
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.value.files, 4);
+    EXPECT_EQ(result.value.rows, static_cast<int>(expected.size()));
+    EXPECT_EQ(dumpSchedule(*db), expected);
+
+    // TSV из конвертера загружается в то же расписание
+    std::vector<ScheduleImportRow> rows;
+    for (const auto& path : scheduleScripts()) {
+        auto parsed = ScheduleImporter::parseFile(path);
+        ASSERT_TRUE(parsed.ok) << parsed.error;
+        rows.insert(rows.end(), parsed.value.begin(), parsed.value.end());
+    }
+    auto tsv = ScheduleImporter::parseDelimited(ScheduleImporter::toTsv(rows), '\t');
+    ASSERT_TRUE(tsv.ok) << tsv.error;
+    ASSERT_EQ(tsv.value.size(), rows.size());
+
+    ASSERT_TRUE(db->execute("DELETE FROM schedule;"));
+    const auto fromTsv = importer.importRows(tsv.value);
+    ASSERT_TRUE(fromTsv.ok) << fromTsv.error;
+    EXPECT_EQ(dumpSchedule(*db), expected);
+}
+
+TEST_F(ScheduleImporterTest, RejectsInvalidRowsWithoutWriting) {
+    const std::string text =
+        "groupid\tsubgroup\tweekday\tlessonnumber\tweekofcycle\tsubjectid\tteacherid\troom\tlessontype\n"
+        "1\t1\t0\t1\t3\t5\t119\t601б-5\tЛР\n"
+        "1\t0\t0\t2\t5\t5\t119\t601б-5\tПЗ\n";
+    auto parsed = ScheduleImporter::parseDelimited(text, '\t');
+    ASSERT_TRUE(parsed.ok) << parsed.error;
+
+    ScheduleImporter importer(*db);
+    const auto result = importer.importRows(parsed.value);
+    ASSERT_FALSE(result.ok);
+    EXPECT_NE(result.error.find("3: weekofcycle"), std::string::npos) << result.error;
+    EXPECT_TRUE(dumpSchedule(*db).empty());
+
+    // Дни только 0..5 (6 — это уже воскресенье в нумерации с 0), пары только 1..6
+    auto outOfGrid = [&](const std::string& line) {
+        auto one = ScheduleImporter::parseDelimited(line, '\t');
+        EXPECT_TRUE(one.ok) << one.error;
+        return importer.importRows(one.value);
+    };
+    const auto sunday = outOfGrid("1\t1\t6\t1\t1\t5\t119\t601б-5\tЛР\n");
+    ASSERT_FALSE(sunday.ok);
+    EXPECT_NE(sunday.error.find("1: weekday must be 0..5"), std::string::npos) << sunday.error;
+    const auto seventh = outOfGrid("1\t1\t0\t7\t1\t5\t119\t601б-5\tЛР\n");
+    ASSERT_FALSE(seventh.ok);
+    EXPECT_NE(seventh.error.find("1: lessonnumber must be 1..6"), std::string::npos) << seventh.error;
+    EXPECT_TRUE(dumpSchedule(*db).empty());
+
+    // Таблица уже нумерует дни с 1: строки 0..5 к ней не дописываются
+    ASSERT_TRUE(db->execute("INSERT INTO schedule (groupid, subgroup, weekday, lessonnumber, weekofcycle, "
+                            "subjectid, teacherid, room, lessontype) VALUES (1, 1, 1, 1, 1, 5, 119, '601б-5', 'ЛР');"));
+    const auto mixed = outOfGrid("1\t1\t0\t1\t1\t5\t119\t601б-5\tЛР\n");
+    ASSERT_FALSE(mixed.ok);
+    EXPECT_NE(mixed.error.find("weekday 1..6"), std::string::npos) << mixed.error;
+    EXPECT_EQ(dumpSchedule(*db).size(), 1u);
+
+    auto broken = ScheduleImporter::parseDelimited("1\t1\t0\tx\t3\t5\t119\t601б-5\tЛР\n", '\t');
+    ASSERT_FALSE(broken.ok);
+    EXPECT_NE(broken.error.find("1: bad lessonnumber"), std::string::npos) << broken.error;
+
+    auto script = ScheduleImporter::parseSqlScript("DELETE FROM schedule;\n");
+    EXPECT_FALSE(script.ok);
+}
+
+// Много файлов на нескольких потоках: то же содержимое, порядок вставки и счётчики
+// по файлам, что при последовательном импорте; ошибка в одном файле откатывает всё
+TEST_F(ScheduleImporterTest, ParallelMatchesSequential) {
+    const auto scripts = scheduleScripts();
+    std::vector<ScheduleImportRow> groupRows;
+    for (size_t i = 1; i < scripts.size(); ++i) {  // без общих лекций первого файла
+        auto parsed = ScheduleImporter::parseFile(scripts[i]);
+        ASSERT_TRUE(parsed.ok) << parsed.error;
+        groupRows.insert(groupRows.end(), parsed.value.begin(), parsed.value.end());
+    }
+
+    // Файлы разного размера, чтобы они заканчивались в разном порядке
+    std::vector<std::string> files;
+    for (int f = 0; f < 24; ++f) {
+        const auto path = std::filesystem::temp_directory_path() / ("schedule_importer_" + std::to_string(f) + ".tsv");
+        std::vector<ScheduleImportRow> rows;
+        for (int copy = 0; copy <= f % 5; ++copy) rows.insert(rows.end(), groupRows.begin(), groupRows.end());
+        std::ofstream(path, std::ios::binary) << ScheduleImporter::toTsv(rows);
+        files.push_back(path.string());
+    }
+
+    ScheduleImporter importer(*db);
+    const auto sequential = importer.importFiles(files, 1);
+    ASSERT_TRUE(sequential.ok) << sequential.error;
+    const auto expected = dumpSchedule(*db);
+    const auto expectedOrder = dumpSchedule(*db, true);
+
+    ASSERT_TRUE(db->execute("DELETE FROM schedule;"));
+    const auto parallel = importer.importFiles(files, 4);
+    ASSERT_TRUE(parallel.ok) << parallel.error;
+    EXPECT_EQ(parallel.value.threadsUsed, 4);
+    EXPECT_EQ(parallel.value.rows, sequential.value.rows);
+    ASSERT_EQ(parallel.value.perFile.size(), files.size());
+    for (size_t f = 0; f < files.size(); ++f) {
+        EXPECT_EQ(parallel.value.perFile[f].rows, sequential.value.perFile[f].rows) << files[f];
+        EXPECT_EQ(parallel.value.perFile[f].rows, static_cast<int>(groupRows.size() * (f % 5 + 1)));
+    }
+    EXPECT_EQ(dumpSchedule(*db), expected);
+    // Строки пишутся в порядке файлов, как при одном потоке — id не зависят от потоков
+    EXPECT_EQ(dumpSchedule(*db, true), expectedOrder);
+
+    // Битый файл в середине списка
+    ASSERT_TRUE(db->execute("DELETE FROM schedule;"));
+    std::ofstream(files[13], std::ios::binary) << "1\t1\t0\t1\t9\t5\t119\t601б-5\tЛР\n";
+    const auto broken = importer.importFiles(files, 4);
+    ASSERT_FALSE(broken.ok);
+    EXPECT_NE(broken.error.find(files[13] + ":1: weekofcycle"), std::string::npos) << broken.error;
+    EXPECT_TRUE(dumpSchedule(*db).empty());
+
+    std::error_code ec;
+    for (const auto& path : files) std::filesystem::remove(path, ec);
+}
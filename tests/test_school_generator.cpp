@@ -0,0 +1,122 @@
+#include "../database.h"
+#include "../services/school_generator.h"
+#include "db_copy_fixture.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+// SchoolGenerator: согласованность сгенерированной школы. Групп больше, чем пунктов
+// расписания, чтобы у каждого пункта было несколько преподавателей и аудиторий.
+
+namespace {
+
+int scalar(Database& db, const char* sql)
+{
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db.rawHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) return -1;
+    const int value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+} // namespace
+
+class SchoolGeneratorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbFile = std::filesystem::temp_directory_path() / "school_generator_test.db";
+        removeDbFiles(dbFile);
+
+        db = std::make_unique<Database>(dbFile.string());
+        ASSERT_TRUE(db->connect());
+        ASSERT_TRUE(db->initialize());
+
+        options.groups = 26;
+        options.studentsPerGroup = 8;
+        options.threads = 2;
+    }
+
+    void TearDown() override {
+        db.reset();
+        removeDbFiles(dbFile);
+    }
+
+    std::filesystem::path dbFile;
+    std::unique_ptr<Database> db;
+    SchoolGeneratorOptions options;
+};
+
+TEST_F(SchoolGeneratorTest, GeneratesConsistentSchool) {
+    SchoolGenerator generator(*db, 7);
+    const auto result = generator.generate(options);
+    ASSERT_TRUE(result.ok) << result.error;
+
+    const auto& s = result.value;
+    EXPECT_EQ(s.students, options.groups * options.studentsPerGroup);
+    EXPECT_GT(s.scheduleRows, 0);
+    EXPECT_GT(s.grades, 0);
+    EXPECT_GT(s.absences, 0);
+    EXPECT_EQ(scalar(*db, "SELECT COUNT(*) FROM schedule;"), s.scheduleRows);
+    EXPECT_EQ(scalar(*db, "SELECT COUNT(*) FROM grades;"), s.grades);
+    EXPECT_EQ(scalar(*db, "SELECT COUNT(*) FROM absences;"), s.absences);
+
+    // Ни преподаватель, ни аудитория, ни подгруппа не заняты дважды в одном слоте
+    EXPECT_EQ(scalar(*db,
+        "SELECT COUNT(*) FROM (SELECT 1 FROM schedule "
+        "GROUP BY teacherid, weekofcycle, weekday, lessonnumber HAVING COUNT(*) > 1);"), 0);
+    EXPECT_EQ(scalar(*db,
+        "SELECT COUNT(*) FROM (SELECT 1 FROM schedule "
+        "GROUP BY room, weekofcycle, weekday, lessonnumber HAVING COUNT(*) > 1);"), 0);
+    EXPECT_EQ(scalar(*db,
+        "SELECT COUNT(*) FROM (SELECT 1 FROM schedule "
+        "GROUP BY groupid, subgroup, weekofcycle, weekday, lessonnumber HAVING COUNT(*) > 1);"), 0);
+
+    // Оценка и пропуск за одно занятие не совпадают
+    EXPECT_EQ(scalar(*db,
+        "SELECT COUNT(*) FROM grades g JOIN absences a "
+        "ON a.studentid = g.studentid AND a.subjectid = g.subjectid "
+        "AND a.semesterid = g.semesterid AND a.date = g.date;"), 0);
+
+    // Каждый преподаватель расписания привязан к предмету и к группам своих занятий
+    EXPECT_EQ(scalar(*db,
+        "SELECT COUNT(*) FROM schedule s WHERE NOT EXISTS (SELECT 1 FROM teachersubjects ts "
+        "WHERE ts.teacherid = s.teacherid AND ts.subjectid = s.subjectid);"), 0);
+    EXPECT_EQ(scalar(*db,
+        "SELECT COUNT(*) FROM schedule s WHERE s.groupid > 0 AND NOT EXISTS ("
+        "SELECT 1 FROM teachergroups tg WHERE tg.teacherid = s.teacherid AND tg.groupid = s.groupid);"), 0);
+
+    // Студента можно найти и получить его расписание обычными методами
+    int id = 0;
+    std::string name, role;
+    ASSERT_TRUE(db->findUser("s420601_01", "123", id, name, role));
+    EXPECT_EQ(role, "student");
+
+    std::vector<LessonOccurrence> occ;
+    int subjectId = 0;
+    ASSERT_TRUE(db->getSubjectIdByName("ООП", subjectId));
+    ASSERT_TRUE(db->getLessonOccurrencesForStudent(id, subjectId, "ЛР", 1, occ));
+    EXPECT_FALSE(occ.empty());
+
+    // Все пары — в сетке недели (1..6), которую показывает интерфейс
+    EXPECT_EQ(scalar(*db, "SELECT COUNT(*) FROM schedule WHERE lessonnumber NOT BETWEEN 1 AND 6;"), 0);
+    auto tooMany = options;
+    tooMany.lessonsPerDay = GroupWeekSchedule::kLessons + 1;
+    EXPECT_FALSE(SchoolGenerator(*db, 7).generate(tooMany).ok);
+}
+
+TEST_F(SchoolGeneratorTest, SameSeedSameData) {
+    SchoolGenerator first(*db, 11);
+    const auto a = first.generate(options);
+    ASSERT_TRUE(a.ok) << a.error;
+    const int gradeSum = scalar(*db, "SELECT SUM(value) FROM grades;");
+    const int absenceHours = scalar(*db, "SELECT SUM(hours) FROM absences;");
+
+    SchoolGenerator second(*db, 11);
+    const auto b = second.generate(options);
+    ASSERT_TRUE(b.ok) << b.error;
+    EXPECT_EQ(b.value.grades, a.value.grades);
+    EXPECT_EQ(b.value.absences, a.value.absences);
+    EXPECT_EQ(scalar(*db, "SELECT SUM(value) FROM grades;"), gradeSum);
+    EXPECT_EQ(scalar(*db, "SELECT SUM(hours) FROM absences;"), absenceHours);
+}
@@ -0,0 +1,347 @@
+#include "../database.h"
+#include "../statistics.h"
+#include "db_copy_fixture.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Сводка studentstats (миграция 2) ведётся триггерами: после любых правок grades/absences
+// она совпадает с прямым пересчётом по исходным таблицам.
+
+namespace {
+
+struct Totals {
+    long long gradeSum = 0;
+    long long gradeCount = 0;
+    long long hours = 0;
+    long long unexcused = 0;
+};
+
+Totals scanTotals(Database& db, int studentId, int semesterId)
+{
+    Totals t;
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql =
+        "SELECT (SELECT COALESCE(SUM(value), 0) FROM grades WHERE studentid = ?1 AND semesterid = ?2),"
+        "       (SELECT COUNT(*) FROM grades WHERE studentid = ?1 AND semesterid = ?2),"
+        "       (SELECT COALESCE(SUM(hours), 0) FROM absences WHERE studentid = ?1 AND semesterid = ?2),"
+        "       (SELECT COALESCE(SUM(hours), 0) FROM absences"
+        "         WHERE studentid = ?1 AND semesterid = ?2 AND COALESCE(type, '') <> 'excused');";
+    if (sqlite3_prepare_v2(db.getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, studentId);
+        sqlite3_bind_int(stmt, 2, semesterId);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            t.gradeSum = sqlite3_column_int64(stmt, 0);
+            t.gradeCount = sqlite3_column_int64(stmt, 1);
+            t.hours = sqlite3_column_int64(stmt, 2);
+            t.unexcused = sqlite3_column_int64(stmt, 3);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return t;
+}
+
+// Число расхождений сводки с исходными таблицами по всем ключам
+int countMismatches(Database& db)
+{
+    const char* sql =
+        "WITH src AS ("
+        "  SELECT studentid, subjectid, semesterid, substr(date, 1, 7) AS month,"
+        "         SUM(gs) AS gs, SUM(gc) AS gc, SUM(ah) AS ah, SUM(uh) AS uh FROM ("
+        "    SELECT studentid, subjectid, semesterid, date, value AS gs, 1 AS gc, 0 AS ah, 0 AS uh FROM grades"
+        "    UNION ALL"
+        "    SELECT studentid, subjectid, semesterid, date, 0, 0, hours,"
+        "           CASE WHEN COALESCE(type, '') <> 'excused' THEN hours ELSE 0 END FROM absences)"
+        "  GROUP BY 1, 2, 3, 4) "
+        "SELECT COUNT(*) FROM ("
+        "  SELECT s.studentid FROM studentstats s LEFT JOIN src USING (studentid, subjectid, semesterid, month)"
+        "  WHERE COALESCE(src.gs, 0) <> s.gradesum OR COALESCE(src.gc, 0) <> s.gradecount"
+        "     OR COALESCE(src.ah, 0) <> s.absencehours OR COALESCE(src.uh, 0) <> s.unexcusedhours"
+        "  UNION ALL"
+        "  SELECT src.studentid FROM src LEFT JOIN studentstats s USING (studentid, subjectid, semesterid, month)"
+        "  WHERE s.studentid IS NULL);";
+    int mismatches = -1;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db.getHandle(), sql, -1, &stmt, nullptr) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        mismatches = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return mismatches;
+}
+
+} // namespace
+
+class StudentStatsTest : public SchoolDbTest {
+protected:
+    StudentStatsTest() : SchoolDbTest("student_stats_school.db") {}
+
+    void SetUp() override {
+        SchoolDbTest::SetUp();
+        if (IsSkipped() || HasFatalFailure()) return;
+
+        ASSERT_TRUE(db->hasStudentStats());
+        ASSERT_TRUE(db->getStudentsOfGroup(1, students));
+        ASSERT_GE(students.size(), 2u);
+    }
+
+    std::vector<std::pair<int, std::string>> students;
+};
+
+TEST_F(StudentStatsTest, BackfillMatchesSourceTables) {
+    EXPECT_EQ(countMismatches(*db), 0);
+}
+
+TEST_F(StudentStatsTest, TriggersFollowEveryWritePath) {
+    const int a = students[0].first;
+    const int b = students[1].first;
+
+    ASSERT_TRUE(db->addGrade(a, 1, 1, 7, "2025-09-14"));
+    ASSERT_TRUE(db->upsertGradeByKey(a, 1, 1, 9, "2025-09-14"));  // замена значения
+    ASSERT_TRUE(db->upsertGradeByKey(a, 2, 1, 5, "2025-10-05"));
+    ASSERT_TRUE(db->upsertAbsenceByKey(b, 1, 1, 2, "2025-09-14", "excused"));
+    ASSERT_TRUE(db->upsertAbsenceByKey(b, 1, 1, 3, "2025-09-14", "unexcused"));  // смена типа
+    ASSERT_TRUE(db->upsertAbsenceByKey(b, 2, 1, 1, "2025-10-05", "unexcused"));
+    EXPECT_EQ(countMismatches(*db), 0);
+
+    // Перенос оценки в другой месяц
+    int gradeId = 0;
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_EQ(sqlite3_prepare_v2(db->getHandle(),
+        "SELECT id FROM grades WHERE studentid = ? AND subjectid = 2 AND date = '2025-10-05';",
+        -1, &stmt, nullptr), SQLITE_OK);
+    sqlite3_bind_int(stmt, 1, a);
+    if (sqlite3_step(stmt) == SQLITE_ROW) gradeId = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    ASSERT_GT(gradeId, 0);
+    ASSERT_TRUE(db->updateGrade(gradeId, 6, "2025-11-02", ""));
+    EXPECT_EQ(countMismatches(*db), 0);
+
+    ASSERT_TRUE(db->deleteGrade(gradeId));
+    ASSERT_TRUE(db->execute("DELETE FROM absences WHERE date = '2025-10-05';"));
+    EXPECT_EQ(countMismatches(*db), 0);
+}
+
+TEST_F(StudentStatsTest, ApisReadSummary) {
+    const int a = students[0].first;
+    ASSERT_TRUE(db->upsertGradeByKey(a, 1, 1, 10, "2025-09-14"));
+    ASSERT_TRUE(db->upsertAbsenceByKey(a, 2, 1, 4, "2025-09-14", "unexcused"));
+
+    const Totals t = scanTotals(*db, a, 1);
+    ASSERT_GT(t.gradeCount, 0);
+
+    EXPECT_NEAR(Statistics::calculateStudentAverage(*db, a, 1),
+                static_cast<double>(t.gradeSum) / t.gradeCount, 1e-9);
+
+    int total = -1;
+    int unexcused = -1;
+    ASSERT_TRUE(db->getStudentTotalAbsences(a, 1, total));
+    ASSERT_TRUE(db->getStudentUnexcusedAbsences(a, 1, unexcused));
+    EXPECT_EQ(total, t.hours);
+    EXPECT_EQ(unexcused, t.unexcused);
+
+    double monthAvg = 0.0;
+    int monthCount = 0;
+    ASSERT_TRUE(db->getStudentAverageGradeForMonth(a, 1, 2025, 9, 0, monthAvg, monthCount));
+    EXPECT_GT(monthCount, 0);
+
+    int monthHours = 0;
+    int monthUnexcused = 0;
+    ASSERT_TRUE(db->getStudentAbsenceHoursForMonth(a, 1, 2025, 9, 2, monthHours, monthUnexcused));
+    EXPECT_GE(monthHours, 4);
+    EXPECT_GE(monthUnexcused, 4);
+
+    // Месяц без записей
+    ASSERT_TRUE(db->getStudentAverageGradeForMonth(a, 1, 2030, 1, 0, monthAvg, monthCount));
+    EXPECT_EQ(monthCount, 0);
+    EXPECT_DOUBLE_EQ(monthAvg, 0.0);
+}
+
+TEST(StatisticsPercentileTest, LinearInterpolation) {
+    EXPECT_DOUBLE_EQ(Statistics::percentile({}, 0.5), 0.0);
+    EXPECT_DOUBLE_EQ(Statistics::percentile({7.0}, 0.9), 7.0);
+    EXPECT_DOUBLE_EQ(Statistics::percentile({1.0, 2.0, 3.0, 4.0}, 0.5), 2.5);
+    EXPECT_DOUBLE_EQ(Statistics::percentile({1.0, 2.0, 3.0, 4.0, 5.0}, 0.25), 2.0);
+    EXPECT_DOUBLE_EQ(Statistics::percentile({1.0, 2.0, 3.0, 4.0, 5.0}, 1.0), 5.0);
+}
+
+TEST_F(StudentStatsTest, GroupReportMatchesPerStudentApis) {
+    const GroupReport report = Statistics::computeGroupReport(*db, 1, 1);
+    ASSERT_TRUE(report.ok);
+    ASSERT_EQ(report.students.size(), students.size());
+
+    int graded = 0;
+    for (const auto& st : report.students) {
+        const Totals t = scanTotals(*db, st.studentId, 1);
+        EXPECT_EQ(st.gradeCount, t.gradeCount) << st.studentId;
+        EXPECT_EQ(st.absenceHours, t.hours) << st.studentId;
+        EXPECT_EQ(st.unexcusedHours, t.unexcused) << st.studentId;
+        if (st.gradeCount > 0) {
+            ++graded;
+            EXPECT_NEAR(st.average, Statistics::calculateStudentAverage(*db, st.studentId, 1), 1e-9);
+        }
+        for (const auto& subj : st.subjects) {
+            if (subj.gradeCount == 0) continue;
+            EXPECT_NEAR(subj.average,
+                        Statistics::calculateStudentSubjectAverage(*db, st.studentId, subj.subjectId, 1), 1e-9);
+        }
+    }
+    EXPECT_EQ(report.gradedStudents, graded);
+    if (graded > 0) {
+        EXPECT_LE(report.p25, report.median);
+        EXPECT_LE(report.median, report.p75);
+        EXPECT_LE(report.p75, report.p90);
+    }
+
+    // Фильтр по предмету: у каждого студента не больше одного предмета
+    const GroupReport bySubject = Statistics::computeGroupReport(*db, 1, 1, 1);
+    ASSERT_TRUE(bySubject.ok);
+    EXPECT_EQ(bySubject.students.size(), students.size());
+    for (const auto& st : bySubject.students) {
+        ASSERT_LE(st.subjects.size(), 1u);
+        if (!st.subjects.empty()) {
+            EXPECT_EQ(st.subjects.front().subjectId, 1);
+        }
+    }
+}
+
+TEST_F(StudentStatsTest, MonthSeriesMatchesMonthlyApis) {
+    const int a = students[0].first;
+    ASSERT_TRUE(db->upsertGradeByKey(a, 1, 1, 8, "2025-12-31"));
+    ASSERT_TRUE(db->upsertAbsenceByKey(a, 2, 1, 2, "2026-01-01", "excused"));
+
+    std::vector<StudentMonthStats> series;
+    ASSERT_TRUE(db->getStudentMonthSeries(a, 1, series));
+    ASSERT_FALSE(series.empty());
+
+    int prev = 0;
+    for (const auto& m : series) {
+        EXPECT_GE(m.year * 100 + m.month, prev);
+        prev = m.year * 100 + m.month;
+
+        double avg = 0.0;
+        int count = 0;
+        ASSERT_TRUE(db->getStudentAverageGradeForMonth(a, 1, m.year, m.month, m.subjectId, avg, count));
+        EXPECT_EQ(count, m.gradeCount) << m.year << "-" << m.month;
+        if (count > 0) {
+            EXPECT_NEAR(avg, static_cast<double>(m.gradeSum) / m.gradeCount, 1e-9);
+        }
+
+        int hours = 0;
+        int unexcused = 0;
+        ASSERT_TRUE(db->getStudentAbsenceHoursForMonth(a, 1, m.year, m.month, m.subjectId, hours, unexcused));
+        EXPECT_EQ(hours, m.absenceHours);
+        EXPECT_EQ(unexcused, m.unexcusedHours);
+    }
+
+    // Граница года: декабрь и январь не смешиваются
+    int hours = 0;
+    int unexcused = 0;
+    ASSERT_TRUE(db->getStudentAbsenceHoursForMonth(a, 1, 2025, 12, 2, hours, unexcused));
+    EXPECT_EQ(hours, 0);
+    ASSERT_TRUE(db->getStudentAbsenceHoursForMonth(a, 1, 2026, 1, 2, hours, unexcused));
+    EXPECT_EQ(hours, 2);
+    EXPECT_EQ(unexcused, 0);
+
+    // Год вне 'YYYY' ключа не принимается
+    double avg = 0.0;
+    int count = 0;
+    EXPECT_FALSE(db->getStudentAverageGradeForMonth(a, 1, 10000, 1, 0, avg, count));
+    EXPECT_FALSE(db->getStudentAbsenceHoursForMonth(a, 1, 10000, 1, 0, hours, unexcused));
+}
+
+TEST_F(StudentStatsTest, MonthRangeUsesStudentDateIndex) {
+    // Фильтр без сводки — диапазон по date, SQLite должен идти по индексу миграции 3
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_EQ(sqlite3_prepare_v2(db->getHandle(),
+        "EXPLAIN QUERY PLAN SELECT AVG(value) FROM grades "
+        "WHERE studentid = 1 AND semesterid = 1 AND date >= '2025-09' AND date < '2025-10';",
+        -1, &stmt, nullptr), SQLITE_OK);
+    std::string plan;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* detail = sqlite3_column_text(stmt, 3);
+        if (detail) plan += reinterpret_cast<const char*>(detail);
+    }
+    sqlite3_finalize(stmt);
+    EXPECT_NE(plan.find("idxgradesstudentdate"), std::string::npos) << plan;
+}
+
+// Файл на последней миграции: initialize() не выполняет DDL, сброс user_version
+// возвращает полный путь (базовые таблицы и индексы, миграции)
+TEST_F(StudentStatsTest, WarmInitializeSkipsDdl) {
+    const int version = db->schemaVersion();
+    ASSERT_GT(version, 0);
+
+    auto hasRoomIndex = [](Database& d) {
+        sqlite3_stmt* stmt = nullptr;
+        int found = -1;
+        if (sqlite3_prepare_v2(d.getHandle(), "SELECT COUNT(*) FROM sqlite_master WHERE name = 'idxscheduleroom';",
+                               -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+            found = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+        return found == 1;
+    };
+
+    ASSERT_TRUE(db->execute("DROP INDEX idxscheduleroom;"));
+    db = std::make_unique<Database>(dbCopy.path());
+    ASSERT_TRUE(db->connect());
+    ASSERT_TRUE(db->initialize());
+    EXPECT_FALSE(hasRoomIndex(*db));
+    EXPECT_EQ(db->schemaVersion(), version);
+    EXPECT_TRUE(db->hasStudentStats());
+
+    std::vector<std::tuple<int, std::string, std::string, std::string, int, int>> found;
+    int total = 0;
+    ASSERT_TRUE(db->searchUsers(students.front().second.substr(0, 6), "", 0, 10, found, total));
+    EXPECT_GT(total, 0);
+
+    ASSERT_TRUE(db->execute("PRAGMA user_version = 0;"));
+    db = std::make_unique<Database>(dbCopy.path());
+    ASSERT_TRUE(db->connect());
+    ASSERT_TRUE(db->initialize());
+    EXPECT_TRUE(hasRoomIndex(*db));
+    EXPECT_EQ(db->schemaVersion(), version);
+    EXPECT_EQ(countMismatches(*db), 0);
+}
+
+// Миграция 1 на файле с дублями оценок: история изменений дубля переносится на
+// оставшуюся оценку, и FOREIGN KEY gradechanges не мешает удалению
+TEST_F(StudentStatsTest, KeyMigrationKeepsGradeHistoryOfDuplicates) {
+    const int a = students[0].first;
+    ASSERT_TRUE(db->upsertGradeByKey(a, 1, 1, 7, "2025-11-03"));
+
+    int kept = 0;
+    ASSERT_TRUE(db->findGradeId(a, 1, 1, "2025-11-03", kept));
+    ASSERT_GT(kept, 0);
+
+    ASSERT_TRUE(db->execute("DROP INDEX idxgradeskey;"));
+    ASSERT_TRUE(db->execute("INSERT INTO grades (studentid, subjectid, semesterid, value, date, gradetype) "
+                            "VALUES (" + std::to_string(a) + ", 1, 1, 9, '2025-11-03', 'dup');"));
+    const int duplicate = static_cast<int>(sqlite3_last_insert_rowid(db->getHandle()));
+    ASSERT_TRUE(db->execute("INSERT INTO gradechanges (gradeid, oldvalue, newvalue, changedby, changedate) "
+                            "VALUES (" + std::to_string(duplicate) + ", 7, 9, " + std::to_string(a) +
+                            ", '2025-11-04');"));
+    ASSERT_TRUE(db->execute("PRAGMA user_version = 0;"));
+
+    db = std::make_unique<Database>(dbCopy.path());
+    ASSERT_TRUE(db->connect());
+    ASSERT_TRUE(db->initialize());
+
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_EQ(sqlite3_prepare_v2(db->getHandle(),
+        "SELECT (SELECT COUNT(*) FROM grades WHERE id = ?1),"
+        "       (SELECT COUNT(*) FROM gradechanges WHERE gradeid = ?1),"
+        "       (SELECT COUNT(*) FROM grades WHERE id = ?2);",
+        -1, &stmt, nullptr), SQLITE_OK);
+    sqlite3_bind_int(stmt, 1, kept);
+    sqlite3_bind_int(stmt, 2, duplicate);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), 1);
+    EXPECT_EQ(sqlite3_column_int(stmt, 1), 1);
+    EXPECT_EQ(sqlite3_column_int(stmt, 2), 0);
+    sqlite3_finalize(stmt);
+    EXPECT_EQ(countMismatches(*db), 0);
+}
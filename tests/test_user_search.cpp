@@ -0,0 +1,165 @@
+#include "../database.h"
+#include "db_copy_fixture.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Database::searchUsers (таблица пользователей админки): сравниваем с прямым фильтром
+// по getAllUsers — подстрока "ФИО логин" без учёта регистра, роль, страницы, сортировка.
+// Запросы от 3 символов идут через индекс userssearch, короткие — сканом users.
+
+namespace {
+
+using UserRow = std::tuple<int, std::string, std::string, std::string, int, int>;
+
+// Нижний регистр для ASCII и кириллицы (А-Я, Ё), как SQL-функция foldcase
+std::string foldCase(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        const auto c = static_cast<unsigned char>(s[i]);
+        if (c >= 'A' && c <= 'Z') {
+            out += static_cast<char>(c - 'A' + 'a');
+        } else if (c == 0xD0 && i + 1 < s.size()) {
+            const auto n = static_cast<unsigned char>(s[++i]);
+            if (n >= 0x90 && n <= 0x9F) {          // А-П -> а-п
+                out += '\xD0';
+                out += static_cast<char>(n + 0x20);
+            } else if (n >= 0xA0 && n <= 0xAF) {   // Р-Я -> р-я
+                out += '\xD1';
+                out += static_cast<char>(n - 0x20);
+            } else if (n == 0x81) {                // Ё -> ё
+                out += "\xD1\x91";
+            } else {
+                out += static_cast<char>(c);
+                out += static_cast<char>(n);
+            }
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out;
+}
+
+std::vector<UserRow> bruteSearch(const std::vector<UserRow>& users, const std::string& query, const std::string& role)
+{
+    const std::string needle = foldCase(query);
+    std::vector<UserRow> out;
+    for (const auto& u : users) {
+        if (!role.empty() && std::get<3>(u) != role) continue;
+        if (foldCase(std::get<2>(u) + " " + std::get<1>(u)).find(needle) == std::string::npos) continue;
+        out.push_back(u);
+    }
+    return out;
+}
+
+std::vector<int> ids(const std::vector<UserRow>& rows)
+{
+    std::vector<int> out;
+    for (const auto& r : rows) out.push_back(std::get<0>(r));
+    return out;
+}
+
+} // namespace
+
+class UserSearchTest : public SchoolDbTest {
+protected:
+    UserSearchTest() : SchoolDbTest("user_search_school.db") {}
+
+    // Все страницы по pageSize подряд
+    std::vector<UserRow> searchAll(const std::string& query, const std::string& role, int pageSize,
+                                   Database::UserSortKey sortKey = Database::UserSortKey::Id,
+                                   bool ascending = true)
+    {
+        std::vector<UserRow> all;
+        int total = -1;
+        for (int offset = 0;; offset += pageSize) {
+            std::vector<UserRow> page;
+            int pageTotal = 0;
+            EXPECT_TRUE(db->searchUsers(query, role, offset, pageSize, page, pageTotal, sortKey, ascending));
+            if (total >= 0) {
+                EXPECT_EQ(pageTotal, total) << "total changed between pages: " << query;
+            }
+            total = pageTotal;
+            all.insert(all.end(), page.begin(), page.end());
+            if (page.empty() || offset + pageSize >= total) break;
+        }
+        EXPECT_EQ(static_cast<int>(all.size()), total) << query;
+        return all;
+    }
+};
+
+TEST_F(UserSearchTest, MatchesBruteForceFilter) {
+    std::vector<UserRow> users;
+    ASSERT_TRUE(db->getAllUsers(users));
+    ASSERT_FALSE(users.empty());
+
+    const std::vector<std::string> queries = {
+        "", "s4206", "S4206", "ал", "Ал", "алекс", "АЛЕКСАНДР", "евич", "ё", "t_", "02_1",
+        "  серг  ", "нет такого", "\"", "a OR b", "*",
+    };
+    const std::vector<std::string> roles = {"", "student", "teacher", "admin"};
+
+    for (const auto& role : roles) {
+        for (const auto& query : queries) {
+            // searchUsers обрезает пробелы запроса
+            std::string trimmed = query;
+            trimmed.erase(0, trimmed.find_first_not_of(' '));
+            trimmed.erase(trimmed.find_last_not_of(' ') + 1);
+
+            const auto expected = bruteSearch(users, trimmed, role);
+            EXPECT_EQ(ids(searchAll(query, role, 7)), ids(expected)) << "query='" << query << "' role=" << role;
+        }
+    }
+}
+
+TEST_F(UserSearchTest, PagesAndSorting) {
+    std::vector<UserRow> users;
+    ASSERT_TRUE(db->getAllUsers(users));
+    auto expected = bruteSearch(users, "", "student");
+    ASSERT_GT(expected.size(), 20u);
+
+    // ORDER BY name DESC, id DESC: SQLite сравнивает TEXT побайтно, как std::string
+    std::sort(expected.begin(), expected.end(), [](const UserRow& a, const UserRow& b) {
+        return std::tie(std::get<2>(a), std::get<0>(a)) > std::tie(std::get<2>(b), std::get<0>(b));
+    });
+    EXPECT_EQ(ids(searchAll("", "student", 10, Database::UserSortKey::Name, false)), ids(expected));
+
+    // Страница за концом: пустая, но с общим числом
+    std::vector<UserRow> page;
+    int total = 0;
+    ASSERT_TRUE(db->searchUsers("", "student", static_cast<int>(expected.size()), 10, page, total));
+    EXPECT_TRUE(page.empty());
+    EXPECT_EQ(total, static_cast<int>(expected.size()));
+
+    // limit 0 — только число совпадений
+    ASSERT_TRUE(db->searchUsers("", "", 0, 0, page, total));
+    EXPECT_TRUE(page.empty());
+    EXPECT_EQ(total, static_cast<int>(users.size()));
+}
+
+TEST_F(UserSearchTest, IndexFollowsUserChanges) {
+    auto findIds = [&](const std::string& query) {
+        std::vector<UserRow> page;
+        int total = 0;
+        EXPECT_TRUE(db->searchUsers(query, "", 0, 50, page, total));
+        return ids(page);
+    };
+
+    ASSERT_TRUE(db->execute(
+        "INSERT INTO users (id, username, password, role, name, groupid, subgroup) "
+        "VALUES (9001, 'zz_search', '123', 'student', 'Щукина Ярослава', NULL, 0);"));
+    EXPECT_EQ(findIds("щукина"), std::vector<int>{9001});
+    EXPECT_EQ(findIds("zz_se"), std::vector<int>{9001});
+
+    ASSERT_TRUE(db->execute("UPDATE users SET name = 'Юрченко Ярослава' WHERE id = 9001;"));
+    EXPECT_TRUE(findIds("щукина").empty());
+    EXPECT_EQ(findIds("юрченко"), std::vector<int>{9001});
+
+    ASSERT_TRUE(db->execute("DELETE FROM users WHERE id = 9001;"));
+    EXPECT_TRUE(findIds("юрченко").empty());
+    EXPECT_TRUE(findIds("zz_se").empty());
+}
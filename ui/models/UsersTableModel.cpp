@@ -0,0 +1,182 @@
+#include "UsersTableModel.h"
+
+UsersTableModel::UsersTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void UsersTableModel::setPageLoader(PageLoader l)
+{
+    loader = std::move(l);
+}
+
+bool UsersTableModel::reload()
+{
+    Rows page;
+    int newTotal = 0;
+    const bool ok = loader && loader(0, kPageSize, sortColumn, sortOrder, page, newTotal);
+
+    beginResetModel();
+    clearRows();
+    total = ok ? newTotal : 0;
+    if (ok) appendRows(page);
+    endResetModel();
+    return ok;
+}
+
+void UsersTableModel::clear()
+{
+    beginResetModel();
+    clearRows();
+    total = 0;
+    endResetModel();
+}
+
+void UsersTableModel::clearRows()
+{
+    ids.clear();
+    names.clear();
+    usernames.clear();
+    rawRoles.clear();
+    groupIds.clear();
+    subgroups.clear();
+}
+
+void UsersTableModel::appendRows(const Rows& users)
+{
+    const size_t n = ids.size() + users.size();
+    ids.reserve(n);
+    names.reserve(n);
+    usernames.reserve(n);
+    rawRoles.reserve(n);
+    groupIds.reserve(n);
+    subgroups.reserve(n);
+
+    for (const auto& u : users) {
+        ids.push_back(std::get<0>(u));
+        usernames.push_back(QString::fromStdString(std::get<1>(u)));
+        names.push_back(QString::fromStdString(std::get<2>(u)));
+        rawRoles.push_back(QString::fromStdString(std::get<3>(u)));
+        groupIds.push_back(std::get<4>(u));
+        subgroups.push_back(std::get<5>(u));
+    }
+}
+
+int UsersTableModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return static_cast<int>(ids.size());
+}
+
+int UsersTableModel::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return ColumnCount;
+}
+
+QVariant UsersTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) return {};
+    const int row = index.row();
+    if (row < 0 || row >= rowCount()) return {};
+    const size_t r = static_cast<size_t>(row);
+
+    if (role == RoleNameRole) {
+        return rawRoles[r];
+    }
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case ColId: return QString::number(ids[r]);
+        case ColName: return names[r];
+        case ColLogin: return usernames[r];
+        case ColRole: return rawRoles[r];
+        case ColGroup: return QString::number(groupIds[r]);
+        case ColSubgroup: return QString::number(subgroups[r]);
+        default: return {};
+        }
+    }
+
+    return {};
+}
+
+QVariant UsersTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case ColId: return QStringLiteral("ID");
+    case ColName: return QStringLiteral("ФИО");
+    case ColLogin: return QStringLiteral("login");
+    case ColRole: return QStringLiteral("role");
+    case ColGroup: return QStringLiteral("groupId");
+    case ColSubgroup: return QStringLiteral("subgroup");
+    default: return {};
+    }
+}
+
+bool UsersTableModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return false;
+    return loader && rowCount() < total;
+}
+
+void UsersTableModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) return;
+
+    Rows page;
+    int newTotal = 0;
+    if (!loader(rowCount(), kPageSize, sortColumn, sortOrder, page, newTotal) || page.empty()) {
+        // БД изменилась или ошибка — больше не подгружаем, до следующего reload()
+        total = rowCount();
+        return;
+    }
+
+    const int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(page.size()) - 1);
+    appendRows(page);
+    endInsertRows();
+    total = newTotal;
+}
+
+void UsersTableModel::sort(int column, Qt::SortOrder order)
+{
+    if (column < 0 || column >= ColumnCount) return;
+    if (column == sortColumn && order == sortOrder) return;
+
+    sortColumn = column;
+    sortOrder = order;
+    reload();
+}
+
+UsersTableModel::UserRow UsersTableModel::userAt(int row) const
+{
+    UserRow u;
+    if (row < 0 || row >= rowCount()) return u;
+    const size_t r = static_cast<size_t>(row);
+    u.id = ids[r];
+    u.name = names[r];
+    u.username = usernames[r];
+    u.role = rawRoles[r];
+    u.groupId = groupIds[r];
+    u.subgroup = subgroups[r];
+    return u;
+}
+
+int UsersTableModel::userIdAt(int row) const
+{
+    if (row < 0 || row >= rowCount()) return 0;
+    return ids[static_cast<size_t>(row)];
+}
+
+UsersTableModel::Role UsersTableModel::parseRole(const QString& role)
+{
+    const QString r = role.trimmed().toLower();
+    if (r == QLatin1String("admin")) return Role::Admin;
+    if (r == QLatin1String("teacher")) return Role::Teacher;
+    if (r == QLatin1String("student")) return Role::Student;
+    return Role::Other;
+}
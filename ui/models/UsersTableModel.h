@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QString>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Таблица пользователей для админки.
+//
+// Строки подгружаются страницами через PageLoader (Database::searchUsers):
+// сначала первая страница, дальше view сам просит fetchMore() при прокрутке.
+// Фильтр и сортировка выполняются в БД — смена запроса сбрасывает модель
+// и загружает первую страницу заново.
+//
+// Загруженные строки лежат по колонкам (отдельный непрерывный вектор на поле),
+// view запрашивает только видимые ячейки через data().
+class UsersTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        ColId = 0,
+        ColName,
+        ColLogin,
+        ColRole,
+        ColGroup,
+        ColSubgroup,
+        ColumnCount
+    };
+
+    enum class Role : std::uint8_t { Other = 0, Admin, Teacher, Student };
+
+    // Сырое значение role ("admin"/"teacher"/"student") — для делегата и диалогов
+    static constexpr int RoleNameRole = Qt::UserRole + 1;
+
+    static constexpr int kPageSize = 200;
+
+    // Формат Database::getAllUsers: (id, username, name, role, groupId, subgroup)
+    using Rows = std::vector<std::tuple<int, std::string, std::string, std::string, int, int>>;
+
+    // Страница [offset, offset + limit) в порядке (sortColumn, order); outTotal — всего строк
+    using PageLoader = std::function<bool(int offset, int limit, int sortColumn, Qt::SortOrder order,
+                                          Rows& outRows, int& outTotal)>;
+
+    struct UserRow {
+        int id = 0;
+        QString name;
+        QString username;
+        QString role;
+        int groupId = 0;
+        int subgroup = 0;
+    };
+
+    explicit UsersTableModel(QObject* parent = nullptr);
+
+    void setPageLoader(PageLoader loader);
+    // Сбросить загруженные строки и загрузить первую страницу; false — ошибка загрузчика
+    bool reload();
+    void clear();
+
+    int totalCount() const { return total; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    // Сортировка на стороне БД: запоминаем колонку и перезагружаем
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    UserRow userAt(int row) const;
+    int userIdAt(int row) const;
+
+    static Role parseRole(const QString& role);
+
+private:
+    void clearRows();
+    void appendRows(const Rows& users);
+
+    PageLoader loader;
+    int total = 0;
+    int sortColumn = ColId;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+
+    std::vector<int> ids;
+    std::vector<QString> names;
+    std::vector<QString> usernames;
+    std::vector<QString> rawRoles;
+    std::vector<int> groupIds;
+    std::vector<int> subgroups;
+};
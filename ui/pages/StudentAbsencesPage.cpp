@@ -175,23 +175,34 @@ void StudentAbsencesPage::updateMonthlyStats()
     if (!db || semesterId <= 0) return;
     if (selectedYear <= 0 || selectedMonth <= 0) return;
 
+    // Итоги месяца — из серии, загруженной в reload(); переключение месяца/предмета без запросов
+    const int subjId = subjectIdForCurrentFilter();
     int allTotal = 0;
     int allUnexc = 0;
-    if (db->getStudentAbsenceHoursForMonth(studentId, semesterId, selectedYear, selectedMonth, /*subjectId*/0, allTotal, allUnexc) && (allTotal > 0 || allUnexc > 0)) {
+    int subTotal = 0;
+    int subUnexc = 0;
+    for (const auto& m : cachedMonthSeries) {
+        if (m.year != selectedYear || m.month != selectedMonth) continue;
+        allTotal += m.absenceHours;
+        allUnexc += m.unexcusedHours;
+        if (subjId > 0 && m.subjectId == subjId) {
+            subTotal += m.absenceHours;
+            subUnexc += m.unexcusedHours;
+        }
+    }
+
+    if (allTotal > 0 || allUnexc > 0) {
         absAllMonthLabel->setText(QString("Пропуски по всем предметам за месяц: %1 ч (неуваж %2)").arg(allTotal).arg(allUnexc));
     } else {
         absAllMonthLabel->setText("Пропуски по всем предметам за месяц: —");
     }
 
-    const int subjId = subjectIdForCurrentFilter();
     if (subjId <= 0) {
         absSubjectMonthLabel->setText("Пропуски по выбранному предмету за месяц: —");
         return;
     }
 
-    int subTotal = 0;
-    int subUnexc = 0;
-    if (db->getStudentAbsenceHoursForMonth(studentId, semesterId, selectedYear, selectedMonth, subjId, subTotal, subUnexc) && (subTotal > 0 || subUnexc > 0)) {
+    if (subTotal > 0 || subUnexc > 0) {
         absSubjectMonthLabel->setText(QString("Пропуски по выбранному предмету за месяц: %1 ч (неуваж %2)").arg(subTotal).arg(subUnexc));
     } else {
         absSubjectMonthLabel->setText("Пропуски по выбранному предмету за месяц: —");
@@ -374,12 +385,15 @@ QWidget* StudentAbsencesPage::buildAbsenceCard(const AbsenceRow& r)
     const QString time = QString::fromStdString(r.lessonTime);
     const QString subject = QString::fromStdString(r.subject);
     const QString lessonType = QString::fromStdString(r.lessonType);
+    const QString room = QString::fromStdString(r.room);
 
     auto* title = new QLabel(subject, card);
     title->setStyleSheet("font-weight: 800; font-size: 14px; color: palette(WindowText);");
     grid->addWidget(title, 0, 0, 1, 2);
 
-    auto* meta = new QLabel(QString("%1  •  %2").arg(date, time.isEmpty() ? "—" : time), card);
+    QString metaText = QString("%1  •  %2").arg(date, time.isEmpty() ? "—" : time);
+    if (!room.isEmpty()) metaText += QString("  •  ауд. %1").arg(room);
+    auto* meta = new QLabel(metaText, card);
     meta->setStyleSheet("color: palette(mid); font-weight: 600;");
     grid->addWidget(meta, 1, 0, 1, 2);
 
@@ -540,8 +554,9 @@ void StudentAbsencesPage::reload()
         return;
     }
 
-    std::vector<std::tuple<std::string, int, std::string, std::string>> absences;
-    if (!db->getStudentAbsencesForSemester(studentId, semesterId, absences)) {
+    // Номер пары и тип занятия приходят вместе с пропусками — без запросов расписания на каждую строку
+    std::vector<StudentLessonRecord> absences;
+    if (!db->getStudentAbsencesWithLessons(studentId, semesterId, absences)) {
         cachedAbsences.clear();
         showEmptyState("Не удалось загрузить пропуски");
         return;
@@ -550,56 +565,32 @@ void StudentAbsencesPage::reload()
     cachedAbsences.clear();
     cachedAbsences.reserve(absences.size());
 
-    int groupId = 0;
-    int subgroup = 0;
-    if (db) {
-        db->getStudentGroupAndSubgroup(studentId, groupId, subgroup);
-    }
-
     const QStringList pairTimes = {
         "08:30-09:55", "10:05-11:30", "12:00-13:25",
         "13:35-15:00", "15:30-16:55", "17:05-18:30"
     };
 
-    for (const auto& a : absences) {
+    for (auto& a : absences) {
         AbsenceRow r;
-        r.subject = std::get<0>(a);
-        r.hours = std::get<1>(a);
-        r.date = std::get<2>(a);
-        r.type = std::get<3>(a);
+        r.subject = std::move(a.subject);
+        r.hours = a.value;
+        r.date = std::move(a.date);
+        r.type = std::move(a.type);
+        r.room = std::move(a.room);
 
         r.lessonTime = "—";
-        r.lessonType = "—";
-        if (db && groupId > 0 && !r.date.empty() && !r.subject.empty()) {
-            const QDate d = QDate::fromString(QString::fromStdString(r.date), "yyyy-MM-dd");
-            if (d.isValid()) {
-                const int weekday = d.dayOfWeek() - 1;
-                const int weekId = db->getWeekIdByDate(r.date);
-                const int weekOfCycle = (weekId > 0) ? db->getWeekOfCycleByWeekId(weekId) : 0;
-
-                if (weekday >= 0 && weekOfCycle > 0) {
-                    std::vector<std::tuple<int, int, int, std::string, std::string, std::string, std::string>> sched;
-                    if (db->getScheduleForGroup(groupId, weekday, weekOfCycle, sched)) {
-                        for (const auto& s : sched) {
-                            const int lessonNumber = std::get<1>(s);
-                            const std::string& subj = std::get<3>(s);
-                            const std::string& ltype = std::get<5>(s);
-                            if (subj == r.subject) {
-                                if (lessonNumber >= 1 && lessonNumber <= pairTimes.size()) {
-                                    r.lessonTime = pairTimes[lessonNumber - 1].toStdString();
-                                }
-                                r.lessonType = ltype.empty() ? "—" : ltype;
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
+        if (a.lessonNumber >= 1 && a.lessonNumber <= pairTimes.size()) {
+            r.lessonTime = pairTimes[a.lessonNumber - 1].toStdString();
         }
+        r.lessonType = a.lessonType.empty() ? "—" : a.lessonType;
 
         cachedAbsences.push_back(std::move(r));
     }
 
+    if (!db->getStudentMonthSeries(studentId, semesterId, cachedMonthSeries)) {
+        cachedMonthSeries.clear();
+    }
+
     populateSubjectsFromCache();
     populateMonthsFromCache();
     updateTotalsFromCache();
@@ -6,6 +6,7 @@
 #include <string>
 
 class Database;
+struct StudentMonthStats;
 class QLabel;
 class QComboBox;
 class QPushButton;
@@ -29,6 +30,7 @@ private:
         std::string type;
         std::string lessonTime;
         std::string lessonType;
+        std::string room;
     };
 
     Database* db;
@@ -69,6 +71,8 @@ private:
     QPushButton* retryButton;
 
     std::vector<AbsenceRow> cachedAbsences;
+    // Помесячные итоги семестра (Database::getStudentMonthSeries), загружаются в reload()
+    std::vector<StudentMonthStats> cachedMonthSeries;
 
     void setupLayout();
 
@@ -180,23 +180,31 @@ void StudentGradesPage::updateMonthlyStats()
     if (!db || semesterId <= 0) return;
     if (selectedYear <= 0 || selectedMonth <= 0) return;
 
-    // all subjects
-    double allAvg = 0.0;
+    // Итоги месяца — из серии, загруженной в reload(); переключение месяца/предмета без запросов
+    const int subjId = subjectIdForCurrentFilter();
+    int allSum = 0;
     int allCnt = 0;
-    if (db->getStudentAverageGradeForMonth(studentId, semesterId, selectedYear, selectedMonth, /*subjectId*/0, allAvg, allCnt) && allCnt > 0) {
+    int subSum = 0;
+    int subCnt = 0;
+    for (const auto& m : cachedMonthSeries) {
+        if (m.year != selectedYear || m.month != selectedMonth) continue;
+        allSum += m.gradeSum;
+        allCnt += m.gradeCount;
+        if (subjId > 0 && m.subjectId == subjId) {
+            subSum += m.gradeSum;
+            subCnt += m.gradeCount;
+        }
+    }
+
+    if (allCnt > 0) {
+        const double allAvg = static_cast<double>(allSum) / allCnt;
         avgAllMonthLabel->setText(QString("Средний по всем предметам: %1 (%2)").arg(allAvg, 0, 'f', 2).arg(allCnt));
     } else {
         avgAllMonthLabel->setText("Средний по всем предметам: —");
     }
 
-    const int subjId = subjectIdForCurrentFilter();
-    if (subjId <= 0) {
-        avgSubjectMonthLabel->setText("Средний по выбранному предмету: —");
-        return;
-    }
-    double subAvg = 0.0;
-    int subCnt = 0;
-    if (db->getStudentAverageGradeForMonth(studentId, semesterId, selectedYear, selectedMonth, subjId, subAvg, subCnt) && subCnt > 0) {
+    if (subjId > 0 && subCnt > 0) {
+        const double subAvg = static_cast<double>(subSum) / subCnt;
         avgSubjectMonthLabel->setText(QString("Средний по выбранному предмету: %1 (%2)").arg(subAvg, 0, 'f', 2).arg(subCnt));
     } else {
         avgSubjectMonthLabel->setText("Средний по выбранному предмету: —");
@@ -231,12 +239,15 @@ QWidget* StudentGradesPage::buildGradeCard(const GradeRow& g)
     const QString time = QString::fromStdString(g.lessonTime);
     const QString subject = QString::fromStdString(g.subject);
     const QString gradeType = QString::fromStdString(g.type);
+    const QString room = QString::fromStdString(g.room);
 
     auto* title = new QLabel(subject, card);
     title->setStyleSheet("font-weight: 800; font-size: 14px; color: palette(WindowText);");
     grid->addWidget(title, 0, 0, 1, 2);
 
-    auto* meta = new QLabel(QString("%1  •  %2").arg(date, time.isEmpty() ? "—" : time), card);
+    QString metaText = QString("%1  •  %2").arg(date, time.isEmpty() ? "—" : time);
+    if (!room.isEmpty()) metaText += QString("  •  ауд. %1").arg(room);
+    auto* meta = new QLabel(metaText, card);
     meta->setStyleSheet("color: palette(mid); font-weight: 600;");
     grid->addWidget(meta, 1, 0, 1, 2);
 
@@ -515,8 +526,9 @@ void StudentGradesPage::reload()
         return;
     }
 
-    std::vector<std::tuple<std::string, int, std::string, std::string>> grades;
-    if (!db->getStudentGradesForSemester(studentId, semesterId, grades)) {
+    // Номер пары и тип занятия приходят вместе с оценками — без запросов расписания на каждую строку
+    std::vector<StudentLessonRecord> grades;
+    if (!db->getStudentGradesWithLessons(studentId, semesterId, grades)) {
         showEmptyState("Не удалось загрузить оценки");
         return;
     }
@@ -524,79 +536,30 @@ void StudentGradesPage::reload()
     cachedGrades.clear();
     cachedGrades.reserve(grades.size());
 
-    int groupId = 0;
-    int subgroup = 0;
-    if (db) {
-        db->getStudentGroupAndSubgroup(studentId, groupId, subgroup);
-    }
-
     const QStringList pairTimes = {
         "08:30-09:55", "10:05-11:30", "12:00-13:25",
         "13:35-15:00", "15:30-16:55", "17:05-18:30"
     };
-    for (const auto& grade : grades) {
+    for (auto& grade : grades) {
         GradeRow r;
-        r.subject = std::get<0>(grade);
-        r.value = std::get<1>(grade);
-        r.date = std::get<2>(grade);
-        r.type = std::get<3>(grade);
+        r.subject = std::move(grade.subject);
+        r.value = grade.value;
+        r.date = std::move(grade.date);
+        r.type = std::move(grade.type);
+        r.room = std::move(grade.room);
 
         r.lessonTime = "—";
-        r.lessonType = "—";
-        if (db && groupId > 0 && !r.date.empty() && !r.subject.empty()) {
-            const QDate d = QDate::fromString(QString::fromStdString(r.date), "yyyy-MM-dd");
-            if (d.isValid()) {
-                const int weekday = d.dayOfWeek();
-                const int weekId = db->getWeekIdByDate(r.date);
-                const int weekOfCycle = (weekId > 0) ? db->getWeekOfCycleByWeekId(weekId) : 0;
-
-                if (weekday >= 1 && weekday <= 6 && weekOfCycle > 0) {
-                    std::vector<std::tuple<int, int, int, std::string, std::string, std::string, std::string>> sched;
-                    if (db->getScheduleForGroup(groupId, weekday, weekOfCycle, sched)) {
-                        int bestLessonNumber = 0;
-                        std::string bestLessonType;
-                        bool foundAny = false;
-                        bool foundPreferred = false;
-
-                        for (const auto& s : sched) {
-                            const int lessonNumber = std::get<1>(s);
-                            const int schSubgroup = std::get<2>(s);
-                            const std::string& subj = std::get<3>(s);
-                            const std::string& ltype = std::get<5>(s);
-                            if (subj != r.subject) continue;
-
-                            if (!(schSubgroup == 0 || subgroup == 0 || schSubgroup == subgroup)) continue;
-
-                            if (!foundAny) {
-                                bestLessonNumber = lessonNumber;
-                                bestLessonType = ltype;
-                                foundAny = true;
-                            }
-
-                            const QString lt = QString::fromStdString(ltype);
-                            const bool isLecture = lt.contains("ЛК", Qt::CaseInsensitive);
-                            if (!isLecture) {
-                                bestLessonNumber = lessonNumber;
-                                bestLessonType = ltype;
-                                foundPreferred = true;
-                                break;
-                            }
-                        }
-
-                        if (foundAny) {
-                            if (bestLessonNumber >= 1 && bestLessonNumber <= pairTimes.size()) {
-                                r.lessonTime = pairTimes[bestLessonNumber - 1].toStdString();
-                            }
-                            (void)foundPreferred;
-                            r.lessonType = bestLessonType.empty() ? "—" : bestLessonType;
-                        }
-                    }
-                }
-            }
+        if (grade.lessonNumber >= 1 && grade.lessonNumber <= pairTimes.size()) {
+            r.lessonTime = pairTimes[grade.lessonNumber - 1].toStdString();
         }
+        r.lessonType = grade.lessonType.empty() ? "—" : grade.lessonType;
         cachedGrades.push_back(std::move(r));
     }
 
+    if (!db->getStudentMonthSeries(studentId, semesterId, cachedMonthSeries)) {
+        cachedMonthSeries.clear();
+    }
+
     populateSubjectsFromCache();
     populateMonthsFromCache();
     applyFilterToTimeline();
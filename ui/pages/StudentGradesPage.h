@@ -6,6 +6,7 @@
  #include <string>
 
 class Database;
+struct StudentMonthStats;
 class QLabel;
 class QComboBox;
 class QPushButton;
@@ -30,6 +31,7 @@ private:
         std::string type;
         std::string lessonTime;
         std::string lessonType;
+        std::string room;
     };
 
     Database* db;
@@ -67,6 +69,8 @@ private:
     void showContent();
 
     std::vector<GradeRow> cachedGrades;
+    // Помесячные итоги семестра (Database::getStudentMonthSeries), загружаются в reload()
+    std::vector<StudentMonthStats> cachedMonthSeries;
     void populateSubjectsFromCache();
     void populateMonthsFromCache();
     void applyFilterToTimeline();
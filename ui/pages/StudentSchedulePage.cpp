@@ -1,5 +1,6 @@
 #include "ui/pages/StudentSchedulePage.h"
 #include "database.h"
+#include "ui/util/DbExecutor.h"
 #include "ui/util/UiStyle.h"
  #include "ui/widgets/WeekGridScheduleWidget.h"
  #include "ui/windows/TeacherScheduleViewer.h"
@@ -310,7 +311,16 @@ void StudentSchedulePage::loadSchedule()
 
     // 3) Новый вид: сетка недели
     if (weekGrid) {
-        weekGrid->setSchedule(db, groupId, weekOfCycle, resolvedWeekId, currentSubgroup);
+        const int subgroup = currentSubgroup;
+        DbExecutor::instance().run<WeekGridScheduleWidget::GroupWeek>(
+            DbExecutor::channel(this, "student.schedule"),
+            [=](Database& wdb) {
+                return WeekGridScheduleWidget::loadGroupWeek(wdb, groupId, weekOfCycle, resolvedWeekId, subgroup);
+            },
+            this,
+            [this, subgroup](const WeekGridScheduleWidget::GroupWeek& week) {
+                if (weekGrid) weekGrid->showGroupWeek(week, subgroup);
+            });
         weekGrid->setVisible(true);
         emptyStateLabel->setVisible(false);
         table->setVisible(false);
@@ -326,15 +336,15 @@ void StudentSchedulePage::loadSchedule()
 
     int totalRows = 0;
 
+    GroupWeekSchedule week;
+    if (!db->getScheduleForGroupWeek(groupId, weekOfCycle, currentSubgroup, week)) {
+        week = {};
+    }
+
     for (int weekday = 1; weekday <= 6; ++weekday) {
         bool dayHeaderAdded = false;
 
-        std::vector<std::tuple<int,int,int,std::string,std::string,std::string,std::string>> rows;
-        if (!db->getScheduleForGroup(groupId, weekday, weekOfCycle, rows)) {
-            continue;
-        }
-
-        for (const auto& r : rows) {
+        for (const auto& r : week.day(weekday)) {
 
             const int lessonNum = std::get<1>(r);
             const int rowSubgroup = std::get<2>(r);
@@ -0,0 +1,105 @@
+#include "ui/util/DbExecutor.h"
+
+#include "core/connection_pool.h"
+#include "core/lesson_slot_index.h"
+#include "database.h"
+#include "ui/util/AppEvents.h"
+
+#include <QCoreApplication>
+#include <QThreadPool>
+
+#include <iostream>
+
+DbExecutor& DbExecutor::instance()
+{
+    static DbExecutor inst;
+    return inst;
+}
+
+DbExecutor::DbExecutor(QObject* parent)
+    : QObject(parent)
+{
+    // Календарь недель кэшируется в каждом соединении пула, индексы занятий групп — общие
+    connect(&AppEvents::instance(), &AppEvents::scheduleChanged, this, [this]() {
+        if (connections) connections->invalidateCalendars();
+        LessonSlotIndexCache::instance().invalidate();
+    });
+}
+
+DbExecutor::~DbExecutor()
+{
+    stop();
+}
+
+bool DbExecutor::start(const std::string& dbFile, int readers)
+{
+    if (connections) return true;
+
+    auto pool = std::make_unique<ConnectionPool>(
+        dbFile, readers > 0 ? readers : ConnectionPool::defaultReaderCount());
+    if (!pool->open()) {
+        std::cerr << "[✗] DbExecutor: cannot open connection pool: " << dbFile << std::endl;
+        return false;
+    }
+
+    // Потоков столько же, сколько читающих соединений: задача не ждёт соединения
+    threads = new QThreadPool(this);
+    threads->setMaxThreadCount(pool->readerCount());
+    threads->setObjectName("DbExecutor");
+    connections = std::move(pool);
+
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &DbExecutor::stop, Qt::UniqueConnection);
+    return true;
+}
+
+void DbExecutor::stop()
+{
+    if (!connections) return;
+
+    // Все ожидающие задачи становятся устаревшими и только отменяют свои future
+    channels.cancelAll();
+
+    // Не начатые задачи уничтожаются (их promise отменяется), начатые дорабатывают
+    threads->clear();
+    threads->waitForDone();
+    delete threads;
+    threads = nullptr;
+
+    connections->close();
+    connections.reset();
+}
+
+DbExecutor::Ticket DbExecutor::issueTicket(const QString& channel)
+{
+    return channels.issue(channel.toStdString());
+}
+
+void DbExecutor::cancel(const QString& channel)
+{
+    channels.cancel(channel.toStdString());
+}
+
+QString DbExecutor::channel(const QObject* owner, const char* name)
+{
+    const QString key = QString("%1@%2").arg(QLatin1String(name)).arg(reinterpret_cast<quintptr>(owner), 0, 16);
+    if (owner) instance().watchOwner(owner, key);
+    return key;
+}
+
+void DbExecutor::watchOwner(const QObject* owner, const QString& channel)
+{
+    // Одно подключение на владельца; после release() адрес может достаться новому окну
+    if (!channels.bind(channel.toStdString(), owner)) return;
+    connect(owner, &QObject::destroyed, this, [this, owner]() { channels.release(owner); });
+}
+
+void DbExecutor::post(std::function<void(Database* db)> task)
+{
+    if (!connections || !threads) return;
+
+    ConnectionPool* pool = connections.get();
+    threads->start([pool, task = std::move(task)]() {
+        ConnectionPool::Lease lease = pool->read();
+        task(lease.get());
+    });
+}
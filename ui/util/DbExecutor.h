@@ -0,0 +1,125 @@
+#pragma once
+
+#include "core/request_channels.h"
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+class ConnectionPool;
+class Database;
+class QThreadPool;
+
+// Выполняет чтения из БД на рабочих потоках, чтобы медленный запрос
+// не блокировал отрисовку окон. Каждая задача берёт читающее соединение
+// из ConnectionPool, так что запросы разных окон/вкладок идут параллельно.
+//
+// Задачи — функции Database& -> T; результат приходит через QFuture<T>
+// (или сразу в слот-лямбду на потоке окна через run()).
+// Каждая задача принадлежит "каналу" (например "teacher.schedule"): новая задача
+// в канале делает все предыдущие устаревшими — ещё не начатые не выполняются,
+// а результаты уже выполненных не доставляются. Так быстрые переключения
+// группы/периода не выстраивают очередь из ненужных запросов.
+//
+// Записи в БД по-прежнему идут через основное соединение (Database* окна).
+class DbExecutor : public QObject {
+    Q_OBJECT
+public:
+    static DbExecutor& instance();
+
+    // Открыть пул соединений к файлу БД и запустить рабочие потоки
+    // (readers <= 0 — ConnectionPool::defaultReaderCount())
+    bool start(const std::string& dbFile, int readers = 0);
+    // Отбросить ожидающие задачи, дождаться выполняемых и закрыть пул
+    void stop();
+    bool isRunning() const { return connections != nullptr; }
+
+    // Поставить задачу в очередь; future отменяется, если задача устарела
+    // или исполнитель не запущен.
+    template <typename T>
+    QFuture<T> submit(const QString& channel, std::function<T(Database&)> job);
+
+    // submit + вызов onResult(const T&) на потоке context, если к этому моменту
+    // в канале не появилось более новой задачи и context ещё жив.
+    template <typename T, typename Fn>
+    void run(const QString& channel, std::function<T(Database&)> job, QObject* context, Fn onResult);
+
+    // Сделать устаревшими все задачи канала
+    void cancel(const QString& channel);
+
+    // Канал, уникальный для окна/страницы: два открытых окна не отменяют запросы друг друга.
+    // Каналы владельца удаляются, когда он уничтожается (QObject::destroyed).
+    static QString channel(const QObject* owner, const char* name);
+
+private:
+    explicit DbExecutor(QObject* parent = nullptr);
+    ~DbExecutor() override;
+
+    using Ticket = RequestChannels::Ticket;
+
+    Ticket issueTicket(const QString& channel);
+    void watchOwner(const QObject* owner, const QString& channel);
+
+    template <typename T>
+    QFuture<T> submitTicket(const Ticket& ticket, std::function<T(Database&)> job);
+
+    // Выполнить task на рабочем потоке с читающим соединением; db == nullptr, если пул закрыт
+    void post(std::function<void(Database* db)> task);
+
+    std::unique_ptr<ConnectionPool> connections;
+    QThreadPool* threads = nullptr;
+
+    RequestChannels channels;
+};
+
+template <typename T>
+QFuture<T> DbExecutor::submit(const QString& channel, std::function<T(Database&)> job)
+{
+    return submitTicket<T>(issueTicket(channel), std::move(job));
+}
+
+template <typename T>
+QFuture<T> DbExecutor::submitTicket(const Ticket& ticket, std::function<T(Database&)> job)
+{
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+
+    // Если задача так и не выполнится (исполнитель остановлен), promise
+    // уничтожится незавершённым и future станет отменённым.
+    post([promise, ticket, job = std::move(job)](Database* db) {
+        if (!db || !ticket.isCurrent() || promise->isCanceled()) {
+            promise->future().cancel();
+            promise->finish();
+            return;
+        }
+
+        T result = job(*db);
+        if (ticket.isCurrent()) {
+            promise->addResult(std::move(result));
+        } else {
+            promise->future().cancel();
+        }
+        promise->finish();
+    });
+
+    return future;
+}
+
+template <typename T, typename Fn>
+void DbExecutor::run(const QString& channel, std::function<T(Database&)> job, QObject* context, Fn onResult)
+{
+    const Ticket ticket = issueTicket(channel);
+    // Отменённый future продолжение не вызывает; повторная проверка нужна
+    // на случай новой задачи, пока результат шёл через очередь событий.
+    submitTicket<T>(ticket, std::move(job))
+        .then(context, [ticket, onResult = std::move(onResult)](const T& result) {
+            if (ticket.isCurrent()) onResult(result);
+        });
+}
@@ -4,8 +4,9 @@
 #include <QHeaderView>
 #include <QLabel>
 #include <QPalette>
+#include <QTableView>
 #include <QTableWidget>
- #include <QString>
+#include <QString>
 
 namespace UiStyle {
 
@@ -18,7 +19,7 @@ inline constexpr const char* kInfoLabelStyle =
     "  font-weight: 600;"
     "}";
 
-inline void applyStandardTableStyle(QTableWidget* table)
+inline void applyStandardTableStyle(QTableView* table)
 {
     if (!table) return;
 
@@ -4,7 +4,6 @@
 #include <QGridLayout>
 #include <QAbstractItemView>
 #include <QLabel>
-#include <sqlite3.h>
 
 PeriodSelectorWidget::PeriodSelectorWidget(Database* db, QWidget* parent)
     : QWidget(parent), db(db)
@@ -71,27 +70,20 @@ void PeriodSelectorWidget::populateCalendarWeeks()
 
     calendarWeekCombo->clear();
 
-    sqlite3_stmt* stmt = nullptr;
-    const char* sql = "SELECT id, weekofcycle, startdate, enddate FROM cycleweeks ORDER BY id";
-
-    if (sqlite3_prepare_v2(db->getHandle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    std::vector<std::tuple<int, int, std::string, std::string>> weeks;
+    if (!db->getCycleWeeks(weeks)) {
         return;
     }
 
     int index = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
+    for (const auto& week : weeks) {
         ++index;
-        const int id = sqlite3_column_int(stmt, 0);
-        const char* startText = (const char*)sqlite3_column_text(stmt, 2);
-        const char* endText = (const char*)sqlite3_column_text(stmt, 3);
-
-        const QString start = startText ? QString::fromUtf8(startText) : QString();
-        const QString end = endText ? QString::fromUtf8(endText) : QString();
+        const int id = std::get<0>(week);
+        const QString start = QString::fromStdString(std::get<2>(week));
+        const QString end = QString::fromStdString(std::get<3>(week));
         const QString display = QString("Календарная неделя %1 (%2 — %3)").arg(index).arg(start).arg(end);
         calendarWeekCombo->addItem(display, id);
     }
-
-    sqlite3_finalize(stmt);
 }
 
 WeekSelection PeriodSelectorWidget::currentSelection() const
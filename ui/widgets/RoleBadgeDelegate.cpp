@@ -0,0 +1,98 @@
+#include "RoleBadgeDelegate.h"
+
+#include "ui/models/UsersTableModel.h"
+
+#include <QApplication>
+#include <QColor>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyle>
+
+#include <algorithm>
+
+namespace {
+
+struct BadgeColors {
+    QColor border;
+    QColor background;
+    int fontWeight = 600;
+};
+
+// Те же rgba, что у бейджей ролей на UiStyle::badgeStyle (альфа 0.62/0.18 -> 158/46 и т.д.)
+static BadgeColors colorsForRole(UsersTableModel::Role role)
+{
+    switch (role) {
+    case UsersTableModel::Role::Admin:
+        return {QColor(239, 68, 68, 158), QColor(239, 68, 68, 46), 700};
+    case UsersTableModel::Role::Teacher:
+        return {QColor(59, 130, 246, 166), QColor(59, 130, 246, 51), 700};
+    case UsersTableModel::Role::Student:
+        return {QColor(34, 197, 94, 158), QColor(34, 197, 94, 46), 700};
+    case UsersTableModel::Role::Other:
+        break;
+    }
+    return {QColor(120, 120, 120, 107), QColor(120, 120, 120, 26), 600};
+}
+
+constexpr int kBadgeHeight = 22;
+constexpr int kBadgePaddingX = 10;
+constexpr int kCellMargin = 4;
+
+}
+
+RoleBadgeDelegate::RoleBadgeDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void RoleBadgeDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    // Фон ячейки (выделение, чередование строк) рисует стиль, текст — мы
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    opt.text.clear();
+    const QWidget* widget = opt.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    const QString text = index.data(UsersTableModel::RoleNameRole).toString();
+    if (text.isEmpty()) return;
+
+    const BadgeColors colors = colorsForRole(UsersTableModel::parseRole(text));
+
+    QFont font = opt.font;
+    font.setWeight(static_cast<QFont::Weight>(colors.fontWeight));
+    const QFontMetrics fm(font);
+
+    const QRect cell = option.rect.adjusted(kCellMargin, 0, -kCellMargin, 0);
+    const int h = std::min(kBadgeHeight, cell.height() - 2);
+    const int w = std::min(cell.width(), fm.horizontalAdvance(text) + 2 * kBadgePaddingX);
+    const QRectF badge(cell.x() + (cell.width() - w) / 2.0,
+                       cell.y() + (cell.height() - h) / 2.0,
+                       w,
+                       h);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+
+    QPainterPath path;
+    const qreal radius = h / 2.0;
+    path.addRoundedRect(badge.adjusted(0.5, 0.5, -0.5, -0.5), radius, radius);
+    painter->fillPath(path, colors.background);
+    painter->setPen(QPen(colors.border, 1.0));
+    painter->drawPath(path);
+
+    painter->setFont(font);
+    painter->setPen(opt.palette.color(QPalette::WindowText));
+    painter->drawText(badge, Qt::AlignCenter, fm.elidedText(text, Qt::ElideRight, w - 2 * kBadgePaddingX));
+
+    painter->restore();
+}
+
+QSize RoleBadgeDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    QSize s = QStyledItemDelegate::sizeHint(option, index);
+    s.setHeight(std::max(s.height(), kBadgeHeight + 2 * kCellMargin));
+    return s;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QStyledItemDelegate>
+
+// Рисует роль пользователя "бейджем" (как UiStyle::badgeStyle) прямо в ячейке,
+// вместо отдельного QLabel через setCellWidget на каждую строку.
+// Текст роли берётся из UsersTableModel::RoleNameRole.
+class RoleBadgeDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    explicit RoleBadgeDelegate(QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+};
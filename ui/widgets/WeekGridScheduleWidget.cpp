@@ -64,20 +64,27 @@ bool WeekGridScheduleWidget::isRowVisibleForSubgroup(int rowSubgroup, int select
     return rowSubgroup == selectedSubgroup;
 }
 
-QString WeekGridScheduleWidget::dateISOForDay(Database* db, int weekOfCycle, int resolvedWeekId, int weekday)
+QString WeekGridScheduleWidget::dateISOForDay(Database& db, int weekOfCycle, int resolvedWeekId, int weekday)
 {
-    if (!db) return {};
-
     std::string iso;
     if (resolvedWeekId > 0) {
-        db->getDateForWeekdayByWeekId(resolvedWeekId, weekday, iso);
+        db.getDateForWeekdayByWeekId(resolvedWeekId, weekday, iso);
     } else {
-        db->getDateForWeekday(weekOfCycle, weekday, iso);
+        db.getDateForWeekday(weekOfCycle, weekday, iso);
     }
 
     return QString::fromStdString(iso);
 }
 
+QStringList WeekGridScheduleWidget::weekDates(Database& db, int weekOfCycle, int resolvedWeekId)
+{
+    QStringList dates;
+    for (int weekday = 1; weekday <= 6; ++weekday) {
+        dates << dateISOForDay(db, weekOfCycle, resolvedWeekId, weekday);
+    }
+    return dates;
+}
+
 QString WeekGridScheduleWidget::dayHeaderText(const QString& dayName, const QString& dateISO)
 {
     QString ddmm;
@@ -104,16 +111,45 @@ QString WeekGridScheduleWidget::dayHeaderText(const QString& dayName, const QStr
     return dayName;
 }
 
-void WeekGridScheduleWidget::setSchedule(Database* db,
-                                        int groupId,
-                                        int weekOfCycle,
-                                        int resolvedWeekId,
-                                        int currentSubgroup)
+WeekGridScheduleWidget::GroupWeek WeekGridScheduleWidget::loadGroupWeek(Database& db,
+                                                                       int groupId,
+                                                                       int weekOfCycle,
+                                                                       int resolvedWeekId,
+                                                                       int currentSubgroup)
 {
-    clearGrid();
+    GroupWeek week;
+    // вся неделя одним запросом, дальше только раскладываем по ячейкам
+    week.ok = db.getScheduleForGroupWeek(groupId, weekOfCycle, currentSubgroup, week.schedule);
+    week.dayDates = weekDates(db, weekOfCycle, resolvedWeekId);
+    return week;
+}
 
-    selectedLessonCardBody = nullptr;
+WeekGridScheduleWidget::TeacherWeek WeekGridScheduleWidget::loadTeacherWeek(Database& db,
+                                                                           int teacherId,
+                                                                           int groupId,
+                                                                           int weekOfCycle,
+                                                                           int resolvedWeekId,
+                                                                           int currentSubgroup)
+{
+    TeacherWeek week;
+    if (groupId == 0) {
+        week.ok = db.getScheduleForTeacherWeekWithRoom(teacherId, weekOfCycle, currentSubgroup, week.rows);
+    } else {
+        std::vector<std::tuple<int,int,int,int,int,std::string,std::string,std::string>> groupRows;
+        week.ok = db.getScheduleForTeacherGroupWeekWithRoom(teacherId, groupId, weekOfCycle, currentSubgroup, groupRows);
+        week.rows.reserve(groupRows.size());
+        for (auto& r : groupRows) {
+            week.rows.emplace_back(std::get<0>(r), groupId, std::get<2>(r), std::get<3>(r), std::get<4>(r),
+                                   std::move(std::get<5>(r)), std::move(std::get<6>(r)),
+                                   std::move(std::get<7>(r)), std::string());
+        }
+    }
+    week.dayDates = weekDates(db, weekOfCycle, resolvedWeekId);
+    return week;
+}
 
+void WeekGridScheduleWidget::addGridFrame(const QStringList& dayDates)
+{
     const QStringList dayNames = {"Понедельник", "Вторник", "Среда", "Четверг", "Пятница", "Суббота"};
     const QStringList pairTimes = {
         "08:30-09:55", "10:05-11:30", "12:00-13:25",
@@ -128,7 +164,7 @@ void WeekGridScheduleWidget::setSchedule(Database* db,
 
     // day headers (row 0, cols 1..6)
     for (int weekday = 1; weekday <= 6; ++weekday) {
-        const QString iso = dateISOForDay(db, weekOfCycle, resolvedWeekId, weekday);
+        const QString iso = (weekday - 1 < dayDates.size()) ? dayDates[weekday - 1] : QString();
         auto* header = new QLabel(dayHeaderText(dayNames[weekday - 1], iso), contentWidget);
         header->setAlignment(Qt::AlignCenter);
         header->setFixedHeight(52);
@@ -137,7 +173,7 @@ void WeekGridScheduleWidget::setSchedule(Database* db,
         grid->addWidget(header, 0, weekday);
     }
 
-    // time column + cells
+    // time column
     for (int lessonIndex = 0; lessonIndex < 6; ++lessonIndex) {
         auto* timeLabel = new QLabel(pairTimes[lessonIndex], contentWidget);
         timeLabel->setAlignment(Qt::AlignCenter);
@@ -145,31 +181,55 @@ void WeekGridScheduleWidget::setSchedule(Database* db,
         timeLabel->setFixedWidth(110);
         timeLabel->setMinimumHeight(90);
         grid->addWidget(timeLabel, 1 + lessonIndex, 0);
+    }
 
-        for (int weekday = 1; weekday <= 6; ++weekday) {
-            auto* cell = new QWidget(contentWidget);
-            cell->setObjectName("WeekGridCell");
-
-            auto* v = new QVBoxLayout(cell);
-            v->setContentsMargins(8, 8, 8, 8);
-            v->setSpacing(8);
-
-            // gather lessons for this cell
-            std::vector<std::tuple<int,int,int,std::string,std::string,std::string,std::string>> rows;
-            bool ok = false;
-            if (db) {
-                ok = db->getScheduleForGroup(groupId, weekday, weekOfCycle, rows);
-            }
+    // make columns stretch nicely
+    grid->setColumnStretch(0, 0);
+    for (int c = 1; c <= 6; ++c) grid->setColumnStretch(c, 1);
+}
+
+QWidget* WeekGridScheduleWidget::addCell(int lessonIndex, int weekday)
+{
+    auto* cell = new QWidget(contentWidget);
+    cell->setObjectName("WeekGridCell");
+
+    auto* v = new QVBoxLayout(cell);
+    v->setContentsMargins(8, 8, 8, 8);
+    v->setSpacing(8);
+
+    cell->setMinimumHeight(90);
+    grid->addWidget(cell, 1 + lessonIndex, weekday);
+    return cell;
+}
+
+void WeekGridScheduleWidget::finishCell(QWidget* cell, int cardCount)
+{
+    auto* v = static_cast<QVBoxLayout*>(cell->layout());
+    if (cardCount == 0) {
+        auto* empty = new QLabel("Занятий нет", cell);
+        empty->setAlignment(Qt::AlignCenter);
+        empty->setObjectName("WeekGridEmptyLabel");
+        v->addWidget(empty, 1);
+    }
+    v->addStretch(1);
+}
+
+void WeekGridScheduleWidget::showGroupWeek(const GroupWeek& week, int currentSubgroup)
+{
+    clearGrid();
+    addGridFrame(week.dayDates);
 
-            const int lessonNum = lessonIndex + 1;
+    for (int lessonIndex = 0; lessonIndex < 6; ++lessonIndex) {
+        const int lessonNum = lessonIndex + 1;
+
+        for (int weekday = 1; weekday <= 6; ++weekday) {
+            QWidget* cell = addCell(lessonIndex, weekday);
+            auto* v = static_cast<QVBoxLayout*>(cell->layout());
             int cardCount = 0;
 
-            if (ok) {
-                for (const auto& r : rows) {
+            if (week.ok) {
+                for (const auto& r : week.schedule.cell(weekday, lessonNum)) {
                     const int scheduleId = std::get<0>(r);
-                    const int rowLessonNum = std::get<1>(r);
-                    if (rowLessonNum != lessonNum) continue;
-
                     const int rowSubgroup = std::get<2>(r);
                     if (!isRowVisibleForSubgroup(rowSubgroup, currentSubgroup)) continue;
 
@@ -200,81 +260,26 @@ void WeekGridScheduleWidget::setSchedule(Database* db,
                 }
             }
 
-            if (cardCount == 0) {
-                auto* empty = new QLabel("Занятий нет", cell);
-                empty->setAlignment(Qt::AlignCenter);
-                empty->setObjectName("WeekGridEmptyLabel");
-                v->addWidget(empty, 1);
-            }
-
-            v->addStretch(1);
-
-            cell->setMinimumHeight(90);
-            grid->addWidget(cell, 1 + lessonIndex, weekday);
+            finishCell(cell, cardCount);
         }
     }
-
-    // make columns stretch nicely
-    grid->setColumnStretch(0, 0);
-    for (int c = 1; c <= 6; ++c) grid->setColumnStretch(c, 1);
 }
 
-void WeekGridScheduleWidget::setTeacherScheduleAllGroups(Database* db,
-                                                        int teacherId,
-                                                        int weekOfCycle,
-                                                        int resolvedWeekId,
-                                                        int currentSubgroup)
+void WeekGridScheduleWidget::showTeacherWeek(const TeacherWeek& week, const QString& groupName, int currentSubgroup)
 {
     clearGrid();
-
-    const QStringList dayNames = {"Понедельник", "Вторник", "Среда", "Четверг", "Пятница", "Суббота"};
-    const QStringList pairTimes = {
-        "08:30-09:55", "10:05-11:30", "12:00-13:25",
-        "13:35-15:00", "15:30-16:55", "17:05-18:30"
-    };
-
-    std::vector<std::tuple<int,int,int,int,int,std::string,std::string,std::string,std::string>> weekRows;
-    bool ok = false;
-    if (db) {
-        ok = db->getScheduleForTeacherWeekWithRoom(teacherId, weekOfCycle, currentSubgroup, weekRows);
-    }
-
-    auto* corner = new QLabel("", contentWidget);
-    corner->setFixedHeight(52);
-    corner->setObjectName("WeekGridCorner");
-    grid->addWidget(corner, 0, 0);
-
-    for (int weekday = 1; weekday <= 6; ++weekday) {
-        const QString iso = dateISOForDay(db, weekOfCycle, resolvedWeekId, weekday);
-        auto* header = new QLabel(dayHeaderText(dayNames[weekday - 1], iso), contentWidget);
-        header->setAlignment(Qt::AlignCenter);
-        header->setFixedHeight(52);
-        header->setObjectName("WeekGridDayHeader");
-        header->setWordWrap(true);
-        grid->addWidget(header, 0, weekday);
-    }
+    addGridFrame(week.dayDates);
 
     for (int lessonIndex = 0; lessonIndex < 6; ++lessonIndex) {
-        auto* timeLabel = new QLabel(pairTimes[lessonIndex], contentWidget);
-        timeLabel->setAlignment(Qt::AlignCenter);
-        timeLabel->setObjectName("WeekGridTimeLabel");
-        timeLabel->setFixedWidth(110);
-        timeLabel->setMinimumHeight(90);
-        grid->addWidget(timeLabel, 1 + lessonIndex, 0);
-
         const int lessonNum = lessonIndex + 1;
 
         for (int weekday = 1; weekday <= 6; ++weekday) {
-            auto* cell = new QWidget(contentWidget);
-            cell->setObjectName("WeekGridCell");
-
-            auto* v = new QVBoxLayout(cell);
-            v->setContentsMargins(8, 8, 8, 8);
-            v->setSpacing(8);
-
+            QWidget* cell = addCell(lessonIndex, weekday);
+            auto* v = static_cast<QVBoxLayout*>(cell->layout());
             int cardCount = 0;
-            if (ok) {
-                for (const auto& r : weekRows) {
+
+            if (week.ok) {
+                for (const auto& r : week.rows) {
                     const int rowWeekday = std::get<2>(r);
                     const int rowLessonNum = std::get<3>(r);
                     if (rowWeekday != weekday) continue;
@@ -287,33 +292,52 @@ void WeekGridScheduleWidget::setTeacherScheduleAllGroups(Database* db,
                     const QString room = QString::fromStdString(std::get<6>(r));
                     const QString lessonType = QString::fromStdString(std::get<7>(r));
 
-                    QString groupName = QString::fromStdString(std::get<8>(r));
-                    const int groupId = std::get<1>(r);
-                    if (groupName.isEmpty()) {
-                        if (groupId == 0) groupName = "Общая";
-                        else groupName = QString("Группа %1").arg(groupId);
+                    // В Teacher-расписании вместо преподавателя показываем группу (контекст)
+                    QString cardGroup = groupName;
+                    if (cardGroup.isEmpty()) {
+                        cardGroup = QString::fromStdString(std::get<8>(r));
+                        const int groupId = std::get<1>(r);
+                        if (cardGroup.isEmpty()) {
+                            if (groupId == 0) cardGroup = "Общая";
+                            else cardGroup = QString("Группа %1").arg(groupId);
+                        }
                     }
 
-                    v->addWidget(new LessonCardWidget(subject, room, lessonType, groupName, rowSubgroup, cell));
+                    v->addWidget(new LessonCardWidget(subject, room, lessonType, cardGroup, rowSubgroup, cell));
                     ++cardCount;
                 }
             }
 
-            if (cardCount == 0) {
-                auto* empty = new QLabel("Занятий нет", cell);
-                empty->setAlignment(Qt::AlignCenter);
-                empty->setObjectName("WeekGridEmptyLabel");
-                v->addWidget(empty, 1);
-            }
-
-            v->addStretch(1);
-            cell->setMinimumHeight(90);
-            grid->addWidget(cell, 1 + lessonIndex, weekday);
+            finishCell(cell, cardCount);
         }
     }
+}
 
-    grid->setColumnStretch(0, 0);
-    for (int c = 1; c <= 6; ++c) grid->setColumnStretch(c, 1);
+void WeekGridScheduleWidget::setSchedule(Database* db,
+                                        int groupId,
+                                        int weekOfCycle,
+                                        int resolvedWeekId,
+                                        int currentSubgroup)
+{
+    if (!db) {
+        showGroupWeek({}, currentSubgroup);
+        return;
+    }
+    showGroupWeek(loadGroupWeek(*db, groupId, weekOfCycle, resolvedWeekId, currentSubgroup), currentSubgroup);
+}
+
+void WeekGridScheduleWidget::setTeacherScheduleAllGroups(Database* db,
+                                                        int teacherId,
+                                                        int weekOfCycle,
+                                                        int resolvedWeekId,
+                                                        int currentSubgroup)
+{
+    if (!db) {
+        showTeacherWeek({}, QString(), currentSubgroup);
+        return;
+    }
+    showTeacherWeek(loadTeacherWeek(*db, teacherId, 0, weekOfCycle, resolvedWeekId, currentSubgroup),
+                    QString(), currentSubgroup);
 }
 
 void WeekGridScheduleWidget::setTeacherSchedule(Database* db,
@@ -324,89 +348,10 @@ void WeekGridScheduleWidget::setTeacherSchedule(Database* db,
                                                int resolvedWeekId,
                                                int currentSubgroup)
 {
-    clearGrid();
-
-    const QStringList dayNames = {"Понедельник", "Вторник", "Среда", "Четверг", "Пятница", "Суббота"};
-    const QStringList pairTimes = {
-        "08:30-09:55", "10:05-11:30", "12:00-13:25",
-        "13:35-15:00", "15:30-16:55", "17:05-18:30"
-    };
-
-    std::vector<std::tuple<int,int,int,int,int,std::string,std::string,std::string>> weekRows;
-    bool ok = false;
-    if (db) {
-        ok = db->getScheduleForTeacherGroupWeekWithRoom(teacherId, groupId, weekOfCycle, currentSubgroup, weekRows);
+    if (!db) {
+        showTeacherWeek({}, groupName, currentSubgroup);
+        return;
     }
-
-    // corner
-    auto* corner = new QLabel("", contentWidget);
-    corner->setFixedHeight(52);
-    corner->setObjectName("WeekGridCorner");
-    grid->addWidget(corner, 0, 0);
-
-    // day headers
-    for (int weekday = 1; weekday <= 6; ++weekday) {
-        const QString iso = dateISOForDay(db, weekOfCycle, resolvedWeekId, weekday);
-        auto* header = new QLabel(dayHeaderText(dayNames[weekday - 1], iso), contentWidget);
-        header->setAlignment(Qt::AlignCenter);
-        header->setFixedHeight(52);
-        header->setObjectName("WeekGridDayHeader");
-        header->setWordWrap(true);
-        grid->addWidget(header, 0, weekday);
-    }
-
-    for (int lessonIndex = 0; lessonIndex < 6; ++lessonIndex) {
-        auto* timeLabel = new QLabel(pairTimes[lessonIndex], contentWidget);
-        timeLabel->setAlignment(Qt::AlignCenter);
-        timeLabel->setObjectName("WeekGridTimeLabel");
-        timeLabel->setFixedWidth(110);
-        timeLabel->setMinimumHeight(90);
-        grid->addWidget(timeLabel, 1 + lessonIndex, 0);
-
-        const int lessonNum = lessonIndex + 1;
-
-        for (int weekday = 1; weekday <= 6; ++weekday) {
-            auto* cell = new QWidget(contentWidget);
-            cell->setObjectName("WeekGridCell");
-
-            auto* v = new QVBoxLayout(cell);
-            v->setContentsMargins(8, 8, 8, 8);
-            v->setSpacing(8);
-
-            int cardCount = 0;
-            if (ok) {
-                for (const auto& r : weekRows) {
-                    const int rowWeekday = std::get<2>(r);
-                    const int rowLessonNum = std::get<3>(r);
-                    if (rowWeekday != weekday) continue;
-                    if (rowLessonNum != lessonNum) continue;
-
-                    const int rowSubgroup = std::get<4>(r);
-                    if (!isRowVisibleForSubgroup(rowSubgroup, currentSubgroup)) continue;
-
-                    const QString subject = QString::fromStdString(std::get<5>(r));
-                    const QString room = QString::fromStdString(std::get<6>(r));
-                    const QString lessonType = QString::fromStdString(std::get<7>(r));
-
-                    // В Teacher-расписании вместо преподавателя показываем группу (контекст)
-                    v->addWidget(new LessonCardWidget(subject, room, lessonType, groupName, rowSubgroup, cell));
-                    ++cardCount;
-                }
-            }
-
-            if (cardCount == 0) {
-                auto* empty = new QLabel("Занятий нет", cell);
-                empty->setAlignment(Qt::AlignCenter);
-                empty->setObjectName("WeekGridEmptyLabel");
-                v->addWidget(empty, 1);
-            }
-
-            v->addStretch(1);
-            cell->setMinimumHeight(90);
-            grid->addWidget(cell, 1 + lessonIndex, weekday);
-        }
-    }
-
-    grid->setColumnStretch(0, 0);
-    for (int c = 1; c <= 6; ++c) grid->setColumnStretch(c, 1);
+    showTeacherWeek(loadTeacherWeek(*db, teacherId, groupId, weekOfCycle, resolvedWeekId, currentSubgroup),
+                    groupName, currentSubgroup);
 }
@@ -4,15 +4,54 @@
 #include <QWidget>
 #include <QStringList>
 
+#include "database.h"
+
+#include <string>
+#include <tuple>
+#include <vector>
+
 class QGridLayout;
 class QScrollArea;
-class Database;
-
 class WeekGridScheduleWidget : public QWidget {
     Q_OBJECT
 public:
     explicit WeekGridScheduleWidget(QWidget* parent = nullptr);
 
+    // Данные недели для сетки. load*Week только читают БД и не трогают виджеты,
+    // поэтому их можно вызывать на потоке DbExecutor, а show*Week — уже на GUI.
+    struct GroupWeek {
+        bool ok = false;
+        GroupWeekSchedule schedule;
+        QStringList dayDates;  // ISO-даты пн..сб, "" — даты нет
+    };
+
+    struct TeacherWeek {
+        // scheduleId, groupId, weekday, lessonNumber, subgroup, subjectName, room, lessonType, groupName
+        using Row = std::tuple<int,int,int,int,int,std::string,std::string,std::string,std::string>;
+
+        bool ok = false;
+        std::vector<Row> rows;
+        QStringList dayDates;
+    };
+
+    static GroupWeek loadGroupWeek(Database& db,
+                                   int groupId,
+                                   int weekOfCycle,
+                                   int resolvedWeekId,
+                                   int currentSubgroup);
+
+    // groupId == 0 — все группы преподавателя
+    static TeacherWeek loadTeacherWeek(Database& db,
+                                       int teacherId,
+                                       int groupId,
+                                       int weekOfCycle,
+                                       int resolvedWeekId,
+                                       int currentSubgroup);
+
+    void showGroupWeek(const GroupWeek& week, int currentSubgroup);
+    // groupName непустой — подпись карточек (одна группа), иначе имя группы из строки
+    void showTeacherWeek(const TeacherWeek& week, const QString& groupName, int currentSubgroup);
+
     void setSchedule(Database* db,
                      int groupId,
                      int weekOfCycle,
@@ -45,10 +84,15 @@ private:
     QWidget* selectedLessonCardBody = nullptr;
 
     static QString dayHeaderText(const QString& dayName, const QString& dateISO);
-    static QString dateISOForDay(Database* db, int weekOfCycle, int resolvedWeekId, int weekday);
+    static QString dateISOForDay(Database& db, int weekOfCycle, int resolvedWeekId, int weekday);
+    static QStringList weekDates(Database& db, int weekOfCycle, int resolvedWeekId);
     static bool isRowVisibleForSubgroup(int rowSubgroup, int selectedSubgroup);
 
     static void repolish(QWidget* w);
 
     void clearGrid();
+    // Угол, заголовки дней и колонка времени
+    void addGridFrame(const QStringList& dayDates);
+    QWidget* addCell(int lessonIndex, int weekday);
+    static void finishCell(QWidget* cell, int cardCount);
 };